@@ -23,6 +23,18 @@ ifeq ($(OPENMP),1)
 CXXFLAGS += -fopenmp -DOPENMP
 endif
 
+ifeq ($(TRACE),1)
+CXXFLAGS += -DRAI_TRACE
+endif
+
+ifeq ($(SIMD),avx2)
+CXXFLAGS += -mavx2 -mfma
+endif
+
+ifeq ($(SIMD),avx512)
+CXXFLAGS += -mavx512f -mfma
+endif
+
 ifeq ($(PYBIND),1)
 DEPEND_UBUNTU += python3-dev python3 python3-numpy python3-pip python3-distutils
 #pybind11-dev NO! don't use the ubuntu package. Instead use:
@@ -203,12 +215,6 @@ CPATH := $(CPATH):/usr/lib/wx/include/gtk2-unicode-release-2.8:/usr/include/wx-2
 LIBS += -pthread -Wl,-Bsymbolic-functions  -lwx_gtk2u_richtext-2.8 -lwx_gtk2u_aui-2.8 -lwx_gtk2u_xrc-2.8 -lwx_gtk2u_qa-2.8 -lwx_gtk2u_html-2.8 -lwx_gtk2u_adv-2.8 -lwx_gtk2u_core-2.8 -lwx_baseu_xml-2.8 -lwx_baseu_net-2.8 -lwx_baseu-2.8
 endif
 
-ifeq ($(ANN),1)
-DEPEND_UBUNTU += libann-dev
-CXXFLAGS  += -DRAI_ANN
-LIBS += -lann
-endif
-
 ifeq ($(QHULL),1)
 DEPEND_UBUNTU += libqhull-dev
 CXXFLAGS  += -DRAI_QHULL
@@ -7,38 +7,121 @@
     --------------------------------------------------------------  */
 
 #include "ann.h"
-#include "algos.h"
 
-#ifdef RAI_ANN
+#include <algorithm>
+#include <vector>
+#include <math.h>
 
-#include <ANN/ANN.h>
+namespace {
+
+/// a static kd-tree over some rows of X: the node of a range [lo,hi) of idx is its median mid, splitting along dim(mid);
+/// ranges of at most leafSize points are leaves (scanned linearly)
+struct KdTree {
+  enum { leafSize=8 };
+  uintA idx;
+  uintA dim;
+
+  void build(const arr& X, const arr& w) { dim.resize(idx.N); build(X, w, 0, idx.N); }
+
+ private:
+  void build(const arr& X, const arr& w, uint lo, uint hi) {
+    if(hi-lo<=leafSize) return;
+    //split along the dimension of largest (weighted) spread
+    uint d=X.d1, split=0;
+    double maxSpread=-1.;
+    for(uint j=0; j<d; j++) {
+      double a=X.p[idx.p[lo]*d+j], b=a;
+      for(uint l=lo+1; l<hi; l++) {
+        double v=X.p[idx.p[l]*d+j];
+        if(v<a) a=v; else if(v>b) b=v;
+      }
+      double spread = (b-a)*(w.N ? sqrt(w.p[j]) : 1.);
+      if(spread>maxSpread) { maxSpread=spread; split=j; }
+    }
+    uint mid=(lo+hi)/2;
+    const double* Xs = X.p+split;
+    std::nth_element(idx.p+lo, idx.p+mid, idx.p+hi, [Xs, d](uint a, uint b) { return Xs[a*d]<Xs[b*d]; });
+    dim.p[mid]=split;
+    build(X, w, lo, mid);
+    build(X, w, mid+1, hi);
+  }
+};
+
+/// a kNN (or radius) query, collecting the found points sorted by (weighted) squared distance
+struct Query {
+  const double* x;
+  const arr& X;
+  const double* w;
+  uint k;
+  double radius2; ///< <0 for kNN queries
+  double eps2;    ///< (1+eps)^2
+  std::vector<std::pair<double, uint>> found;
+
+  Query(const arr& x, const arr& X, const arr& w, uint k, double radius2=-1., double eps=0.)
+    : x(x.p), X(X), w(w.N ? w.p : 0), k(k), radius2(radius2), eps2((1.+eps)*(1.+eps)) {}
+
+  double worst() const {
+    if(radius2>=0.) return radius2;
+    return found.size()<k ? INFINITY : found.back().first;
+  }
+
+  void add(uint i) {
+    const double* y = X.p+i*X.d1;
+    double s=0.;
+    if(w) for(uint j=0; j<X.d1; j++) { double e=x[j]-y[j]; s+=w[j]*e*e; }
+    else  for(uint j=0; j<X.d1; j++) { double e=x[j]-y[j]; s+=e*e; }
+    if(radius2>=0.) { if(s<=radius2) found.push_back({s, i}); return; }
+    if(found.size()<k || s<found.back().first) {
+      found.insert(std::upper_bound(found.begin(), found.end(), std::make_pair(s, i)), {s, i});
+      if(found.size()>k) found.pop_back();
+    }
+  }
+
+  void search(const KdTree& t, uint lo, uint hi) {
+    if(hi-lo<=KdTree::leafSize) {
+      for(uint l=lo; l<hi; l++) add(t.idx.p[l]);
+      return;
+    }
+    uint mid=(lo+hi)/2, i=t.idx.p[mid], d=t.dim.p[mid];
+    add(i);
+    double diff = x[d]-X.p[i*X.d1+d];
+    double bound = diff*diff*(w ? w[d] : 1.); //lower bound of the distance to all points on the far side
+    if(diff<0.) {
+      search(t, lo, mid);
+      if(bound*eps2<=worst()) search(t, mid+1, hi);
+    } else {
+      search(t, mid+1, hi);
+      if(bound*eps2<=worst()) search(t, lo, mid);
+    }
+  }
+
+  void get(arr& sqrDists, uintA& idx) {
+    if(radius2>=0.) std::sort(found.begin(), found.end());
+    sqrDists.resize(found.size());
+    idx.resize(found.size());
+    for(uint j=0; j<found.size(); j++) { sqrDists.p[j]=found[j].first; idx.p[j]=found[j].second; }
+  }
+};
+
+}
 
 struct sANN {
-  ANNkd_tree* tree=0;
-  //PartialLeastSquares pls;
-  rai::Array<double*> cpointers;
-  uint treeSize;   //for how many entries in X have we build the tree?
-  void clear() { if(tree) delete tree;   tree=nullptr;  cpointers.clear();  treeSize=0; }
+  std::vector<KdTree> forest; //tree sizes decrease geometrically
+  uint indexed=0;             //rows of X in the forest
+  void clear() { forest.clear(); indexed=0; }
 };
 
 ANN::ANN() {
-  bufferSize = 1 <<10;
   self = make_unique<sANN>();
-  self->tree = 0;
-  self->treeSize = 0;
 }
 
 ANN::ANN(const ANN& ann) {
-  bufferSize = 1 <<10;
   self = make_unique<sANN>();
-  self->tree = 0;
-  self->treeSize = 0;
+  weights = ann.weights;
   setX(ann.X);
 }
 
 ANN::~ANN() {
-  self->clear();
-  //annClose(); //mt09-07-29 this would close down the ANN lib completely
 }
 
 void ANN::clear() {
@@ -52,60 +135,46 @@ void ANN::setX(const arr& _XX) {
 }
 
 void ANN::append(const arr& x) {
-  double* p=X.p;
   X.append(x);
   if(X.N==x.d0) X.reshape(1, x.d0);
-  if(X.p!=p) self->clear(); //when the memory location changed clear the tree! (implies recomputation)
+  calculate();
 }
 
 void ANN::calculate() {
-  if(self->treeSize == X.d0) return;
-  self->clear();
-  self->cpointers = getCarray(X);
-  self->tree = new ANNkd_tree(self->cpointers.p, X.d0, X.d1);
-  self->treeSize = X.d0;
+  if(self->indexed==X.d0) return;
+  CHECK_EQ(X.nd, 2, "ANN needs a data matrix");
+  if(weights.N) CHECK_EQ(weights.N, X.d1, "wrong dimension of the metric weights");
+
+  //a new tree with all rows not yet indexed...
+  std::vector<KdTree>& F = self->forest;
+  F.emplace_back();
+  uintA& idx = F.back().idx;
+  idx.resize(X.d0-self->indexed);
+  for(uint i=0; i<idx.N; i++) idx.p[i] = self->indexed+i;
+  self->indexed = X.d0;
+
+  //...merged with all preceding trees that are not larger (so that sizes stay geometric)
+  while(F.size()>=2 && F[F.size()-2].idx.N<=F.back().idx.N) {
+    KdTree& t = F[F.size()-2];
+    t.idx.append(F.back().idx);
+    F.pop_back();
+  }
+  F.back().build(X, weights);
 }
 
 void ANN::getkNN(arr& dists, uintA& idx, const arr& x, uint k, double eps, bool verbose) {
   CHECK_GE(X.d0, k, "data has less (" <<X.d0 <<") than k=" <<k <<" points");
   CHECK_EQ(x.N, X.d1, "query point has wrong dimension. x.N=" << x.N << ", X.d1=" << X.d1);
 
-  if(X.d0-self->treeSize>bufferSize) {
-    if(verbose) std::cout <<"ANN recomputing: X.d0=" <<X.d0 <<" treeSize=" <<self->treeSize <<std::endl;
-    calculate();
-  }
-  uint restStartsAt;
-  if(self->treeSize>=k) {
-    dists.resize(k);
-    idx.resize(k);
-    self->tree->annkSearch(x.p, k, (int*)idx.p, dists.p, eps);
-    restStartsAt=self->treeSize;
-  } else {
-    dists.clear();
-    idx.clear();
-    restStartsAt=0;
-  }
-
-  //now check if in the rest of X there are even nearer points
-  for(uint i=restStartsAt; i<X.d0; i++) {
-    for(uint j=0; j<=idx.N && j<k; j++) {
-      double d=sqrDistance(X[i], x);
-      if(j==idx.N || d < dists(j)) {
-        idx.insert(j, i);
-        dists.insert(j, d);
-        break;
-      }
-    }
-  }
-  if(idx.N>k) {
-    idx.resizeCopy(k);
-    dists.resizeCopy(k);
-  }
+  calculate();
+  Query q(x, X, weights, k, -1., eps);
+  for(const KdTree& t:self->forest) q.search(t, 0, t.idx.N);
+  q.get(dists, idx);
 
   if(verbose) {
     std::cout
         <<"ANN query:"
-        <<"\n data size = " <<X.d0 <<"  data dim = " <<X.d1 <<"  treeSize = " <<self->treeSize
+        <<"\n data size = " <<X.d0 <<"  data dim = " <<X.d1 <<"  #trees = " <<self->forest.size()
         <<"\n query point " <<x
         <<"\n found neighbors:\n";
     for(uint i=0; i<idx.N; i++) {
@@ -138,19 +207,28 @@ void ANN::getkNN(arr& xx, const arr& x, uint k, double eps, bool verbose) {
   for(uint i=0; i<idx.N; i++) xx[i]=X[idx(i)];
 }
 
-#else //RAI_ANN
-
-struct sANN {};
-
-ANN::ANN() { NICO }
-ANN::~ANN() { NICO }
-
-void ANN::calculate() { NICO }
-void ANN::setX(const arr& _XX) { NICO }
-void ANN::append(const arr& x) { NICO }
-uint ANN::getNN(const arr& x, double eps, bool verbose) { NICO }
-void ANN::getkNN(uintA& idx, const arr& x, uint k, double eps, bool verbose) { NICO }
-void ANN::getkNN(arr& sqrDists, uintA& idx, const arr& x, uint k, double eps, bool verbose) { NICO }
-void ANN::getkNN(arr& X, const arr& x, uint k, double eps, bool verbose) { NICO }
+void ANN::getRadiusNN(arr& sqrDists, uintA& idx, const arr& x, double radius) {
+  CHECK_EQ(x.N, X.d1, "query point has wrong dimension. x.N=" << x.N << ", X.d1=" << X.d1);
+  calculate();
+  Query q(x, X, weights, 0, radius*radius);
+  for(const KdTree& t:self->forest) q.search(t, 0, t.idx.N);
+  q.get(sqrDists, idx);
+}
 
-#endif
+void ANN::getkNN_batch(arr& sqrDists, uintA& idx, const arr& queries, uint k, double eps) {
+  CHECK_EQ(queries.nd, 2, "");
+  CHECK_GE(X.d0, k, "data has less (" <<X.d0 <<") than k=" <<k <<" points");
+  CHECK_EQ(queries.d1, X.d1, "query points have wrong dimension");
+  calculate();
+  sqrDists.resize(queries.d0, k);
+  idx.resize(queries.d0, k);
+  arr x, d;
+  uintA i;
+  for(uint n=0; n<queries.d0; n++) {
+    x.referToDim(queries, n);
+    Query q(x, X, weights, k, -1., eps);
+    for(const KdTree& t:self->forest) q.search(t, 0, t.idx.N);
+    q.get(d, i);
+    for(uint j=0; j<k; j++) { sqrDists.p[n*k+j]=d.p[j]; idx.p[n*k+j]=i.p[j]; }
+  }
+}
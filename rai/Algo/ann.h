@@ -12,26 +12,34 @@
 
 //===========================================================================
 //
-// Approximate Nearest Neighbor Search (kd-tree)
+// Nearest Neighbor Search (incremental kd-tree forest)
 //
 
+/** Exact (or, with eps>0, (1+eps)-approximate) nearest neighbor search over the rows of X. The points are indexed in a
+ *  forest of static kd-trees of geometrically growing sizes (logarithmic method): append() adds a tree of one point and
+ *  merges (rebuilds) the trailing trees of equal size: each point is rebuilt O(log n) times, at O(log n) each, so an
+ *  append costs amortized O(log^2 n) (not the O(log n) of a dynamic balanced tree); a query visits O(log n) trees. Points are referred to by their row in X, which may be reallocated freely. Points written into X
+ *  directly (e.g., setX) are indexed lazily by the next query. Queries only read the index (after calculate()), so
+ *  concurrent queries are safe as long as nothing is appended. */
 struct ANN {
   unique_ptr<struct sANN> self;
 
-  arr X;       //the data set for which a ANN tree is build
-  uint bufferSize; //a tree is only rebuild if there are more than 'buffer' new points appended [default: 20]
+  arr X;       //the data set (one point per row)
+  arr weights; //optional per-dimension weights w of the squared distance sum_i w_i (x_i-y_i)^2 (e.g., for joint spaces); empty: Euclidean
 
   ANN();
   ANN(const ANN& ann);
   ~ANN();
 
-  void clear();              //clears the tree and X
+  void clear();              //clears the trees and X
   void setX(const arr& _X);  //set X
-  void append(const arr& x); //append to X
-  void calculate();          //compute a tree for all of X
+  void append(const arr& x); //append to X (and index it)
+  void calculate();          //index all rows of X that were not yet
 
   uint getNN(const arr& x, double eps=.0, bool verbose=false);
   void getkNN(uintA& idx, const arr& x, uint k, double eps=.0, bool verbose=false);
   void getkNN(arr& sqrDists, uintA& idx, const arr& x, uint k, double eps=.0, bool verbose=false);
   void getkNN(arr& X, const arr& x, uint k, double eps=.0, bool verbose=false);
+  void getRadiusNN(arr& sqrDists, uintA& idx, const arr& x, double radius); //all points within (weighted) distance radius, nearest first
+  void getkNN_batch(arr& sqrDists, uintA& idx, const arr& queries, uint k, double eps=.0); //kNN for each row of queries: (n,k)-arrays
 };
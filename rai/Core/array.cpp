@@ -19,6 +19,7 @@
 #include "array.h"
 #include "util.h"
 #include "util.ipp"
+#include "trace.h"
 
 #ifdef RAI_LAPACK
 extern "C" {
@@ -875,7 +876,7 @@ void sparseProduct(arr& y, arr& A, const arr& x) {
     return;
   }
   if(isSparseMatrix(A) && isSparseVector(x)) {
-    A.sparse().setupRowsCols();
+    A.sparse().ensureRowsCols();
     rai::SparseVector* sx = dynamic_cast<rai::SparseVector*>(x.special);
     CHECK(x.nd==1 && A.nd==2 && x.d0==A.d1, "not a proper matrix-vector multiplication");
     uint i, j, n;
@@ -1539,6 +1540,14 @@ bool lapack_isPositiveSemiDefinite(const arr& symmA) { NICO; }
 void lapack_inverseSymPosDef(arr& Ainv, const arr& A) { NICO; }
 arr lapack_kSmallestEigenValues_sym(const arr& A, uint k) { NICO; }
 arr lapack_Ainv_b_sym(const arr& A, const arr& b) {
+  if(isRowShifted(A) && b.nd==1) {
+    arr U;
+    if(!banded_choleskySymPosDef(U, A)) {
+      rai::errStringStream() <<"banded Cholesky failed: A is not pos-def";
+      throw(rai::errString());
+    }
+    return banded_Ainv_b_givenCholesky(U, b);
+  }
   arr invA;
   inverse(invA, A);
   return invA*b;
@@ -1549,6 +1558,57 @@ arr lapack_Ainv_b_symPosDef_givenCholesky(const arr& U, const arr& b) { return i
 arr lapack_Ainv_b_triangular(const arr& L, const arr& b) { return inverse(L)*b; }
 #endif
 
+//===========================================================================
+
+bool banded_choleskySymPosDef(arr& U, const arr& A, double damping) {
+  RAI_TRACE_SCOPE("banded_choleskySymPosDef");
+  CHECK(isRowShifted(A), "");
+  const rai::RowShifted& Ar = A.rowShifted();
+  CHECK(Ar.symmetric, "this is not a symmetric matrix");
+  uint n=A.d0, w=Ar.rowSize;
+  for(uint i=0; i<n; i++) if(Ar.rowShift.p[i]!=i) HALT("this is not shifted as an upper triangle");
+  U.resize(n, w);
+  memmove(U.p, A.p, U.N*U.sizeT);
+  if(damping) for(uint i=0; i<n; i++) U.p[i*w] += damping;
+  //right-looking: scale row i, then subtract its outer product from the (at most w-1) following rows
+  for(uint i=0; i<n; i++) {
+    double* Ui = U.p+i*w;
+    if(!(Ui[0]>0.)) return false; //not pos-def (or NAN)
+    Ui[0] = ::sqrt(Ui[0]);
+    uint m = (i+w<=n ? w : n-i);
+    for(uint j=1; j<m; j++) Ui[j] /= Ui[0];
+    for(uint j=1; j<m; j++) {
+      double Uij = Ui[j];
+      if(!Uij) continue;
+      double* Ur = U.p+(i+j)*w - j; //Ur[l] is the entry (i+j, i+l)
+      for(uint l=j; l<m; l++) Ur[l] -= Uij*Ui[l];
+    }
+  }
+  return true;
+}
+
+arr banded_Ainv_b_givenCholesky(const arr& U, const arr& b) {
+  uint n=U.d0, w=U.d1;
+  CHECK_EQ(b.N, n, "");
+  arr x = b;
+  //U^T y = b
+  for(uint i=0; i<n; i++) {
+    const double* Ui = U.p+i*w;
+    uint m = (i+w<=n ? w : n-i);
+    double xi = (x.p[i] /= Ui[0]);
+    for(uint j=1; j<m; j++) x.p[i+j] -= Ui[j]*xi;
+  }
+  //U x = y
+  for(uint i=n; i--;) {
+    const double* Ui = U.p+i*w;
+    uint m = (i+w<=n ? w : n-i);
+    double xi = x.p[i];
+    for(uint j=1; j<m; j++) xi -= Ui[j]*x.p[i+j];
+    x.p[i] = xi/Ui[0];
+  }
+  return x;
+}
+
 //===========================================================================
 //
 // Eigen
@@ -2026,6 +2086,7 @@ void SparseVector::resize(uint d0, uint n) {
 }
 
 SparseMatrix& SparseMatrix::resize(uint d0, uint d1, uint n) {
+  if(rows.nd){ rows.clear(); cols.clear(); }
   Z.nd=2; Z.d0=d0; Z.d1=d1;
   Z.resizeMEM(n, false);
   Z.setZero();
@@ -2035,6 +2096,7 @@ SparseMatrix& SparseMatrix::resize(uint d0, uint d1, uint n) {
 }
 
 void SparseMatrix::resizeCopy(uint d0, uint d1, uint n) {
+  if(rows.nd){ rows.clear(); cols.clear(); }
   Z.nd=2; Z.d0=d0; Z.d1=d1;
   uint Nold = Z.N;
   Z.resizeMEM(n, true);
@@ -2186,15 +2248,27 @@ void SparseMatrix::setFromDense(const arr& X) {
 }
 
 void SparseMatrix::setupRowsCols() {
+  //count non-zeros per row and column first, so that each index list is allocated once
+  uintA rowN(Z.d0), colN(Z.d1);
+  rowN.setZero();
+  colN.setZero();
+  for(uint k=0; k<elems.d0; k++) {
+    rowN.p[elems.p[2*k]]++;
+    colN.p[elems.p[2*k+1]]++;
+  }
   rows.resize(Z.d0);
   cols.resize(Z.d1);
-  for(uint i=0; i<Z.d0; i++) rows(i).resize(0, 2);
-  for(uint j=0; j<Z.d1; j++) cols(j).resize(0, 2);
+  for(uint i=0; i<Z.d0; i++) rows.p[i].resize(rowN.p[i], 2);
+  for(uint j=0; j<Z.d1; j++) cols.p[j].resize(colN.p[j], 2);
+  rowN.setZero();
+  colN.setZero();
   for(uint k=0; k<elems.d0; k++) {
-    uint i = elems(k, 0);
-    uint j = elems(k, 1);
-    rows(i).append(uintA{j, k});
-    cols(j).append(uintA{i, k});
+    uint i = elems.p[2*k];
+    uint j = elems.p[2*k+1];
+    uint* r = rows.p[i].p + 2*(rowN.p[i]++);
+    uint* c = cols.p[j].p + 2*(colN.p[j]++);
+    r[0]=j; r[1]=k;
+    c[0]=i; c[1]=k;
   }
 }
 
@@ -2221,6 +2295,7 @@ void SparseMatrix::colShift(int shift) {
 #ifdef RAI_EIGEN
 
 arr SparseMatrix::At_x(const arr& x) {
+  RAI_TRACE_SCOPE("SparseMatrix::At_x");
   Eigen::SparseMatrix<double> A_eig = conv_sparseArr2sparseEigen(*this);
   Eigen::MatrixXd x_eig = conv_arr2eigen(x);
 
@@ -2232,6 +2307,7 @@ arr SparseMatrix::At_x(const arr& x) {
 }
 
 arr SparseMatrix::At_A() {
+  RAI_TRACE_SCOPE("SparseMatrix::At_A");
   Eigen::SparseMatrix<double> s = conv_sparseArr2sparseEigen(*this);
 
   Eigen::SparseMatrix<double> W(Z.d1, Z.d1);
@@ -2241,6 +2317,7 @@ arr SparseMatrix::At_A() {
 }
 
 arr SparseMatrix::A_B(const arr& B) const {
+  RAI_TRACE_SCOPE("SparseMatrix::A_B");
   if(!isSparse(B) && B.N<25){
     arr C;
     SparseMatrix &S = C.sparse();
@@ -2265,6 +2342,7 @@ arr SparseMatrix::A_B(const arr& B) const {
 }
 
 arr SparseMatrix::B_A(const arr& B) const {
+  RAI_TRACE_SCOPE("SparseMatrix::B_A");
   if(!isSparse(B) && B.N<25){
     arr C;
     SparseMatrix &S = C.sparse();
@@ -2298,6 +2376,7 @@ arr SparseMatrix::B_A(const arr& B) const { NICO }
 #endif //RAI_EIGEN
 
 void SparseMatrix::transpose() {
+  RAI_TRACE_SCOPE("SparseMatrix::transpose");
   uint d0 = Z.d0;
   Z.d0 = Z.d1;
   Z.d1 = d0;
@@ -2329,9 +2408,11 @@ void SparseMatrix::rowWiseMult(const arr& a) {
 //}
 
 void SparseMatrix::add(const SparseMatrix& a, uint lo0, uint lo1, double coeff){
+  RAI_TRACE_SCOPE("SparseMatrix::add");
   CHECK_LE(lo0+a.Z.d0, Z.d0, "");
   CHECK_LE(lo1+a.Z.d1, Z.d1, "");
   if(!a.Z.N) return; //nothing to add
+  if(rows.nd){ rows.clear(); cols.clear(); }
   uint Nold=Z.N;
 #if 1
   Z.resizeMEM(Nold+a.Z.N, true);
@@ -2359,6 +2440,7 @@ void SparseMatrix::add(const SparseMatrix& a, uint lo0, uint lo1, double coeff){
 }
 
 void SparseMatrix::add(const arr& B, uint lo0, uint lo1, double coeff){
+  RAI_TRACE_SCOPE("SparseMatrix::add");
   if(!B.N) return; //nothing to add
   if(B.nd==2){
     CHECK_LE(lo0+B.d0, Z.d0, "");
@@ -2366,6 +2448,7 @@ void SparseMatrix::add(const arr& B, uint lo0, uint lo1, double coeff){
   }else if(B.nd==1){ //add a column! vector
     CHECK_LE(lo0+B.d0, Z.d0, "");
   }else NIY;
+  if(rows.nd){ rows.clear(); cols.clear(); }
   uint Nold=Z.N;
   Z.resizeMEM(Nold+B.N, true);
   memmove(Z.p+Nold, B.p, Z.sizeT*B.N);
@@ -2453,6 +2536,75 @@ void SparseMatrix::checkConsistency() const {
   }
 }
 
+//===========================================================================
+
+/// the number of entries SparseAssembly::add appends for B: all entries of a sparse B, only the non-zeros of a dense B
+static uint blockEntries(const arr& B) {
+  if(isSparse(B)) return B.N;
+  uint m=0;
+  for(const double& b:B) if(b) m++;
+  return m;
+}
+
+/// true if the (row,col) tuples e[0..2*m) are those that SparseAssembly::add(J, B, lo0) would append
+static bool blockFollowsPattern(const int* e, const arr& B, uint lo0) {
+  if(isSparseMatrix(B)) {
+    const int* b = B.sparse().elems.p;
+    for(const int* estop=e+2*B.N; e!=estop; e+=2, b+=2) if(e[0]!=b[0]+(int)lo0 || e[1]!=b[1]) return false;
+  } else if(isSparseVector(B)) {
+    for(int i:B.sparseVec().elems) { if(e[0]!=i+(int)lo0 || e[1]!=0) return false; e+=2; }
+  } else {
+    uint d1 = (B.nd==2 ? B.d1 : 1);
+    for(uint k=0; k<B.N; k++) if(B.p[k]) { if(e[0]!=(int)(lo0+k/d1) || e[1]!=(int)(k%d1)) return false; e+=2; }
+  }
+  return true;
+}
+
+void SparseAssembly::begin(arr& J, uint d0, uint d1) {
+  SparseMatrix& S = J.sparse();
+  n=0;
+  reuse = pattern.N && J.d0==d0 && J.d1==d1
+          && S.elems.N==pattern.N && !memcmp(S.elems.p, pattern.p, pattern.N*pattern.sizeT);
+  if(!reuse) S.resize(d0, d1, 0);
+}
+
+void SparseAssembly::add(arr& J, const arr& B, uint lo0) {
+  if(!B.N) return;
+  SparseMatrix& S = J.sparse();
+  uint m = blockEntries(B);
+  if(reuse) {
+    if(n+m<=pattern.d0 && blockFollowsPattern(pattern.p+2*n, B, lo0)) {
+      if(isSparse(B)) memmove(J.p+n, B.p, J.sizeT*B.N);
+      else { double* z=J.p+n; for(const double& b:B) if(b) *(z++)=b; }
+      n += m;
+      return;
+    }
+    //pattern changed: keep the consistent part, continue by appending
+    reuse=false;
+    S.resizeCopy(J.d0, J.d1, n);
+  }
+  if(isSparse(B)) {
+    S.add(B, lo0, 0);
+  } else { //dense block: append only its non-zeros, as the sparse conversion of B would
+    CHECK_LE(lo0+B.d0, J.d0, "");
+    S.resizeCopy(J.d0, J.d1, n+m);
+    uint d1 = (B.nd==2 ? B.d1 : 1);
+    double* z=J.p+n;
+    int* e=S.elems.p+2*n;
+    for(uint k=0; k<B.N; k++) if(B.p[k]) { *(z++)=B.p[k]; *(e++)=lo0+k/d1; *(e++)=k%d1; }
+  }
+  n += m;
+}
+
+void SparseAssembly::end(arr& J) {
+  SparseMatrix& S = J.sparse();
+  if(reuse && n==pattern.d0) { reuseCount++; return; }
+  if(reuse) S.resizeCopy(J.d0, J.d1, n);
+  reuse=false;
+  pattern = S.elems;
+  rebuildCount++;
+}
+
 void operator -= (SparseMatrix& x, const SparseMatrix& y) { x.add(y, 0, 0, -1.); }
 void operator -= (SparseMatrix& x, double y) { arr& X=x.Z; x.unsparse(); X -= y; }
 
@@ -1733,6 +1733,10 @@ void rndGauss(arr& x, double stdDev, bool add) {
   else     for(uint i=0; i<x.N; i++) x.p[i]+=(double)(stdDev*rnd.gauss());
 }
 
+void rndUniform(arr& a, rai::RndStream& r, double low, double high, bool add) { r.uniform(a.p, a.N, low, high, add); }
+
+void rndGauss(arr& x, rai::RndStream& r, double stdDev, bool add) { r.gauss(x.p, x.N, stdDev, add); }
+
 /// a gaussian random vector with Id covariance matrix (sdv = sqrt(dimension))
 /*void rndGauss(arr& a, bool add){
   if(!add) for(uint i=0;i<a.N;i++) a.p[i]=rnd.gauss();
@@ -41,6 +41,7 @@ namespace rai {
 struct SparseVector;
 struct SparseMatrix;
 struct RowShifted;
+struct RndStream;
 
 // OLD, TODO: hide -> array.cpp
 extern bool useLapack;
@@ -570,6 +571,8 @@ void rndInteger(arr& a, int low=0, int high=1, bool add=false);
 void rndUniform(arr& a, double low=0., double high=1., bool add=false);
 void rndNegLogUniform(arr& a, double low=0., double high=1., bool add=false);
 void rndGauss(arr& a, double stdDev=1., bool add=false);
+void rndUniform(arr& a, rai::RndStream& r, double low=0., double high=1., bool add=false); ///< drawn from the given stream (e.g., one per worker thread)
+void rndGauss(arr& a, rai::RndStream& r, double stdDev=1., bool add=false);
 //void rndGauss(arr& a, bool add=false);
 //arr& rndGauss(double stdDev, uint dim);
 uint softMax(const arr& a, arr& soft, double beta);
@@ -625,6 +628,8 @@ void lapack_min_Ax_b(arr& x, const arr& A, const arr& b);
 arr lapack_Ainv_b_symPosDef_givenCholesky(const arr& U, const arr& b);
 arr lapack_Ainv_b_triangular(const arr& L, const arr& b);
 arr eigen_Ainv_b(const arr& A, const arr& b);
+bool banded_choleskySymPosDef(arr& U, const arr& A, double damping=0.); ///< U^T U = A+damping*I for symmetric RowShifted A (upper band); U in A's packed (n x rowSize) layout; false if not pos-def; used by lapack_Ainv_b_sym without LAPACK (dpbsv otherwise)
+arr banded_Ainv_b_givenCholesky(const arr& U, const arr& b);
 
 //===========================================================================
 /// @}
@@ -726,6 +731,7 @@ struct SparseMatrix : SpecialArray {
   //construction
   void setFromDense(const arr& X);
   void setupRowsCols();
+  void ensureRowsCols(){ if(rows.N!=Z.d0 || cols.N!=Z.d1) setupRowsCols(); } ///< only rebuilds the row/col index if it was invalidated
   //manipulations
   SparseMatrix& resize(uint d0, uint d1, uint n);
   void resizeCopy(uint d0, uint d1, uint n);
@@ -746,6 +752,21 @@ struct SparseMatrix : SpecialArray {
   void checkConsistency() const;
 };
 
+/// Assembles a sparse matrix from blocks appended at row offsets (e.g., stacking feature Jacobians). The first assembly
+/// records the non-zero pattern; as long as later assemblies append blocks with the same pattern, values are only copied
+/// into the reserved memory -- no reallocation, no index rewriting, and the rows/cols index stays valid
+struct SparseAssembly {
+  intA pattern;     ///< recorded (row,col) tuples of all non-zeros, in memory order
+  uint n=0;         ///< non-zeros written in the current assembly
+  bool reuse=false; ///< the current assembly (so far) follows the recorded pattern
+  uint reuseCount=0, rebuildCount=0;
+
+  void begin(arr& J, uint d0, uint d1);
+  void add(arr& J, const arr& B, uint lo0);
+  void end(arr& J);
+  void clear(){ pattern.clear(); n=0; reuse=false; }
+};
+
 arr unpack(const arr& X);
 arr comp_At_A(const arr& A);
 arr comp_A_At(const arr& A);
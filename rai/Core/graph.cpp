@@ -78,12 +78,15 @@ Node::Node(const std::type_info& _type, Graph& _container, const char* _key, con
   index=container.N;
   container.NodeL::append(this);
   if(_parents.N) for(Node* p: _parents) addParent(p);
+  for(GraphEditCallback* cb: container.callbacks) cb->cb_new(this);
 }
 
 Node::~Node() {
+  for(GraphEditCallback* cb: container.callbacks) cb->cb_delete(this);
   if(container.isDoubleLinked) while(children.N) children.elem(-1)->removeParent(this);
   if(numChildren) LOG(-2) <<"It is not allowed to delete nodes that still have children";
   while(parents.N) removeParent(parents.elem(-1));
+  container.reset_keyIndex();
   if(this==container.elem(-1)) { //great: this is very efficient to remove without breaking indexing
     container.resizeCopy(container.N-1);
   } else {
@@ -275,6 +278,7 @@ Graph::Graph(const Graph& G) : Graph() {
 }
 
 Graph::~Graph() {
+  while(callbacks.N) { GraphEditCallback* cb=callbacks.popLast(); cb->cb_graphDestruct(); }
   clear();
 }
 
@@ -283,6 +287,7 @@ bool Graph::operator!() const {
 }
 
 void Graph::clear() {
+  for(GraphEditCallback* cb: callbacks) cb->cb_clear();
   if(ri) { delete ri; ri=nullptr; }
   if(pi) { delete pi; pi=nullptr; }
   DEBUG(checkConsistency();)
@@ -338,9 +343,51 @@ void Graph::appendDict(const std::map<std::string, std::string>& dict) {
   }
 }
 
+/// the nodes of G (not its subgraphs) with given key, from the key index; only for graphs with G.N>=32 and while holding G._keyIndexMutex
+static const NodeL& keyIndexFind(const Graph& G, const char* key) {
+  //-- extend the index by the nodes appended since the last call
+  for(; G._keyIndexN<G.N; G._keyIndexN++) {
+    Node* n = G.elem(G._keyIndexN);
+    G._keyIndex[std::string(n->key.p, n->key.N)].append(n);
+  }
+  auto it = G._keyIndex.find(key);
+  if(it!=G._keyIndex.end()) {
+    //-- drop nodes that were renamed since they were indexed
+    NodeL& L = it->second;
+    for(uint i=L.N; i--;) if(!L.elem(i)->matches(key)) L.remove(i);
+    if(L.N) return L;
+  }
+  //-- not indexed: nodes might have been renamed after they were indexed
+  static const NodeL none;
+  NodeL L;
+  for(Node* n:G) if(n->matches(key)) L.append(n);
+  if(!L.N) return none;
+  return G._keyIndex[key] = L;
+}
+
+static bool useKeyIndex(const Graph& G, const char* key) { return key && G.N>=32; }
+
+void Node::setKey(const char* _key) {
+  Graph& G = container;
+  std::lock_guard<std::mutex> lock(G._keyIndexMutex);
+  if(!G.isIndexed) G.index(); //after deletions in the middle, the indices of later nodes are stale
+  if(index<G._keyIndexN) { //already indexed: move to the list of the new key, in node order
+    auto it = G._keyIndex.find(std::string(key.p, key.N));
+    if(it!=G._keyIndex.end()) it->second.removeValue(this, false);
+    NodeL& L = G._keyIndex[_key];
+    uint i=L.N;
+    while(i && L.elem(i-1)->index>index) i--;
+    L.insert(i, this);
+  }
+  key = _key;
+}
+
 Node* Graph::findNode(const char* key, bool recurseUp, bool recurseDown) const {
-//  for(uint i=N;i--;) if(elem(i)->matches(key)) return elem(i);
-  for(Node *n:(*this)) if(n->matches(key)) return n;
+  if(useKeyIndex(*this, key)) {
+    std::lock_guard<std::mutex> lock(_keyIndexMutex);
+    const NodeL& L = keyIndexFind(*this, key);
+    if(L.N) return L.elem(0);
+  } else for(Node* n:(*this)) if(n->matches(key)) return n;
   Node* ret=nullptr;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNode(key, true, false);
   if(ret) return ret;
@@ -354,7 +401,10 @@ Node* Graph::findNode(const char* key, bool recurseUp, bool recurseDown) const {
 }
 
 Node* Graph::findNodeOfType(const std::type_info& type, const char* key, bool recurseUp, bool recurseDown) const {
-  for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) return n;
+  if(useKeyIndex(*this, key)) {
+    std::lock_guard<std::mutex> lock(_keyIndexMutex);
+    for(Node* n: keyIndexFind(*this, key)) if(n->type==type) return n;
+  } else for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) return n;
   Node* ret=nullptr;
   if(recurseUp && isNodeOfGraph) ret = isNodeOfGraph->container.findNodeOfType(type, key, true, false);
   if(ret) return ret;
@@ -367,7 +417,10 @@ Node* Graph::findNodeOfType(const std::type_info& type, const char* key, bool re
 
 NodeL Graph::findNodes(const char* key, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node* n: (*this)) if(n->matches(key)) ret.append(n);
+  if(useKeyIndex(*this, key)) {
+    std::lock_guard<std::mutex> lock(_keyIndexMutex);
+    ret = keyIndexFind(*this, key);
+  } else for(Node* n: (*this)) if(n->matches(key)) ret.append(n);
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodes(key, true, false));
   if(recurseDown) for(Node* n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodes(key, false, true));
   return ret;
@@ -375,7 +428,10 @@ NodeL Graph::findNodes(const char* key, bool recurseUp, bool recurseDown) const
 
 NodeL Graph::findNodesOfType(const std::type_info& type, const char* key, bool recurseUp, bool recurseDown) const {
   NodeL ret;
-  for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) ret.append(n);
+  if(useKeyIndex(*this, key)) {
+    std::lock_guard<std::mutex> lock(_keyIndexMutex);
+    for(Node* n: keyIndexFind(*this, key)) if(n->type==type) ret.append(n);
+  } else for(Node* n: (*this)) if(n->type==type && (!key || n->matches(key))) ret.append(n);
   if(recurseUp && isNodeOfGraph) ret.append(isNodeOfGraph->container.findNodesOfType(type, key, true, false));
   if(recurseDown) for(Node* n: (*this)) if(n->isGraph()) ret.append(n->graph().findNodesOfType(type, key, false, true));
   return ret;
@@ -1119,6 +1175,7 @@ void Graph::sortByDotOrder() {
     }
   }
   permuteInv(perm);
+  reset_keyIndex();
   it_COUNT=0;
   for(Node *it: list()) it->index=it_COUNT++;
 }
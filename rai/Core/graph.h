@@ -14,6 +14,8 @@
 #include <math.h>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 //===========================================================================
 
@@ -49,6 +51,7 @@ struct Node {
   void addParent(Node* p, bool prepend=false);
   void removeParent(Node* p);
   void swapParent(uint i, Node* p);
+  void setKey(const char* _key); ///< change the key (keeps the container's key index up to date -- don't assign key directly)
 
   //-- get value
   template<class T> bool isOfType() const { return type==typeid(T); }
@@ -97,6 +100,12 @@ struct Graph : NodeL {
   ArrayG<ParseInfo>* pi;     ///< optional annotation of nodes: when detailed file parsing is enabled
   ArrayG<RenderingInfo>* ri; ///< optional annotation of nodes: dot style commands
 
+  GraphEditCallbackL callbacks; ///< notified on node creation/deletion and graph destruction (not copied with the graph)
+
+  mutable std::unordered_map<std::string, NodeL> _keyIndex; ///< key -> nodes of the first _keyIndexN nodes (extended by the find methods of larger graphs)
+  mutable uint _keyIndexN=0;
+  mutable std::mutex _keyIndexMutex; ///< the find methods extend the index, also of graphs shared between threads
+
   //-- constructors
   Graph();                                               ///< empty graph
   explicit Graph(const char* filename, bool parseInfo=false);         ///< read from a file
@@ -132,6 +141,7 @@ struct Graph : NodeL {
   Node* findNodeOfType(const std::type_info& type, const char* key, bool recurseUp=false, bool recurseDown=false) const;
   NodeL findNodesOfType(const std::type_info& type, const char* key, bool recurseUp=false, bool recurseDown=false) const;
   NodeL findGraphNodesWithTag(const char* tag) const;
+  void reset_keyIndex() const { std::lock_guard<std::mutex> lock(_keyIndexMutex); if(_keyIndexN) { _keyIndex.clear(); _keyIndexN=0; } } ///< needed when nodes are reordered
 
   //-- get nodes
   Node* operator[](const char* key) const { return findNode(key); } ///< returns nullptr if not found
@@ -200,10 +210,13 @@ inline bool Node::isGraph() const { return type==typeid(Graph); }
 
 //===========================================================================
 
+/// to keep additional data structures in sync with a graph: append to Graph::callbacks;
+/// cb_new is called after a node was appended (with its parents), cb_delete before it is removed
 struct GraphEditCallback {
   virtual ~GraphEditCallback() {}
   virtual void cb_new(Node*) {}
   virtual void cb_delete(Node*) {}
+  virtual void cb_clear() {} ///< called by Graph::clear before all nodes are deleted
   virtual void cb_graphDestruct() {}
 };
 
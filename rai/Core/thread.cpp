@@ -112,20 +112,27 @@ void Signaler::broadcast(Signaler* messenger) {
 
 void Event::listenTo(Var_base& v) {
   auto lock = statusMutex(RAI_HERE);
-  v.readAccess();
+  v.rwlock.writeLock(); //not writeAccess: this is no revision
   variables.append(&v);
   v.callbacks.append(new Callback<void(Var_base*)>(this, std::bind(&Event::callback, this, std::placeholders::_1)));
-  v.deAccess();
+  v.rwlock.unlock();
 }
 
 void Event::stopListenTo(Var_base& v) {
-  v.readAccess();
+  //unlink the callback, then wait until no notification of a SeqVar (outside of its lock) might still call it
+  Callback<void(Var_base*)>* c=nullptr;
+  v.rwlock.writeLock();
+  for(uint i=0; i<v.callbacks.N; i++) if(v.callbacks.elem(i)->id==this) { c=v.callbacks.elem(i); v.callbacks.remove(i); break; }
+  v.rwlock.unlock();
+  {
+    std::unique_lock<std::mutex> lock(v.notifyMutex);
+    v.notifyDone.wait(lock, [&v]() { return !v.notifying; });
+  }
   auto lock = statusMutex(RAI_HERE);
   int i=variables.findValue(&v);
   CHECK_GE(i, 0, "something's wrong");
   variables.remove(i);
-  v.callbacks.removeCallback(this);
-  v.deAccess();
+  delete c;
 }
 
 void Event::stopListening() {
@@ -542,6 +549,86 @@ void Thread::main() {
   event.setStatus(tsIsClosed);
 }
 
+//===========================================================================
+//
+// WorkerPool
+//
+
+WorkerPool::WorkerPool(uint nWorkers) : nextItem(0) {
+  CHECK_GE(nWorkers, 1, "need at least one worker (the caller)");
+  for(uint w=1; w<nWorkers; w++) threads.append(make_shared<std::thread>(&WorkerPool::loop, this, w));
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    auto lock = mutex(RAI_HERE);
+    stop=true;
+  }
+  wakeup.notify_all();
+  for(std::shared_ptr<std::thread>& th:threads) th->join();
+}
+
+void WorkerPool::run(uint n, const std::function<void(uint, uint)>& f) {
+  if(!n) return;
+  if(!threads.N || n==1) { //nothing to distribute
+    for(uint i=0; i<n; i++) f(i, 0);
+    return;
+  }
+  {
+    auto lock = mutex(RAI_HERE);
+    job = &f;
+    jobItems = n;
+    jobException = nullptr;
+    nextItem = 0;
+    workersBusy = threads.N;
+    jobRevision++;
+  }
+  wakeup.notify_all();
+
+  work(0);
+
+  std::exception_ptr ex;
+  {
+    auto lock = mutex(RAI_HERE);
+    finished.wait(lock, [this]() { return !workersBusy; });
+    job = 0;
+    ex = jobException;
+  }
+  if(ex) std::rethrow_exception(ex);
+}
+
+void WorkerPool::work(uint worker) {
+  for(;;) {
+    uint i = nextItem++;
+    if(i>=jobItems) break;
+    try {
+      (*job)(i, worker);
+    } catch(...) {
+      auto lock = mutex(RAI_HERE);
+      if(!jobException) jobException = std::current_exception();
+      nextItem = jobItems; //skip remaining items
+    }
+  }
+}
+
+void WorkerPool::loop(uint worker) {
+  uint lastRevision=0;
+  for(;;) {
+    {
+      auto lock = mutex(RAI_HERE);
+      wakeup.wait(lock, [this, &lastRevision]() { return stop || jobRevision!=lastRevision; });
+      if(stop) return;
+      lastRevision = jobRevision;
+    }
+    work(worker);
+    {
+      auto lock = mutex(RAI_HERE);
+      workersBusy--;
+      if(!workersBusy) finished.notify_all();
+    }
+  }
+}
+
 //===========================================================================
 //
 // controlling threads
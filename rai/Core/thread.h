@@ -15,6 +15,9 @@
 #include <shared_mutex>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
 
 enum ThreadState { tsIsClosed=-6, tsToOpen=-1, tsLOOPING=-2, tsBEATING=-3, tsIDLE=0, tsToStep=1, tsToClose=-4,  tsFAILURE=-5,  }; //positive states indicate steps-to-go
 struct Signaler;
@@ -74,6 +77,9 @@ struct Var_base : NonCopyable {
   double write_time=0.;        ///< clock time of last write access
   double data_time=0.;         ///< time stamp of the original data source
   CallbackL<void(Var_base*)> callbacks;
+  int notifying=0;             ///< notifications calling callbacks outside of the lock (SeqVar) -- awaited before a removed callback is deleted
+  std::mutex notifyMutex;      ///< guards notifying
+  std::condition_variable notifyDone;
 
   Var_base(const char* _name=0);
   /// @name c'tor/d'tor
@@ -222,6 +228,100 @@ struct Var {
 
 template<class T> std::ostream& operator<<(std::ostream& os, Var<T>& x) { x.write(os); return os; }
 
+//===========================================================================
+//
+// lock-free variables for small POD messages (e.g. in control loops)
+//
+
+/** The data of a SeqVar: a seqlock over a trivially copyable T. The (single) writer never waits for readers:
+ *  publishing only increments the sequence counter around the store; readers never lock, but copy the data and
+ *  retry if a write interleaved, so they always obtain the latest consistent revision. The data words are atomics,
+ *  so that torn copies are detected, not undefined. Listeners are notified after publishing: the Var_base's
+ *  rwlock is only held to copy the callback list (it contends with listeners being (un)registered, not with
+ *  readers), the callbacks themselves are called outside of any lock. */
+template<class T>
+struct SeqVar_data : Var_base {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqVar requires a trivially copyable (POD-like) type");
+  enum { W=(sizeof(T)+sizeof(uint64_t)-1)/sizeof(uint64_t) };
+  std::atomic<uint> seq;             ///< odd while a write is in progress; seq/2 is the revision
+  std::atomic<uint64_t> words[W];    ///< the published data
+  T staging;                         ///< the writer's copy, published on publish()
+  std::atomic<bool> writing;
+
+  SeqVar_data(const char* name=0) : Var_base(name), seq(0), staging(), writing(false) { store(); }
+
+  uint read(T& x) const;             ///< copies the latest consistent revision into x and returns its revision
+  void publish();                    ///< publishes staging as the next revision (called by SeqWToken)
+  void notify();                     ///< calls the listeners' callbacks (called by SeqWToken after publish)
+  uint getRevision() const { return seq.load(std::memory_order_acquire)/2; }
+
+private:
+  CallbackL<void(Var_base*)> listeners; ///< the writer's copy of the callback list
+  void store();
+};
+
+/// read token of a SeqVar: a copy of the latest revision (no lock is held)
+template<class T>
+struct SeqRToken {
+  T data;
+  SeqRToken(const SeqVar_data<T>& var, int* getRevision=nullptr) { int r=var.read(data); if(getRevision) *getRevision=r; }
+  const T* operator->() { return &data; }
+  operator const T& () { return data; }
+  const T& operator()() { return data; }
+};
+
+/// write token of a SeqVar: edits the writer's copy, which is published on destruction
+template<class T>
+struct SeqWToken {
+  SeqVar_data<T>* var;
+  SeqWToken(SeqVar_data<T>& _var) : var(&_var) {
+    CHECK(!var->writing.exchange(true, std::memory_order_acquire), "SeqVar '" <<var->name <<"' has a single writer, but two write tokens are alive");
+  }
+  SeqWToken(const double& dataTime, SeqVar_data<T>& _var) : SeqWToken(_var) { var->data_time=dataTime; }
+  SeqWToken(SeqWToken&& w) : var(w.var) { w.var=0; }
+  ~SeqWToken() { if(var) { var->publish(); var->notify(); } }
+  void operator=(const T& y) { var->staging=y; }
+  T* operator->() { return &var->staging; }
+  operator T& () { return var->staging; }
+  T& operator()() { return var->staging; }
+};
+
+/** A drop-in alternative to Var<T> for trivially copyable message types: the same get()/set() tokens,
+ *  revision counting and callbacks, but backed by a seqlock instead of the RWLock, so that a control loop
+ *  writing the variable is never blocked by readers, and readers never block each other or the writer.
+ *  There must only be a single writing thread at a time; get() returns a copy instead of a locked reference. */
+template<class T>
+struct SeqVar {
+  shared_ptr<SeqVar_data<T>> data;
+  Thread* thread;             ///< which thread is the owner
+  int last_read_revision;     ///< last revision that has been read
+
+  SeqVar() : SeqVar(nullptr) {}
+  SeqVar(const SeqVar<T>& v) : SeqVar(nullptr, v, false) {}
+  SeqVar(Thread* _thread, bool threadListens=false);
+  SeqVar(Thread* _thread, const SeqVar<T>& v, bool threadListens=false);
+
+  SeqVar& operator=(const SeqVar& v){ HALT("you can't copy Var!") }
+
+  SeqRToken<T> get() { return SeqRToken<T>(*data, &last_read_revision); } ///< a copy of the latest revision
+  SeqWToken<T> set() { return SeqWToken<T>(*data); } ///< write access to the variable's data
+  SeqWToken<T> set(const double& dataTime) { return SeqWToken<T>(dataTime, *data); } ///< write access to the variable's data
+  operator Var_base& () { return *data; }
+
+  rai::String& name() const { return data->name; }
+  int getRevision() { return data->getRevision(); }
+  bool hasNewRevision() { return getRevision()>last_read_revision; }
+  void waitForNextRevision(uint multipleRevisions=0) { waitForRevisionGreaterThan(last_read_revision+multipleRevisions); }
+  int waitForRevisionGreaterThan(int rev);
+  void stopListening();
+
+  void addCallback(const std::function<void(Var_base*)>& call, const void* callbackID=0) {
+    data->rwlock.writeLock();
+    data->addCallback(call, callbackID);
+    data->rwlock.unlock();
+  }
+};
+
 //===========================================================================
 
 /// a basic condition variable
@@ -380,6 +480,33 @@ struct Thread {
 
 //===========================================================================
 
+/** A fixed pool of worker threads to run index-parallel loops: run(n, f)
+ * calls f(i, worker) for all i<n, distributing items dynamically over the
+ * workers (the calling thread participates as worker 0) and returns when all
+ * items are done. An exception thrown by f is rethrown by run. */
+struct WorkerPool : NonCopyable {
+  rai::Array<std::shared_ptr<std::thread>> threads;
+  Mutex mutex;
+  std::condition_variable wakeup, finished;
+  const std::function<void(uint, uint)>* job=0;
+  uint jobItems=0, jobRevision=0, workersBusy=0;
+  std::atomic<uint> nextItem;
+  std::exception_ptr jobException;
+  bool stop=false;
+
+  WorkerPool(uint nWorkers);
+  ~WorkerPool();
+
+  uint nWorkers() const { return threads.N+1; }
+  void run(uint n, const std::function<void(uint item, uint worker)>& f);
+
+private:
+  void work(uint worker);
+  void loop(uint worker);
+};
+
+//===========================================================================
+
 struct ScriptThread : Thread {
   std::function<int()> script;
   Var<ActStatus> status;
@@ -447,3 +574,79 @@ int Var<T>::waitForRevisionGreaterThan(int rev) {
 
 template<class T>
 void Var<T>::stopListening() { thread->event.stopListenTo(data); }
+
+template<class T>
+void SeqVar_data<T>::store() {
+  uint64_t buf[W];
+  buf[W-1]=0;
+  memcpy(buf, &staging, sizeof(T));
+  for(uint i=0; i<W; i++) words[i].store(buf[i], std::memory_order_relaxed);
+}
+
+template<class T>
+uint SeqVar_data<T>::read(T& x) const {
+  uint64_t buf[W];
+  for(;;) {
+    uint s0 = seq.load(std::memory_order_acquire);
+    if(s0&1) { std::this_thread::yield(); continue; }
+    for(uint i=0; i<W; i++) buf[i] = words[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(seq.load(std::memory_order_relaxed)==s0) {
+      memcpy(&x, buf, sizeof(T));
+      return s0/2;
+    }
+  }
+}
+
+template<class T>
+void SeqVar_data<T>::publish() {
+  uint s = seq.load(std::memory_order_relaxed);
+  seq.store(s+1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  store();
+  seq.store(s+2, std::memory_order_release);
+  writing.store(false, std::memory_order_release);
+}
+
+template<class T>
+void SeqVar_data<T>::notify() {
+  //as Var_base::deAccess, but the callbacks are called on a copy of the list, outside of the lock;
+  //Event::stopListenTo waits for such notifications before it deletes its callback
+  rwlock.writeLock();
+  write_time = rai::clockTime();
+  revision = getRevision();
+  listeners = callbacks;
+  { std::lock_guard<std::mutex> lock(notifyMutex); notifying++; }
+  rwlock.unlock();
+  for(auto* c:listeners) c->call()(this);
+  { std::lock_guard<std::mutex> lock(notifyMutex); notifying--; }
+  notifyDone.notify_all();
+}
+
+template<class T>
+SeqVar<T>::SeqVar(Thread* _thread, bool threadListens)
+  : data(make_shared<SeqVar_data<T>>()), thread(_thread), last_read_revision(0) {
+  if(thread && threadListens) thread->event.listenTo(*data);
+}
+
+template<class T>
+SeqVar<T>::SeqVar(Thread* _thread, const SeqVar<T>& v, bool threadListens)
+  : data(v.data), thread(_thread), last_read_revision(0) {
+  if(thread && threadListens) thread->event.listenTo(*data);
+}
+
+template<class T>
+int SeqVar<T>::waitForRevisionGreaterThan(int rev) {
+  EventFunction evFct = [&rev](const rai::Array<Var_base*>& vars, int whoChanged) -> int {
+    CHECK_EQ(vars.N, 1, ""); //this event only checks the revision for a single var
+    if(vars.elem()->revision > (uint)rev) return 1;
+    return 0;
+  };
+
+  Event ev({data.get()}, evFct, 0);
+  if(getRevision()<=rev) ev.waitForStatusEq(1);
+  return getRevision();
+}
+
+template<class T>
+void SeqVar<T>::stopListening() { thread->event.stopListenTo(*data); }
@@ -0,0 +1,146 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "trace.h"
+#include "util.h"
+
+#include <chrono>
+#include <atomic>
+
+namespace {
+
+/// an event in a ring buffer; the fields are relaxed atomics, as snapshots may read them while the thread overwrites them
+struct Slot {
+  std::atomic<const char*> name;
+  std::atomic<int64_t> start, duration;
+  std::atomic<uint32_t> depth;
+};
+
+/// the ring buffer of one thread; only its thread writes, others take snapshots (see getEvents)
+struct Buffer {
+  std::vector<Slot> events;
+  std::atomic<uint64_t> count; ///< number of events recorded so far (the last min(count, size) are kept), acts as a sequence counter
+  std::atomic<uint64_t> begin; ///< events before are dropped by clear() -- the writer's count is never reset
+  Buffer(uint32_t size) : events(size), count(0), begin(0) {}
+};
+
+std::mutex buffersMutex;
+std::vector<std::shared_ptr<Buffer>> buffers; //owned here, so that events of finished threads remain
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+thread_local Buffer* threadBuffer=0;
+thread_local uint32_t threadDepth=0;
+
+Buffer* getThreadBuffer() {
+  if(!threadBuffer) {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffers.push_back(std::make_shared<Buffer>(rai::MAX(rai::trace::bufferSize, 1u)));
+    threadBuffer = buffers.back().get();
+  }
+  return threadBuffer;
+}
+
+void writeJsonString(std::ostream& os, const char* str) {
+  os <<'"';
+  for(const char* c=str; *c; c++) {
+    if(*c=='"' || *c=='\\') os <<'\\' <<*c;
+    else if((unsigned char)*c<0x20) os <<' ';
+    else os <<*c;
+  }
+  os <<'"';
+}
+
+}
+
+//===========================================================================
+
+namespace rai {
+namespace trace {
+
+bool enabled=true;
+uint32_t bufferSize=1<<16;
+
+int64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-epoch).count();
+}
+
+uint32_t& depth() { return threadDepth; }
+
+void record(const char* name, int64_t start, int64_t duration, uint32_t depth) {
+  Buffer* b = getThreadBuffer();
+  uint64_t i = b->count.load(std::memory_order_relaxed);
+  //a snapshot that reads any of the new fields also sees count>=i (it then drops the overwritten event i-size)
+  std::atomic_thread_fence(std::memory_order_release);
+  Slot& e = b->events[i%b->events.size()];
+  e.name.store(name, std::memory_order_relaxed);
+  e.start.store(start, std::memory_order_relaxed);
+  e.duration.store(duration, std::memory_order_relaxed);
+  e.depth.store(depth, std::memory_order_relaxed);
+  b->count.store(i+1, std::memory_order_release);
+}
+
+uint32_t getThreadCount() {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  return buffers.size();
+}
+
+std::vector<Event> getEvents(uint32_t thread) {
+  std::shared_ptr<Buffer> b;
+  {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    CHECK_LE(thread+1, buffers.size(), "no such tracing thread");
+    b = buffers[thread];
+  }
+  //-- copy the window, while the thread might continue recording
+  uint64_t size = b->events.size();
+  uint64_t n = b->count.load(std::memory_order_acquire);
+  uint64_t lo = std::max(b->begin.load(std::memory_order_relaxed), n>size ? n-size : 0);
+  std::vector<Event> E(n-lo);
+  for(uint64_t i=lo; i<n; i++) {
+    const Slot& e = b->events[i%size];
+    E[i-lo] = {e.name.load(std::memory_order_relaxed), e.start.load(std::memory_order_relaxed),
+               e.duration.load(std::memory_order_relaxed), e.depth.load(std::memory_order_relaxed)};
+  }
+  //-- drop the oldest events, which may have been overwritten meanwhile: recording event m overwrites event m-size
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint64_t m = b->count.load(std::memory_order_relaxed);
+  uint64_t skip = (m+1>lo+size ? std::min(m+1-size-lo, n-lo) : 0);
+  E.erase(E.begin(), E.begin()+skip);
+  return E;
+}
+
+void clear() {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  for(auto& b:buffers) b->begin = b->count.load(std::memory_order_acquire);
+}
+
+void write(const char* filename) {
+  std::ofstream fil(filename);
+  CHECK(fil.good(), "could not open trace file '" <<filename <<"'");
+  fil <<std::fixed;
+  fil.precision(3);
+  fil <<"{\"traceEvents\":[";
+  bool first=true;
+  uint32_t n = getThreadCount();
+  for(uint32_t t=0; t<n; t++) {
+    for(const Event& e:getEvents(t)) {
+      if(!first) fil <<',';
+      first=false;
+      fil <<"\n{\"name\":";
+      writeJsonString(fil, e.name);
+      fil <<",\"ph\":\"X\",\"pid\":0,\"tid\":" <<t
+          <<",\"ts\":" <<1e-3*e.start <<",\"dur\":" <<1e-3*e.duration
+          <<",\"args\":{\"depth\":" <<e.depth <<"}}";
+    }
+  }
+  fil <<"\n],\"displayTimeUnit\":\"ms\"}" <<endl;
+}
+
+} //namespace trace
+} //namespace rai
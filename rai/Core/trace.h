@@ -0,0 +1,71 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+//===========================================================================
+//
+// scoped tracing of hot paths
+//
+
+/** RAI_TRACE_SCOPE(name) records the wall time of the enclosing scope as one event of the calling thread;
+ *  nested scopes become nested events. Names must be string literals or otherwise static strings (e.g.
+ *  niceTypeidName) -- only the pointer is stored. Each thread records into its own ring buffer (the oldest events
+ *  are overwritten), so recording takes no lock. rai::trace::write(filename) exports all buffers in the Chrome
+ *  trace-event JSON format (load in chrome://tracing or ui.perfetto.dev).
+ *  The macros only compile to code with -DRAI_TRACE (TRACE=1 in config.mk); otherwise they vanish. */
+#ifdef RAI_TRACE
+#  define RAI_TRACE_CONCAT2(a, b) a##b
+#  define RAI_TRACE_CONCAT(a, b) RAI_TRACE_CONCAT2(a, b)
+#  define RAI_TRACE_SCOPE(name) rai::trace::Scope RAI_TRACE_CONCAT(_traceScope, __LINE__)(name)
+#else
+#  define RAI_TRACE_SCOPE(name)
+#endif
+
+namespace rai {
+namespace trace {
+
+/// a completed scope
+struct Event {
+  const char* name;
+  int64_t start;     ///< ns since the trace epoch
+  int64_t duration;  ///< ns
+  uint32_t depth;    ///< nesting depth within the thread
+};
+
+extern bool enabled; ///< runtime switch (default: true); scopes opened while disabled are not recorded
+extern uint32_t bufferSize; ///< capacity of the ring buffers of threads that start recording (default 1<<16)
+
+int64_t now(); ///< ns since the trace epoch
+void record(const char* name, int64_t start, int64_t duration, uint32_t depth);
+uint32_t& depth(); ///< current nesting depth of the calling thread
+
+/// RAII scope, see RAI_TRACE_SCOPE
+struct Scope {
+  const char* name;
+  int64_t start;
+  Scope(const char* _name) : name(enabled ? _name : 0) {
+    if(name) { start = now(); depth()++; }
+  }
+  ~Scope() {
+    if(name) { uint32_t d = --depth(); record(name, start, now()-start, d); }
+  }
+};
+
+/// the recorded events of the i-th recording thread, oldest first -- a consistent snapshot, also while the thread records
+/// (events it overwrote during the copy are left out)
+std::vector<Event> getEvents(uint32_t thread);
+uint32_t getThreadCount();
+void clear();                 ///< drop all recorded events (recording threads are not disturbed)
+void write(const char* filename); ///< write all recorded events as Chrome trace-event JSON
+
+} //namespace trace
+} //namespace rai
@@ -1071,6 +1071,7 @@ rai::String rai::FileToken::absolutePathName() const {
 rai::Rnd rnd;
 
 uint32_t rai::Rnd::seed(uint32_t n) {
+  masterSeed=n;
   uint32_t s, c;
   if(n>12345) { s=n; c=n%113; } else { s=12345; c=n; }
   while(c--) s*=65539;
@@ -1144,6 +1145,58 @@ void  rai::Rnd::seed250(int32_t seed) {
   for(i=0; i<4711; ++i) rnd250();
 }
 
+rai::RndStream rai::Rnd::stream(uint32_t i) {
+  if(!ready) seed();
+  return RndStream(masterSeed, i);
+}
+
+void rai::RndStream::seed(uint64_t seed, uint32_t stream) {
+  //splitmix64 to fill the state (never all zero)
+  for(uint i=0; i<4; i++) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z>>30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z>>27)) * 0x94d049bb133111ebull;
+    s[i] = z ^ (z>>31);
+  }
+  while(stream--) jump();
+}
+
+void rai::RndStream::jump() {
+  static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+  uint64_t t[4] = {0, 0, 0, 0};
+  for(uint i=0; i<4; i++) for(uint b=0; b<64; b++) {
+    if(JUMP[i] & (uint64_t(1)<<b)) for(uint k=0; k<4; k++) t[k] ^= s[k];
+    next();
+  }
+  for(uint k=0; k<4; k++) s[k] = t[k];
+}
+
+double rai::RndStream::gauss() {
+  double x;
+  gauss(&x, 1);
+  return x;
+}
+
+void rai::RndStream::uniform(double* x, uint n, double low, double high, bool add) {
+  double scale = (high-low)/9007199254740992.; //2^53
+  if(!add) for(uint i=0; i<n; i++) x[i] = low + (next()>>11)*scale;
+  else     for(uint i=0; i<n; i++) x[i] += low + (next()>>11)*scale;
+}
+
+void rai::RndStream::gauss(double* x, uint n, double stdDev, bool add) {
+  double z[2];
+  for(uint i=0; i<n; i+=2) {
+    double r = stdDev*::sqrt(-2.*::log(1.-uni())); //1-uni() in (0,1]
+    double phi = 2.*RAI_PI*uni();
+    z[0] = std::sin(phi);
+    z[1] = std::cos(phi);
+    for(uint k=0; k<2 && i+k<n; k++) {
+      if(!add) x[i+k] = r*z[k];
+      else     x[i+k] += r*z[k];
+    }
+  }
+}
+
 namespace rai{
   uint rndInt(uint up){ return rnd.num(up); }
 }
@@ -415,6 +415,7 @@ class Rnd {
  public:/// @name initialization
   /// initialize with a specific seed
   uint32_t seed(uint32_t n);
+  uint32_t masterSeed=0; ///< the last seed (from which stream(i) derives)
 
   /// use Parameter<uint>("seed") as seed
   uint32_t seed();
@@ -446,6 +447,9 @@ class Rnd {
     \c floor(mean+gauss(sqrt(mean))+.5) is returned */
   uint32_t poisson(double mean);
 
+  /// the i-th independent stream of the current seed (see RndStream)
+  struct RndStream stream(uint32_t i);
+
  private:
   int32_t rnd250() {
     rpoint = (rpoint+1) & 255;          // Index erhoehen
@@ -456,6 +460,38 @@ class Rnd {
   void seed250(int32_t seed);
 };
 
+/** @brief xoshiro256** generator with jump-ahead. RndStream(seed, i) is the i-th of (2^128) non-overlapping
+  streams of a master seed, so that parallel workers (e.g., indexed by the WorkerPool worker) draw independent and
+  reproducible samples without sharing a generator. Not thread safe itself: one stream per thread. */
+struct RndStream {
+  uint64_t s[4];
+
+  RndStream(uint64_t seed=0, uint32_t stream=0) { this->seed(seed, stream); }
+  void seed(uint64_t seed, uint32_t stream=0);
+  void jump(); ///< advance by 2^128 draws (to the next stream)
+
+  uint64_t next() {
+    const uint64_t result = rotl(s[1]*5, 7)*9;
+    const uint64_t t = s[1] <<17;
+    s[2] ^= s[0];  s[3] ^= s[1];  s[1] ^= s[2];  s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+  }
+  uint32_t num() { return next() >>32; }
+  uint32_t num(uint32_t limit) { CHECK(limit, "zero limit in RndStream::num()"); return (uint32_t)(((next()>>32)*(uint64_t)limit)>>32); }
+  double uni() { return (next()>>11) * (1./9007199254740992.); } ///< uniform in [0, 1)
+  double uni(double low, double high) { return low+uni()*(high-low); }
+  double gauss();
+
+  //-- bulk fill
+  void uniform(double* x, uint n, double low=0., double high=1., bool add=false);
+  void gauss(double* x, uint n, double stdDev=1., bool add=false); ///< Box-Muller in pairs (no rejection loop)
+
+ private:
+  static uint64_t rotl(uint64_t x, int k) { return (x<<k) | (x>>(64-k)); }
+};
+
 }
 /// The global Rnd object
 extern rai::Rnd rnd;
@@ -160,8 +160,16 @@ static const int successor[16][4] = {
 
 #endif /* CONSTRUCT_TABLES */
 
-static REAL delta_values[TWICE_TWO_TO_DIM][DIM_PLUS_ONE];
-static REAL dot_products[DIM_PLUS_ONE][DIM_PLUS_ONE];
+/* the scratch tables below are per-thread, so that distances can be
+   computed concurrently (e.g. parallel collision feature evaluation) */
+#if defined(__GNUC__)
+#define GJK_THREAD_LOCAL __thread
+#else
+#define GJK_THREAD_LOCAL
+#endif
+
+static GJK_THREAD_LOCAL REAL delta_values[TWICE_TWO_TO_DIM][DIM_PLUS_ONE];
+static GJK_THREAD_LOCAL REAL dot_products[DIM_PLUS_ONE][DIM_PLUS_ONE];
 
 #ifdef CONSTRUCT_TABLES
 static void initialise_simplex_distance( void);
@@ -523,7 +531,7 @@ int gjk_extract_point( struct simplex_point *simp,
   return 1;
 }
 
-static REAL delta[TWICE_TWO_TO_DIM];
+static GJK_THREAD_LOCAL REAL delta[TWICE_TWO_TO_DIM];
 
 /* The simplex_distance routine requires the computation of a number of
    delta terms.  These are computed here.
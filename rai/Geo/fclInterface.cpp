@@ -7,6 +7,7 @@
     --------------------------------------------------------------  */
 
 #include "fclInterface.h"
+#include "../Core/thread.h"
 
 #ifdef RAI_FCL
 
@@ -68,6 +69,56 @@ rai::FclInterface::~FclInterface() {
 }
 
 void rai::FclInterface::step(const arr& X) {
+  setPoses(X);
+
+  collisions.clear();
+  manager->collide(this, BroadphaseCallback);
+  collisions.reshape(collisions.N/2, 2);
+}
+
+void rai::FclInterface::step(uintAA& collisionsPerState, const arrA& Xs) {
+  //-- without pool: state by state, with the narrowphase in the broadphase callback
+  collisionsPerState.resize(Xs.N);
+  if(!pool) {
+    for(uint s=0; s<Xs.N; s++) {
+      step(Xs(s));
+      collisionsPerState(s) = collisions;
+    }
+    return;
+  }
+
+  //-- broadphase: sequential over the states, as the manager holds the object poses
+  broadphasePairs.clear();
+  collectPairs = true;
+  for(uint s=0; s<Xs.N; s++) {
+    setPoses(Xs(s));
+    broadphaseState = s;
+    manager->collide(this, BroadphaseCallback);
+  }
+  collectPairs = false;
+
+  //-- narrowphase: every pair independently (each writes only its own flag)
+  uint n = broadphasePairs.size();
+  byteA isCollision(n);
+  auto query = [this, &Xs, &isCollision](uint i, uint) {
+    const BroadphasePair& pair = broadphasePairs[i];
+    isCollision.p[i] = narrowphase(pair, Xs(pair.state));
+  };
+  if(n>1) pool->run(n, query);
+  else for(uint i=0; i<n; i++) query(i, 0);
+
+  //-- collect, in broadphase order
+  for(uintA& c:collisionsPerState) c.clear();
+  for(uint i=0; i<n; i++) if(isCollision.p[i]) {
+    const BroadphasePair& pair = broadphasePairs[i];
+    uintA& c = collisionsPerState(pair.state);
+    c.append((long int)pair.o1->getUserData());
+    c.append((long int)pair.o2->getUserData());
+  }
+  for(uintA& c:collisionsPerState) c.reshape(c.N/2, 2);
+}
+
+void rai::FclInterface::setPoses(const arr& X) {
   CHECK_EQ(X.nd, 2, "");
   CHECK_EQ(X.d0, convexGeometryData.N, "");
   CHECK_EQ(X.d1, 7, "");
@@ -81,13 +132,31 @@ void rai::FclInterface::step(const arr& X) {
   }
   manager->update();
 
-  collisions.clear();
-  manager->collide(this, BroadphaseCallback);
-  collisions.reshape(collisions.N/2, 2);
-
   X_lastQuery = X;
 }
 
+bool rai::FclInterface::narrowphase(const BroadphasePair& pair, const arr& X) const {
+  if(cutoff<0.) return true; //just broadphase
+
+  //poses are taken from X (not the objects), so that queries of different states can run concurrently
+  uint a = (long int)pair.o1->getUserData();
+  uint b = (long int)pair.o2->getUserData();
+  fcl::Transform3f Xa(fcl::Quaternion3f(X(a, 3), X(a, 4), X(a, 5), X(a, 6)), fcl::Vec3f(X(a, 0), X(a, 1), X(a, 2)));
+  fcl::Transform3f Xb(fcl::Quaternion3f(X(b, 3), X(b, 4), X(b, 5), X(b, 6)), fcl::Vec3f(X(b, 0), X(b, 1), X(b, 2)));
+
+  if(cutoff==0.) { //fine boolean collision query
+    fcl::CollisionRequest request;
+    fcl::CollisionResult result;
+    fcl::collide(pair.o1->collisionGeometry().get(), Xa, pair.o2->collisionGeometry().get(), Xb, request, result);
+    return result.isCollision();
+  }
+  //fine distance query
+  fcl::DistanceRequest request;
+  fcl::DistanceResult result;
+  fcl::distance(pair.o1->collisionGeometry().get(), Xa, pair.o2->collisionGeometry().get(), Xb, request, result);
+  return result.min_distance<cutoff;
+}
+
 void rai::FclInterface::addCollision(void* userData1, void* userData2) {
   uint a = (long int)userData1;
   uint b = (long int)userData2;
@@ -99,7 +168,9 @@ void rai::FclInterface::addCollision(void* userData1, void* userData2) {
 bool rai::FclInterface::BroadphaseCallback(fcl::CollisionObject* o1, fcl::CollisionObject* o2, void* cdata_) {
   rai::FclInterface* self = static_cast<rai::FclInterface*>(cdata_);
 
-  if(self->cutoff==0.) { //fine boolean collision query
+  if(self->collectPairs) { //narrowphase later, in parallel
+    self->broadphasePairs.push_back({o1, o2, self->broadphaseState});
+  } else if(self->cutoff==0.) { //fine boolean collision query
     fcl::CollisionRequest request;
     fcl::CollisionResult result;
     fcl::collide(o1, o2, request, result);
@@ -119,4 +190,5 @@ bool rai::FclInterface::BroadphaseCallback(fcl::CollisionObject* o1, fcl::Collis
 rai::FclInterface::FclInterface(const Array<shared_ptr<Mesh>>& _geometries, double _cutoff) { NICO }
 rai::FclInterface::~FclInterface() { NICO }
 void rai::FclInterface::step(const arr& X) { NICO }
+void rai::FclInterface::step(uintAA& collisionsPerState, const arrA& Xs) { NICO }
 #endif
@@ -16,6 +16,8 @@ class DynamicAABBTreeCollisionManager;
 class BroadPhaseCollisionManager;
 }
 
+struct WorkerPool;
+
 namespace rai {
 
 struct FclInterface {
@@ -26,13 +28,21 @@ struct FclInterface {
   double cutoff=0.; //0 -> perform fine boolean collision check; >0 -> perform fine distance computations; <0 -> only broadphase
   uintA collisions; //return values!
   arr X_lastQuery;  //memory to check whether an object has moved in consecutive queries
+  shared_ptr<WorkerPool> pool; //opt-in: if set, the batched step queries the narrowphase of all broadphase pairs in parallel on its workers
 
   FclInterface(const Array<shared_ptr<Mesh>>& geometries, double _cutoff=0.);
   ~FclInterface();
 
   void step(const arr& X);
+  void step(uintAA& collisionsPerState, const arrA& Xs); //same for a batch of states; with a pool, the narrowphase of all of them is one parallel pass
 
 private: //called by collision callback
+  struct BroadphasePair { fcl::CollisionObject *o1, *o2; uint state; };
+  std::vector<BroadphasePair> broadphasePairs;
+  uint broadphaseState=0;
+  bool collectPairs=false;
+  void setPoses(const arr& X);
+  bool narrowphase(const BroadphasePair& pair, const arr& X) const;
   void addCollision(void* userData1, void* userData2);
   static bool BroadphaseCallback(fcl::CollisionObject* o1, fcl::CollisionObject* o2, void* cdata_);
 };
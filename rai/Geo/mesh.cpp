@@ -13,6 +13,7 @@
 #include "../Optim/newton.h"
 
 #include <limits>
+#include <atomic>
 #include <algorithm>
 #include <math.h>
 
@@ -43,13 +44,25 @@ template<> const char* rai::Enum<rai::ShapeType>::names []= {
 rai::Mesh::Mesh()
   : glX(0)
     /*parsing_pos_start(0),
-    parsing_pos_end(std::numeric_limits<long>::max())*/{}
+    parsing_pos_end(std::numeric_limits<long>::max())*/{
+  changed();
+}
+
+static std::atomic<uint64_t> meshVersions(0);
+
+void rai::Mesh::changed(bool keepsConvexity) {
+  bool convex = keepsConvexity && isConvex();
+  version = ++meshVersions;
+  if(convex) convexVersion = version;
+}
 
 void rai::Mesh::clear() {
   V.clear(); Vn.clear();
   if(C.nd==2) C.clear();
   T.clear(); Tn.clear();
   graph.clear();
+  _bvh.reset();
+  changed();
 }
 
 void rai::Mesh::setBox(bool edgesOnly) {
@@ -279,6 +292,7 @@ void rai::Mesh::setCapsule(double r, double l, uint fineness) {
   Array, the elements of which are indices referring to vertices in
   the vertex list (V) */
 void rai::Mesh::setGrid(uint X, uint Y) {
+  changed();
   CHECK(X>1 && Y>1, "grid has to be at least 2x2");
   CHECK_EQ(V.d0, X*Y, "don't have X*Y mesh-vertices to create grid faces");
   uint i, j, k=T.d0;
@@ -304,6 +318,7 @@ rai::Mesh& rai::Mesh::setRandom(uint vertices) {
 }
 
 void rai::Mesh::subDivide() {
+  changed();
   uint v=V.d0, t=T.d0;
   V.resizeCopy(v+3*t, 3);
   uintA newT(4*t, 3);
@@ -324,6 +339,7 @@ void rai::Mesh::subDivide() {
 }
 
 void rai::Mesh::subDivide(uint i) {
+  changed();
   uint v=V.d0, t=T.d0;
   V.resizeCopy(v+3, 3);
   T.resizeCopy(t+3, 3);
@@ -338,16 +354,18 @@ void rai::Mesh::subDivide(uint i) {
   T(t, 0)=v+2; T(t, 1)=v+1; T(t, 2)=c;   t++;
 }
 
-void rai::Mesh::scale(double f) {  V *= f; }
+void rai::Mesh::scale(double f) {  V *= f;  changed(true); }
 
 void rai::Mesh::scale(double sx, double sy, double sz) {
   uint i;
   for(i=0; i<V.d0; i++) {  V(i, 0)*=sx;  V(i, 1)*=sy;  V(i, 2)*=sz;  }
+  changed(true);
 }
 
 void rai::Mesh::translate(double dx, double dy, double dz) {
   uint i;
   for(i=0; i<V.d0; i++) {  V(i, 0)+=dx;  V(i, 1)+=dy;  V(i, 2)+=dz;  }
+  changed(true);
 }
 
 void rai::Mesh::translate(const arr& d) {
@@ -357,11 +375,13 @@ void rai::Mesh::translate(const arr& d) {
 
 void rai::Mesh::transform(const rai::Transformation& t) {
   t.applyOnPointArray(V);
+  changed(true);
 }
 
 rai::Vector rai::Mesh::center() {
   arr Vmean = mean(V);
   for(uint i=0; i<V.d0; i++) V[i] -= Vmean;
+  changed(true);
   return Vector(Vmean);
 }
 
@@ -386,6 +406,7 @@ void rai::Mesh::box() {
 }
 
 void rai::Mesh::addMesh(const Mesh& mesh2, const rai::Transformation& X) {
+  changed();
   uint n=V.d0, tn=tex.d0, t=T.d0, tt=Tt.d0;
   V.append(mesh2.V);
   if(V.N==C.N && mesh2.V.N==mesh2.C.N) C.append(mesh2.C); else C.clear();
@@ -414,6 +435,9 @@ void rai::Mesh::makeConvexHull() {
   if(C.nd==2) C = mean(C);
   Vn.clear();
   Tn.clear();
+  if(V.d0>64) buildGraph(); else graph.clear(); //built here, as support() is a query on shared meshes
+  changed();
+  convexVersion = version;
   Tt.clear();
   tex.clear();
   texImg.clear();
@@ -442,6 +466,7 @@ void rai::Mesh::makeConvexHull() {
 }
 
 void rai::Mesh::makeTriangleFan() {
+  changed();
   T.clear();
   for(uint i=1; i+1<V.d0; i++) {
     T.append(uintA{0, i, i+1});
@@ -451,6 +476,7 @@ void rai::Mesh::makeTriangleFan() {
 }
 
 void rai::Mesh::makeLineStrip() {
+  changed();
   T.resize(V.d0-1, 2);
 //  T[0] = {V.d0-1, 0};
   for(uint i=1; i<V.d0; i++) {
@@ -459,6 +485,7 @@ void rai::Mesh::makeLineStrip() {
 }
 
 void rai::Mesh::setSSCvx(const arr& core, double r, uint fineness) {
+  changed();
   if(r>0.) {
     Mesh ball;
     ball.setSphere(fineness);
@@ -650,6 +677,7 @@ void permuteVertices(rai::Mesh& m, uintA& p) {
 /** @brief delete all void triangles (with vertex indices (0, 0, 0)) and void
   vertices (not used for triangles or strips) */
 void rai::Mesh::deleteUnusedVertices() {
+  changed();
   if(!V.N) return;
   uintA p;
   uintA u;
@@ -681,6 +709,7 @@ bool COMP(uint i, uint j) {
 /** @brief delete all void triangles (with vertex indices (0, 0, 0)) and void
   vertices (not used for triangles or strips) */
 void rai::Mesh::fuseNearVertices(double tol) {
+  changed();
   if(!V.N) return;
   uintA p;
   uint i, j;
@@ -751,6 +780,7 @@ void getTriNormals(const rai::Mesh& m, arr& Tn) {
 
 /// flips all faces
 void rai::Mesh::flipFaces() {
+  changed();
   uint i, a;
   for(i=0; i<T.d0; i++) {
     a=T(i, 0);
@@ -761,6 +791,7 @@ void rai::Mesh::flipFaces() {
 
 /// check whether this is really a closed mesh, and flip inconsistent faces
 void rai::Mesh::clean() {
+  changed();
   uint i, j, idist=0;
   Vector a, b, c, m;
   double mdist=0.;
@@ -968,6 +999,7 @@ void getTriNeighborsList(const rai::Mesh& m, uintA& Tt, intA& TT) {
 }
 
 void rai::Mesh::skin(uint start) {
+  changed();
   intA TT;
   uintA Tt;
   getTriNeighborsList(*this, Tt, TT);
@@ -1146,6 +1178,7 @@ void rai::Mesh::writeTriFile(const char* filename) {
 }
 
 void rai::Mesh::readTriFile(std::istream& is) {
+  changed();
   uint i, nV, nT;
   is >>PARSE("TRI") >>nV >>nT;
   V.resize(nV, 3);
@@ -1164,6 +1197,7 @@ void rai::Mesh::writeOffFile(const char* filename) {
 }
 
 void rai::Mesh::readOffFile(std::istream& is) {
+  changed();
   uint i, k, nVertices, nFaces, nEdges, alpha;
   bool color;
   rai::String tag;
@@ -1188,6 +1222,7 @@ void rai::Mesh::readOffFile(std::istream& is) {
 }
 
 void rai::Mesh::readPlyFile(std::istream& is) {
+  changed();
   uint i, k, nVertices, nFaces;
   rai::String str;
   is >>PARSE("ply") >>PARSE("format") >>str;
@@ -1281,6 +1316,7 @@ bool ply_check_property(PlyElement* elem, const char* prop_name) {
 }
 
 void rai::Mesh::readPLY(const char* fn) {
+  changed();
   struct PlyFace {    unsigned char nverts;  int* verts; };
   struct Vertex {    double x,  y,  z ;  byte r, g, b; };
   uint _nverts=0, _ntrigs=0;
@@ -1386,6 +1422,7 @@ void rai::Mesh::writeArr(std::ostream& os) {
 }
 
 void rai::Mesh::readArr(std::istream& is) {
+  changed();
   V.readTagged(is, "V");
   T.readTagged(is, "T");
   C.readTagged(is, "C");
@@ -1930,6 +1967,7 @@ void rai::Mesh::setImplicitSurfaceBySphereProjection(ScalarFunction f, double ra
 }
 
 void rai::Mesh::buildGraph() {
+  graph.clear();
   graph.resize(V.d0);
   for(uint i=0; i<T.d0; i++) {
     graph(T(i, 0)).setAppend(T(i, 1));
@@ -1946,6 +1984,22 @@ inline double __scalarProduct(const double* p1, const double* p2) {
 }
 
 uint rai::Mesh::support(const double* dir) {
+  if(isConvex() && graph.N==V.d0) {
+    //hill-climbing on the graph, starting from the last support vertex (on a convex mesh, a local maximum is global);
+    //meshes are shared by concurrent queries: graph is only read, and the start vertex is just a (relaxed atomic) hint
+    uint mi = __atomic_load_n(&_support_vertex, __ATOMIC_RELAXED);
+    if(mi>=V.d0) mi=0;
+    double ms = __scalarProduct(dir, V.p+3*mi);
+    for(bool improved=true; improved;) {
+      improved=false;
+      for(uint i:graph.p[mi]) {
+        double s = __scalarProduct(dir, V.p+3*i);
+        if(s>ms) { mi=i; ms=s; improved=true; }
+      }
+    }
+    __atomic_store_n(&_support_vertex, mi, __ATOMIC_RELAXED);
+    return mi;
+  }
 #if 1
 
   arr _dir(dir, 3, true);
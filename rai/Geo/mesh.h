@@ -22,6 +22,8 @@ struct ANN;
 
 namespace rai {
 
+struct MeshBVH;
+
 enum ShapeType { ST_none=-1, ST_box=0, ST_sphere, ST_capsule, ST_mesh, ST_cylinder, ST_marker, ST_pointCloud, ST_ssCvx, ST_ssBox, ST_ssCylinder, ST_ssBoxElip, ST_quad, ST_camera, ST_sdf };
 
 //===========================================================================
@@ -41,6 +43,9 @@ struct Mesh : GLDrawer {
 
   uintAA graph;         ///< for every vertex, the set of neighboring vertices
   shared_ptr<ANN> ann;
+  shared_ptr<MeshBVH> _bvh; ///< AABB tree over T (built by bvh() on first use)
+  uint64_t version=0;       ///< unique stamp of the geometry, renewed by all mutators (call changed() after editing V or T directly)
+  uint64_t convexVersion=0; ///< the version made convex by makeConvexHull (which also builds the graph)
 
   rai::Transformation glX; ///< transform (only used for drawing! Otherwise use applyOnPoints)  (optional)
 
@@ -50,6 +55,8 @@ struct Mesh : GLDrawer {
   uint _support_vertex=0;
 
   Mesh();
+  void changed(bool keepsConvexity=false); ///< renews the version (after V or T changed)
+  bool isConvex() const { return convexVersion==version; } ///< support() may then hill-climb on the graph
 
   /// @name set or create
   void clear();
@@ -93,6 +100,13 @@ struct Mesh : GLDrawer {
   uint support(const double* dir);
   void supportMargin(uintA& verts, const arr& dir, double margin, int initialization=-1);
 
+  /// @name queries using the AABB tree (see MeshBVH)
+  shared_ptr<MeshBVH> bvh(); ///< the tree of the current version (hold the pointer while using it: a changed mesh replaces it)
+  double closestPoint(arr& p, uint& tri, const arr& x, int* region=0); ///< distance of x to the surface; closest point p on triangle tri
+  double signedDistance(const arr& x); ///< negative inside (needs a closed and consistently oriented mesh)
+  bool rayCast(double& t, uint& tri, const arr& origin, const arr& dir, double tMax=-1.); ///< first hit origin+t*dir (t<=tMax, if >0) on triangle tri
+  bool overlaps(Mesh& other, const Transformation& rel, uintA* pair=0); ///< does a triangle intersect one of other's (with other's points at rel*x)?
+
   /// @name internal computations & cleanup
   void computeNormals();
   arr computeTriDistances();
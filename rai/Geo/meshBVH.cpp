@@ -0,0 +1,335 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "meshBVH.h"
+#include "../Core/util.h"
+
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <mutex>
+#include <math.h>
+
+namespace {
+
+/// plain 3-vectors for the inner loops
+struct V3 {
+  double x, y, z;
+  V3() {}
+  V3(double x, double y, double z) : x(x), y(y), z(z) {}
+  V3(const double* p) : x(p[0]), y(p[1]), z(p[2]) {}
+  V3 operator+(const V3& b) const { return V3(x+b.x, y+b.y, z+b.z); }
+  V3 operator-(const V3& b) const { return V3(x-b.x, y-b.y, z-b.z); }
+  V3 operator*(double s) const { return V3(s*x, s*y, s*z); }
+  double operator[](uint i) const { return (&x)[i]; }
+};
+inline double dot(const V3& a, const V3& b) { return a.x*b.x+a.y*b.y+a.z*b.z; }
+inline V3 cross(const V3& a, const V3& b) { return V3(a.y*b.z-a.z*b.y, a.z*b.x-a.x*b.z, a.x*b.y-a.y*b.x); }
+inline V3 normalized(const V3& a) { double l=sqrt(dot(a, a)); return l>0. ? a*(1./l) : a; }
+
+inline V3 corner(const rai::Mesh& m, uint t, uint k) { return V3(m.V.p+3*m.T.p[3*t+k]); }
+
+/// closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5); region: 0 face, 1-3 vertex a,b,c, 4-6 edge ab,bc,ca
+V3 closestOnTriangle(const V3& p, const V3& a, const V3& b, const V3& c, int& region) {
+  V3 ab=b-a, ac=c-a, ap=p-a;
+  double d1=dot(ab, ap), d2=dot(ac, ap);
+  if(d1<=0. && d2<=0.) { region=1; return a; }
+  V3 bp=p-b;
+  double d3=dot(ab, bp), d4=dot(ac, bp);
+  if(d3>=0. && d4<=d3) { region=2; return b; }
+  double vc=d1*d4-d3*d2;
+  if(vc<=0. && d1>=0. && d3<=0.) { region=4; return a+ab*(d1/(d1-d3)); }
+  V3 cp=p-c;
+  double d5=dot(ab, cp), d6=dot(ac, cp);
+  if(d6>=0. && d5<=d6) { region=3; return c; }
+  double vb=d5*d2-d1*d6;
+  if(vb<=0. && d2>=0. && d6<=0.) { region=6; return a+ac*(d2/(d2-d6)); }
+  double va=d3*d6-d5*d4;
+  if(va<=0. && (d4-d3)>=0. && (d5-d6)>=0.) { region=5; return b+(c-b)*((d4-d3)/((d4-d3)+(d5-d6))); }
+  double denom=1./(va+vb+vc);
+  region=0;
+  return a+ab*(vb*denom)+ac*(vc*denom);
+}
+
+/// squared distance of p to the box
+inline double boxSqrDistance(const rai::MeshBVH::Node& n, const V3& p) {
+  double d=0.;
+  for(uint i=0; i<3; i++) {
+    if(p[i]<n.lo[i]) d+=rai::sqr(n.lo[i]-p[i]);
+    else if(p[i]>n.hi[i]) d+=rai::sqr(p[i]-n.hi[i]);
+  }
+  return d;
+}
+
+/// squared distance of q to the mesh m with tree B; closest point best on triangle tri in region
+double bvhClosestPoint(V3& best, uint& tri, int& region, const rai::Mesh& m, const rai::MeshBVH& B, const V3& q) {
+  double bestD=INFINITY;
+  region=0;
+  tri=UINT_MAX;
+  uint stack[128];
+  uint s=0;
+  stack[s++]=0;
+  while(s) {
+    const rai::MeshBVH::Node& n = B.nodes[stack[--s]];
+    if(boxSqrDistance(n, q)>=bestD) continue;
+    if(n.child<0) {
+      for(uint l=n.begin; l<n.end; l++) {
+        uint t=B.tris.p[l];
+        int r;
+        V3 c = closestOnTriangle(q, corner(m, t, 0), corner(m, t, 1), corner(m, t, 2), r);
+        double d = dot(q-c, q-c);
+        if(d<bestD) { bestD=d; best=c; tri=t; region=r; }
+      }
+    } else { //push the farther child first
+      const rai::MeshBVH::Node &a=B.nodes[n.child], &b=B.nodes[n.child+1];
+      CHECK_LE(s+2, 128, "BVH too deep");
+      if(boxSqrDistance(a, q)<boxSqrDistance(b, q)) { stack[s++]=n.child+1; stack[s++]=n.child; }
+      else { stack[s++]=n.child; stack[s++]=n.child+1; }
+    }
+  }
+  return bestD;
+}
+
+/// entry parameter of the ray o+t*d into the box (slab test), or INFINITY if it misses within [0, tMax]
+inline double boxRayEntry(const rai::MeshBVH::Node& n, const V3& o, const V3& dInv, double tMax) {
+  double t0=0., t1=tMax;
+  for(uint i=0; i<3; i++) {
+    if(std::isinf(dInv[i])) { //parallel to the slab (0*inf would be NaN): inside or a miss
+      if(o[i]<n.lo[i] || o[i]>n.hi[i]) return INFINITY;
+      continue;
+    }
+    double a=(n.lo[i]-o[i])*dInv[i], b=(n.hi[i]-o[i])*dInv[i];
+    if(a>b) std::swap(a, b);
+    if(a>t0) t0=a;
+    if(b<t1) t1=b;
+    if(t0>t1) return INFINITY;
+  }
+  return t0;
+}
+
+/// ray-triangle intersection (Moeller-Trumbore), returns the ray parameter or INFINITY
+inline double rayTriangle(const V3& o, const V3& d, const V3& a, const V3& b, const V3& c) {
+  V3 e1=b-a, e2=c-a, h=cross(d, e2);
+  double det=dot(e1, h);
+  if(fabs(det)<1e-15) return INFINITY;
+  double f=1./det;
+  V3 s=o-a;
+  double u=f*dot(s, h);
+  if(u<0. || u>1.) return INFINITY;
+  V3 q=cross(s, e1);
+  double v=f*dot(d, q);
+  if(v<0. || u+v>1.) return INFINITY;
+  double t=f*dot(e2, q);
+  return t>=0. ? t : INFINITY;
+}
+
+/// triangle-triangle overlap by the separating axis theorem (face normals, edge-edge crosses, and in-plane edge normals for coplanar cases)
+bool triTriOverlap(const V3* A, const V3* B) {
+  auto separated = [&](const V3& axis) {
+    if(dot(axis, axis)<1e-20) return false;
+    double a0=dot(axis, A[0]), a1=dot(axis, A[1]), a2=dot(axis, A[2]);
+    double b0=dot(axis, B[0]), b1=dot(axis, B[1]), b2=dot(axis, B[2]);
+    return std::max({a0, a1, a2})<std::min({b0, b1, b2}) || std::max({b0, b1, b2})<std::min({a0, a1, a2});
+  };
+  V3 nA=cross(A[1]-A[0], A[2]-A[0]), nB=cross(B[1]-B[0], B[2]-B[0]);
+  if(separated(nA) || separated(nB)) return false;
+  for(uint i=0; i<3; i++) for(uint j=0; j<3; j++) {
+      if(separated(cross(A[(i+1)%3]-A[i], B[(j+1)%3]-B[j]))) return false;
+    }
+  for(uint i=0; i<3; i++) {
+    if(separated(cross(nA, A[(i+1)%3]-A[i]))) return false;
+    if(separated(cross(nB, B[(i+1)%3]-B[i]))) return false;
+  }
+  return true;
+}
+
+}
+
+//===========================================================================
+
+rai::MeshBVH::MeshBVH(const Mesh& m) : nV(m.V.d0), nT(m.T.d0), version(m.version) {
+  CHECK(m.T.N, "the BVH needs triangles");
+  arr centers(nT, 3);
+  for(uint t=0; t<nT; t++) {
+    V3 c = (corner(m, t, 0)+corner(m, t, 1)+corner(m, t, 2))*(1./3.);
+    centers(t, 0)=c.x;  centers(t, 1)=c.y;  centers(t, 2)=c.z;
+  }
+  tris.setStraightPerm(nT);
+  nodes.reserve(2*nT/leafSize+1);
+  nodes.emplace_back();
+  build(m.V, m.T, centers, 0, 0, nT);
+
+  //pseudo normals (Baerentzen & Aanaes): angle-weighted at vertices, summed at edges
+  vertexNormals.resize(nV, 3).setZero();
+  edgeNormals.resize(nT, 3, 3).setZero();
+  std::map<std::pair<uint, uint>, std::pair<uint, uint>> edges; //(tri, k) of the first triangle with this edge
+  for(uint t=0; t<nT; t++) {
+    V3 a=corner(m, t, 0), b=corner(m, t, 1), c=corner(m, t, 2);
+    V3 n=normalized(cross(b-a, c-a));
+    V3 P[3]= {a, b, c};
+    for(uint k=0; k<3; k++) {
+      V3 e1=normalized(P[(k+1)%3]-P[k]), e2=normalized(P[(k+2)%3]-P[k]);
+      double angle=acos(rai::MAX(-1., rai::MIN(1., dot(e1, e2))));
+      double* vn=vertexNormals.p+3*m.T.p[3*t+k];
+      vn[0]+=angle*n.x;  vn[1]+=angle*n.y;  vn[2]+=angle*n.z;
+
+      uint i=m.T.p[3*t+k], j=m.T.p[3*t+(k+1)%3];
+      double* en=edgeNormals.p+9*t+3*k;
+      en[0]+=n.x;  en[1]+=n.y;  en[2]+=n.z;
+      std::pair<uint, uint> key(rai::MIN(i, j), rai::MAX(i, j));
+      auto it=edges.find(key);
+      if(it==edges.end()) {
+        edges[key]= {t, k};
+      } else {
+        double* en2=edgeNormals.p+9*it->second.first+3*it->second.second;
+        for(uint l=0; l<3; l++) { double s=en[l]+en2[l]; en[l]=en2[l]=s; }
+      }
+    }
+  }
+}
+
+void rai::MeshBVH::build(const arr& V, const uintA& T, const arr& centers, uint node, uint begin, uint end) {
+  Node& n = nodes[node];
+  n.begin=begin;  n.end=end;
+  for(uint i=0; i<3; i++) { n.lo[i]=INFINITY;  n.hi[i]=-INFINITY; }
+  for(uint l=begin; l<end; l++) for(uint k=0; k<3; k++) {
+      const double* v=V.p+3*T.p[3*tris.p[l]+k];
+      for(uint i=0; i<3; i++) { if(v[i]<n.lo[i]) n.lo[i]=v[i];  if(v[i]>n.hi[i]) n.hi[i]=v[i]; }
+    }
+  if(end-begin<=leafSize) return;
+
+  //split at the median center along the longest box axis
+  uint axis=0;
+  for(uint i=1; i<3; i++) if(n.hi[i]-n.lo[i]>n.hi[axis]-n.lo[axis]) axis=i;
+  uint mid=(begin+end)/2;
+  const double* c=centers.p+axis;
+  std::nth_element(tris.p+begin, tris.p+mid, tris.p+end, [c](uint a, uint b) { return c[3*a]<c[3*b]; });
+
+  int child=nodes.size();
+  nodes[node].child=child; //n may be invalidated by emplace_back
+  nodes.emplace_back();
+  nodes.emplace_back();
+  build(V, T, centers, child, begin, mid);
+  build(V, T, centers, child+1, mid, end);
+}
+
+//===========================================================================
+
+shared_ptr<rai::MeshBVH> rai::Mesh::bvh() {
+  //meshes are shared by concurrent queries: build the tree at most once (per version)
+  static std::mutex buildMutex;
+  shared_ptr<MeshBVH> B = std::atomic_load(&_bvh);
+  if(B && B->isValid(*this)) return B;
+  std::lock_guard<std::mutex> lock(buildMutex);
+  B = std::atomic_load(&_bvh);
+  if(!B || !B->isValid(*this)) {
+    B = make_shared<MeshBVH>(*this);
+    std::atomic_store(&_bvh, B);
+  }
+  return B;
+}
+
+double rai::Mesh::closestPoint(arr& p, uint& tri, const arr& x, int* region) {
+  CHECK_EQ(x.N, 3, "");
+  shared_ptr<MeshBVH> B = bvh();
+  V3 best(0., 0., 0.);
+  int r;
+  double d = bvhClosestPoint(best, tri, r, *this, *B, V3(x.p));
+  if(!!p) { p.resize(3); p(0)=best.x; p(1)=best.y; p(2)=best.z; }
+  if(region) *region=r;
+  return sqrt(d);
+}
+
+double rai::Mesh::signedDistance(const arr& x) {
+  CHECK_EQ(x.N, 3, "");
+  shared_ptr<MeshBVH> B = bvh();
+  V3 q(x.p), p(0., 0., 0.);
+  uint t;
+  int region;
+  double d = sqrt(bvhClosestPoint(p, t, region, *this, *B, q));
+  V3 n;
+  if(region==0) n = cross(corner(*this, t, 1)-corner(*this, t, 0), corner(*this, t, 2)-corner(*this, t, 0));
+  else if(region<=3) n = V3(B->vertexNormals.p+3*T.p[3*t+region-1]);
+  else n = V3(B->edgeNormals.p+9*t+3*(region-4));
+  if(dot(q-p, n)<0.) d=-d;
+  return d;
+}
+
+bool rai::Mesh::rayCast(double& t, uint& tri, const arr& origin, const arr& dir, double tMax) {
+  CHECK_EQ(origin.N, 3, "");
+  CHECK_EQ(dir.N, 3, "");
+  CHECK(dir.p[0] || dir.p[1] || dir.p[2], "zero ray direction");
+  shared_ptr<MeshBVH> B = bvh();
+  V3 o(origin.p), d(dir.p);
+  V3 dInv(1./d.x, 1./d.y, 1./d.z);
+  t = (tMax>0. ? tMax : INFINITY);
+  tri = UINT_MAX;
+  uint stack[128];
+  uint s=0;
+  stack[s++]=0;
+  while(s) {
+    const MeshBVH::Node& n = B->nodes[stack[--s]];
+    if(boxRayEntry(n, o, dInv, t)==INFINITY) continue;
+    if(n.child<0) {
+      for(uint l=n.begin; l<n.end; l++) {
+        uint k=B->tris.p[l];
+        double tk = rayTriangle(o, d, corner(*this, k, 0), corner(*this, k, 1), corner(*this, k, 2));
+        if(tk<t) { t=tk; tri=k; }
+      }
+    } else { //push the farther child first
+      CHECK_LE(s+2, 128, "BVH too deep");
+      double ta=boxRayEntry(B->nodes[n.child], o, dInv, t), tb=boxRayEntry(B->nodes[n.child+1], o, dInv, t);
+      if(ta<tb) { stack[s++]=n.child+1; stack[s++]=n.child; }
+      else { stack[s++]=n.child; stack[s++]=n.child+1; }
+    }
+  }
+  return tri!=UINT_MAX;
+}
+
+bool rai::Mesh::overlaps(Mesh& other, const Transformation& rel, uintA* pair) {
+  shared_ptr<MeshBVH> A = bvh(), B = other.bvh();
+  arr R = rel.rot.getArr();
+  V3 p(&rel.pos.x);
+  auto transform = [&](const V3& v) { return V3(R.p[0]*v.x+R.p[1]*v.y+R.p[2]*v.z+p.x, R.p[3]*v.x+R.p[4]*v.y+R.p[5]*v.z+p.y, R.p[6]*v.x+R.p[7]*v.y+R.p[8]*v.z+p.z); };
+  //does box a (in this mesh's frame) overlap box b (in other's frame)? -- conservatively, via the AABB of the transformed b
+  auto boxesOverlap = [&](const MeshBVH::Node& a, const MeshBVH::Node& b) {
+    V3 c = transform(V3(.5*(b.lo[0]+b.hi[0]), .5*(b.lo[1]+b.hi[1]), .5*(b.lo[2]+b.hi[2])));
+    V3 h(.5*(b.hi[0]-b.lo[0]), .5*(b.hi[1]-b.lo[1]), .5*(b.hi[2]-b.lo[2]));
+    for(uint i=0; i<3; i++) {
+      double e = fabs(R.p[3*i])*h.x + fabs(R.p[3*i+1])*h.y + fabs(R.p[3*i+2])*h.z;
+      if(c[i]+e<a.lo[i] || c[i]-e>a.hi[i]) return false;
+    }
+    return true;
+  };
+
+  std::vector<std::pair<uint, uint>> stack = {{0, 0}};
+  while(stack.size()) {
+    uint i=stack.back().first, j=stack.back().second;
+    stack.pop_back();
+    const MeshBVH::Node &a=A->nodes[i], &b=B->nodes[j];
+    if(!boxesOverlap(a, b)) continue;
+    if(a.child<0 && b.child<0) {
+      for(uint l=a.begin; l<a.end; l++) for(uint m=b.begin; m<b.end; m++) {
+          uint ta=A->tris.p[l], tb=B->tris.p[m];
+          V3 TA[3]= {corner(*this, ta, 0), corner(*this, ta, 1), corner(*this, ta, 2)};
+          V3 TB[3]= {transform(corner(other, tb, 0)), transform(corner(other, tb, 1)), transform(corner(other, tb, 2))};
+          if(triTriOverlap(TA, TB)) {
+            if(pair) *pair = {ta, tb};
+            return true;
+          }
+        }
+    } else if(b.child<0 || (a.child>=0 && a.end-a.begin>b.end-b.begin)) { //descend into the larger node
+      stack.push_back({a.child, j});
+      stack.push_back({a.child+1, j});
+    } else {
+      stack.push_back({i, b.child});
+      stack.push_back({i, b.child+1});
+    }
+  }
+  return false;
+}
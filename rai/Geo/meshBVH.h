@@ -0,0 +1,42 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "mesh.h"
+
+namespace rai {
+
+//===========================================================================
+
+/** An AABB tree over the triangles of a mesh (in mesh coordinates), built by Mesh::bvh() on first use. It backs the
+ *  Mesh queries closestPoint, signedDistance, rayCast and overlaps, which descend only into boxes that can still
+ *  improve the result -- O(log T) per query for well-shaped meshes. The tree does not point to the mesh; it only
+ *  stores triangle indices and is rebuilt when the mesh version changes (after modifying V in place, call Mesh::changed()). */
+struct MeshBVH {
+  enum { leafSize=4 };
+  struct Node {
+    double lo[3], hi[3];
+    uint begin, end; ///< the range of tris below this node
+    int child=-1;    ///< index of the first child (the second is child+1), -1 for leaves
+  };
+  std::vector<Node> nodes; ///< nodes(0) is the root
+  uintA tris;              ///< triangle indices, ordered such that every node covers a range
+  arr vertexNormals;       ///< angle-weighted pseudo normals of the vertices (V.d0, 3), for the sign of distances
+  arr edgeNormals;         ///< pseudo normals (sum of both face normals) of the edges (T.d0, 3, 3): edge k joins corners k, k+1
+  uint nV=0, nT=0;         ///< sizes of the mesh it was built for
+  uint64_t version=0;      ///< version of the mesh it was built for
+
+  MeshBVH(const Mesh& m);
+  bool isValid(const Mesh& m) const { return version==m.version && nV==m.V.d0 && nT==m.T.d0; }
+
+ private:
+  void build(const arr& V, const uintA& T, const arr& centers, uint node, uint begin, uint end);
+};
+
+}
@@ -30,7 +30,7 @@ extern "C" {
 #  define FCLmode
 #endif
 
-PairCollision::PairCollision(rai::Mesh& _mesh1, rai::Mesh& _mesh2, const rai::Transformation& _t1, const rai::Transformation& _t2, double rad1, double rad2)
+PairCollision::PairCollision(rai::Mesh& _mesh1, rai::Mesh& _mesh2, const rai::Transformation& _t1, const rai::Transformation& _t2, double rad1, double rad2, PairCollisionCache* cache)
   : mesh1(&_mesh1), mesh2(&_mesh2), t1(&_t1), t2(&_t2), rad1(rad1), rad2(rad2) {
 
   distance=-1.;
@@ -67,7 +67,7 @@ PairCollision::PairCollision(rai::Mesh& _mesh1, rai::Mesh& _mesh2, const rai::Tr
 
   libccd(M1, M2, _ccdGJKIntersect);
 #else
-  GJK_sqrDistance();
+  GJK_sqrDistance(cache);
 #endif
 
   CHECK_EQ(distance, distance, "distance is nan");
@@ -107,6 +107,8 @@ PairCollision::PairCollision(rai::Mesh& _mesh1, rai::Mesh& _mesh2, const rai::Tr
 
   CHECK_GE(rai::sign(distance) * scalarProduct(normal, p1-p2), -1e-10, "");
 
+  if(cache) cache->store(*this);
+
   //in current state, the rad1, rad2, have not been used at all!!
 }
 
@@ -434,7 +436,35 @@ void PairCollision::libccd(rai::Mesh& m1, rai::Mesh& m2, CCDmethod method) {
 }
 #endif
 
-void PairCollision::GJK_sqrDistance() {
+//===========================================================================
+
+/// a conservative lower bound of the distance (neglecting radii) at the new poses: since the last query, no vertex
+/// moved farther than |dpos| + 2 sin(dangle/2) vertexRadius, and the distance of the hulls is 1-Lipschitz in such motions
+double PairCollisionCache::distanceLowerBound(const rai::Mesh& m1, const rai::Mesh& m2, const rai::Transformation& _t1, const rai::Transformation& _t2) const {
+  if(!isValid(m1, m2)) return -std::numeric_limits<double>::infinity();
+  auto motion = [](const rai::Transformation& from, const rai::Transformation& to, double vertexRadius) {
+    rai::Quaternion dq = to.rot / from.rot;
+    return (to.pos-from.pos).length() + 2.*::sqrt(dq.x*dq.x + dq.y*dq.y + dq.z*dq.z)*vertexRadius;
+  };
+  return distance - motion(t1, _t1, vertexRadius1) - motion(t2, _t2, vertexRadius2);
+}
+
+void PairCollisionCache::store(const PairCollision& coll) {
+  if(mesh1!=coll.mesh1 || version1!=coll.mesh1->version || nV1!=coll.mesh1->V.d0) {
+    mesh1=coll.mesh1; version1=mesh1->version; nV1=mesh1->V.d0; vertexRadius1=mesh1->getRadius();
+  }
+  if(mesh2!=coll.mesh2 || version2!=coll.mesh2->version || nV2!=coll.mesh2->V.d0) {
+    mesh2=coll.mesh2; version2=mesh2->version; nV2=mesh2->V.d0; vertexRadius2=mesh2->getRadius();
+  }
+  t1 = *coll.t1;
+  t2 = *coll.t2;
+  distance = coll.distance;
+  queries++;
+}
+
+//===========================================================================
+
+void PairCollision::GJK_sqrDistance(PairCollisionCache* cache) {
 #ifdef RAI_GJK
   // convert meshes to 'Object_structures'
   Object_structure m1, m2;
@@ -449,11 +479,18 @@ void PairCollision::GJK_sqrDistance() {
   if(!!t1) {  T1=t1->getAffineMatrix();  Thelp1 = getCarray(T1);  }
   if(!!t2) {  T2=t2->getAffineMatrix();  Thelp2 = getCarray(T2);  }
 
-  // call GJK
+  // call GJK, warm started from the last simplex of this pair
   simplex_point simplex;
+  int useSeed=0;
+  if(cache && cache->simplex && cache->isValid(*mesh1, *mesh2)) {
+    simplex = *cache->simplex;
+    useSeed = 1;
+    cache->warmStarts++;
+  }
   p1.resize(3).setZero();
   p2.resize(3).setZero();
-  gjk_distance(&m1, Thelp1.p, &m2, Thelp2.p, p1.p, p2.p, &simplex, 0);
+  gjk_distance(&m1, Thelp1.p, &m2, Thelp2.p, p1.p, p2.p, &simplex, useSeed);
+  if(cache) cache->simplex = make_shared<simplex_point>(simplex);
 
   normal = p1-p2;
   distance = length(normal);
@@ -10,6 +10,25 @@
 
 #include "mesh.h"
 
+/// state of a shape pair that persists across queries with small motions (e.g., across Newton iterations):
+/// the last GJK simplex to warm start from, and the last distance and poses to bound the distance after a motion
+struct PairCollisionCache {
+  std::shared_ptr<struct simplex_point> simplex; ///< GJK witness simplex of the last query (vertex indices; replaced, never modified)
+  const rai::Mesh *mesh1=0, *mesh2=0;  ///< meshes of the last query
+  uint64_t version1=0, version2=0;     ///< their versions (the simplex is only valid for unchanged meshes, see Mesh::version)
+  uint nV1=0, nV2=0;                   ///< their vertex counts
+  double vertexRadius1=0., vertexRadius2=0.; ///< max vertex distance from the mesh origins
+  rai::Transformation t1=0, t2=0;      ///< poses of the last query
+  double distance=-1.;                 ///< distance (neglecting radii) of the last query
+  uint queries=0, warmStarts=0;
+
+  bool isValid(const rai::Mesh& m1, const rai::Mesh& m2) const { return queries && mesh1==&m1 && mesh2==&m2 && version1==m1.version && version2==m2.version && nV1==m1.V.d0 && nV2==m2.V.d0; }
+  double distanceLowerBound(const rai::Mesh& m1, const rai::Mesh& m2, const rai::Transformation& _t1, const rai::Transformation& _t2) const;
+  void store(const struct PairCollision& coll);
+};
+
+//===========================================================================
+
 struct PairCollision : GLDrawer, NonCopyable {
   //INPUTS
   const rai::Mesh* mesh1=0;
@@ -31,7 +50,7 @@ struct PairCollision : GLDrawer, NonCopyable {
 
   PairCollision(rai::Mesh& mesh1, rai::Mesh& mesh2,
                 const rai::Transformation& t1, const rai::Transformation& t2,
-                double rad1=0., double rad2=0.);
+                double rad1=0., double rad2=0., PairCollisionCache* cache=nullptr);
   PairCollision(ScalarFunction func1, ScalarFunction func2, const arr& seed);
   ~PairCollision() {}
 
@@ -67,7 +86,7 @@ struct PairCollision : GLDrawer, NonCopyable {
   //wrappers of external libs
   enum CCDmethod { _ccdGJKIntersect,  _ccdGJKSeparate, _ccdGJKPenetration, _ccdMPRIntersect, _ccdMPRPenetration };
   void libccd(rai::Mesh& m1, rai::Mesh& m2, CCDmethod method); //calls ccdMPRPenetration of libccd
-  void GJK_sqrDistance(); //gjk_distance of libGJK
+  void GJK_sqrDistance(PairCollisionCache* cache=nullptr); //gjk_distance of libGJK (warm started from the cache's simplex)
   bool simplexType(uint i, uint j) { return simplex1.d0==i && simplex2.d0==j; } //helper
 };
 
@@ -1,5 +1,7 @@
 #include "signedDistanceFunctions.h"
+#include "mesh.h"
 
+#include "../Core/thread.h"
 #include "../Gui/opengl.h"
 #include "../Optim/newton.h"
 
@@ -94,6 +96,29 @@ double SDF_Sphere::f(arr& g, arr& H, const arr& x) {
 
 //===========================================================================
 
+SDF_Mesh::SDF_Mesh(const rai::Transformation& _pose, const std::shared_ptr<rai::Mesh>& _mesh)
+  : pose(_pose), mesh(_mesh), bvh(mesh->bvh()) {
+}
+
+double SDF_Mesh::f(arr& g, arr& H, const arr& x) {
+  arr rot = pose.rot.getArr();
+  arr x_rel = (~rot)*(x-conv_vec2arr(pose.pos)); //point in mesh coordinates
+  double d = mesh->signedDistance(x_rel);
+  if(!!g || !!H) {
+    arr closest;
+    uint tri;
+    mesh->closestPoint(closest, tri, x_rel);
+    arr del = x_rel-closest;
+    double eps=1e-10;
+    if(d<0.) del *= -1.;
+    if(!!g) g = rot*del/(fabs(d)+eps);
+    if(!!H) H.resize(3, 3).setZero(); //piecewise: zero on faces (the curvature at edges and vertices is neglected)
+  }
+  return d;
+}
+
+//===========================================================================
+
 //double DistanceFunction_InfCylinder::fs(arr& g, arr& H, const arr& x){
 //  z = z / length(z);
 //  arr a = (x-c) - scalarProduct((x-c), z) * z;
@@ -318,13 +343,43 @@ double interpolate3D(double v000, double v100, double v010, double v110, double
   return interpolate1D(s, t, z);
 }
 
-SDF_GridData::SDF_GridData(SDF& f, const arr& _lo, const arr& _up, const uintA& res)
+/// clips the relative point x_rel into the box [lo+eps, up-eps] (flagging the clipped dimensions); returns the distance of
+/// x to that box (with its gradient and Hessian), or 0 if x_rel is inside
+static double clipToGrid(arr& x_rel, boolA& clipped, arr& gBox, arr& HBox,
+                         const rai::Transformation& pose, const arr& lo, const arr& up, const arr& x) {
+  clipped = {false, false, false};
+  double eps=.001;
+  if(boundCheck(x_rel, lo+eps, up-eps, 0., false)) return 0.;
+  //clip -- and memorize which are clipped!
+  for(uint i=0; i<3; i++) {
+    if(x_rel(i)<lo.elem(i)+eps){ x_rel.elem(i) = lo.elem(i)+eps; clipped.elem(i)=true; }
+    if(x_rel(i)>up.elem(i)-eps){ x_rel.elem(i) = up.elem(i)-eps; clipped.elem(i)=true; }
+  }
+  arr size = up - lo - 2.*eps;
+  arr center = .5*(up+lo);
+  rai::Transformation boxPose=pose;
+  boxPose.addRelativeTranslation(center);
+  SDF_ssBox B(boxPose, size);
+  double fBox = B.f(gBox, HBox, x);
+  CHECK(fBox>=0., "");
+  return fBox;
+}
+
+SDF_GridData::SDF_GridData(SDF& f, const arr& _lo, const arr& _up, const uintA& res, uint threads)
   : lo(_lo), up(_up) {
-  //compute grid data
+  //compute grid data, in slices along x
   arr samples = ::grid(lo, up, res);
-  arr values = f.eval(samples);
-  copy(gridData, values);
-  gridData.reshape({res(0)+1, res(1)+1, res(2)+1});
+  gridData.resize(res(0)+1, res(1)+1, res(2)+1);
+  uint n = gridData.d1*gridData.d2;
+  if(!threads) threads = std::thread::hardware_concurrency();
+  WorkerPool pool(threads);
+  pool.run(gridData.d0, [&](uint i, uint) {
+    arr x;
+    for(uint j=i*n; j<(i+1)*n; j++) {
+      x.referToDim(samples, j);
+      gridData.p[j] = f.f(NoArr, NoArr, x);
+    }
+  });
 }
 
 double SDF_GridData::f(arr& g, arr& H, const arr& x){
@@ -332,24 +387,8 @@ double SDF_GridData::f(arr& g, arr& H, const arr& x){
   arr x_rel = (~rot)*(x-conv_vec2arr(pose.pos)); //point in box coordinates
 
   arr gBox, HBox;
-  boolA clipped = {false, false, false};
-  double fBox=0.;
-  double eps=.001;
-  if(!boundCheck(x_rel, lo+eps, up-eps, 0., false)){ //check outside box
-//    boundClip(x_rel, lo+eps, up-eps);
-    //clip -- and memorize which are clipped!
-    for(uint i=0; i<3; i++) {
-      if(x_rel(i)<lo.elem(i)+eps){ x_rel.elem(i) = lo.elem(i)+eps; clipped.elem(i)=true; }
-      if(x_rel(i)>up.elem(i)-eps){ x_rel.elem(i) = up.elem(i)-eps; clipped.elem(i)=true; }
-    }
-    arr size = up - lo - 2.*eps;
-    arr center = .5*(up+lo);
-    rai::Transformation boxPose=pose;
-    boxPose.addRelativeTranslation(center);
-    SDF_ssBox B(boxPose, size);
-    fBox = B.f(gBox, HBox, x);
-    CHECK(fBox>=0., "");
-  }
+  boolA clipped;
+  double fBox = clipToGrid(x_rel, clipped, gBox, HBox, pose, lo, up, x);
 
   arr res = arr{(double)gridData.d0-1, (double)gridData.d1-1, (double)gridData.d2-1};
   res /= (up-lo);
@@ -427,6 +466,186 @@ void SDF_GridData::read(std::istream& is){
 
 //===========================================================================
 
+/// interpolation weights w (and derivatives dw, ddw) of the 2 (linear) or 4 (Catmull-Rom, from -1) vertices around fraction t
+static void interpolationWeights(double* w, double* dw, double* ddw, double t, bool cubic) {
+  if(!cubic) {
+    w[0]=1.-t;  w[1]=t;
+    dw[0]=-1.;  dw[1]=1.;
+    ddw[0]=ddw[1]=0.;
+    return;
+  }
+  double t2=t*t, t3=t2*t;
+  w[0]=.5*(-t3+2.*t2-t);       dw[0]=.5*(-3.*t2+4.*t-1.);   ddw[0]=.5*(-6.*t+4.);
+  w[1]=.5*(3.*t3-5.*t2+2.);    dw[1]=.5*(9.*t2-10.*t);      ddw[1]=.5*(18.*t-10.);
+  w[2]=.5*(-3.*t3+4.*t2+t);    dw[2]=.5*(-9.*t2+8.*t+1.);   ddw[2]=.5*(-18.*t+8.);
+  w[3]=.5*(t3-t2);             dw[3]=.5*(3.*t2-2.*t);       ddw[3]=.5*(6.*t-2.);
+}
+
+SDF_SparseGrid::SDF_SparseGrid(SDF& f, const arr& _lo, const arr& _up, const uintA& _res, double _band, uint threads)
+  : lo(_lo), up(_up), res(_res), band(_band) {
+  build(f, threads);
+}
+
+SDF_SparseGrid::SDF_SparseGrid(const std::shared_ptr<rai::Mesh>& mesh, double voxelSize, double _band, double margin, uint threads)
+  : band(_band) {
+  if(margin<0.) margin = 2.*band;
+  arr box = mesh->getBox();
+  lo = box[0] - margin;
+  up = box[1] + margin;
+  res.resize(3);
+  for(uint i=0; i<3; i++) {
+    res(i) = ceil((up(i)-lo(i))/voxelSize);
+    up(i) = lo(i) + voxelSize*res(i);
+  }
+  SDF_Mesh sdf(0, mesh);
+  build(sdf, threads);
+}
+
+void SDF_SparseGrid::build(SDF& f, uint threads) {
+  CHECK_EQ(res.N, 3, "");
+  nBricks.resize(3);
+  for(uint i=0; i<3; i++) nBricks(i) = (res(i)+brickSize)/brickSize; //ceil((res+1)/brickSize)
+  arr h = (up-lo)/rai::convert<double>(res);
+  if(!threads) threads = std::thread::hardware_concurrency();
+  WorkerPool pool(threads);
+
+  //coarse grid on the brick corners
+  uint c1=nBricks(1)+1, c2=nBricks(2)+1;
+  coarse.resize(nBricks(0)+1, c1, c2);
+  pool.run(coarse.N, [&](uint i, uint) {
+    arr x = lo + brickSize*h%arr{double(i/(c1*c2)), double((i/c2)%c1), double(i%c2)};
+    coarse.p[i] = f.f(NoArr, NoArr, x);
+  });
+
+  //bricks within the band: if f is a distance, no vertex of a brick further than halfDiag from its center is within band
+  double halfDiag = .5*brickSize*length(h);
+  uint b1=nBricks(1), b2=nBricks(2);
+  brickIndex.resize(nBricks(0), b1, b2);
+  pool.run(brickIndex.N, [&](uint i, uint) {
+    arr x = lo + brickSize*h%(arr{double(i/(b1*b2)), double((i/b2)%b1), double(i%b2)}+.5);
+    brickIndex.p[i] = (fabs(f.f(NoArr, NoArr, x))<=band+halfDiag) ? 0 : -1;
+  });
+  uint n=0;
+  for(int& b:brickIndex) if(b>=0) b=n++;
+
+  //sample the allocated bricks
+  uint B=brickSize, B3=B*B*B;
+  bricks.resize(n, B3);
+  pool.run(brickIndex.N, [&](uint i, uint) {
+    int b=brickIndex.p[i];
+    if(b<0) return;
+    uint i0=B*(i/(b1*b2)), j0=B*((i/b2)%b1), k0=B*(i%b2);
+    arr x(3);
+    for(uint l=0; l<B3; l++) {
+      x = lo + h%arr{double(i0+l/(B*B)), double(j0+(l/B)%B), double(k0+l%B)};
+      bricks.p[b*B3+l] = f.f(NoArr, NoArr, x);
+    }
+  });
+}
+
+float SDF_SparseGrid::getVertex(int i, int j, int k) const {
+  if(i<0) i=0; else if(i>(int)res(0)) i=res(0);
+  if(j<0) j=0; else if(j>(int)res(1)) j=res(1);
+  if(k<0) k=0; else if(k>(int)res(2)) k=res(2);
+  int B=brickSize, bi=i/B, bj=j/B, bk=k/B;
+  int b = brickIndex(bi, bj, bk);
+  if(b>=0) return bricks(b, ((i%B)*B + j%B)*B + k%B);
+  return interpolate3D(coarse(bi, bj, bk), coarse(bi+1, bj, bk), coarse(bi, bj+1, bk), coarse(bi+1, bj+1, bk),
+                       coarse(bi, bj, bk+1), coarse(bi+1, bj, bk+1), coarse(bi, bj+1, bk+1), coarse(bi+1, bj+1, bk+1),
+                       double(i%B)/B, double(j%B)/B, double(k%B)/B);
+}
+
+double SDF_SparseGrid::f(arr& g, arr& H, const arr& x) {
+  arr rot = pose.rot.getArr();
+  arr x_rel = (~rot)*(x-conv_vec2arr(pose.pos)); //point in grid coordinates
+
+  arr gBox, HBox;
+  boolA clipped;
+  double fBox = clipToGrid(x_rel, clipped, gBox, HBox, pose, lo, up, x);
+
+  //cell and fraction, and the weights of the neighboring vertices per dimension
+  arr scale = rai::convert<double>(res)/(up-lo);
+  int idx[3], n=cubic?4:2, offset=cubic?-1:0;
+  double w[3][4], dw[3][4], ddw[3][4];
+  for(uint i=0; i<3; i++) {
+    double t = (x_rel(i)-lo(i))*scale(i);
+    idx[i] = floor(t);
+    if(idx[i]>(int)res(i)-1) idx[i]=res(i)-1;
+    t -= idx[i];
+    interpolationWeights(w[i], dw[i], ddw[i], t, cubic);
+    if(clipped(i)) for(int a=0; a<n; a++) dw[i][a]=ddw[i][a]=0.;
+  }
+
+  double f=0.;
+  double G[3]={0., 0., 0.}, HH[3][3]={{0., 0., 0.}, {0., 0., 0.}, {0., 0., 0.}};
+  for(int a=0; a<n; a++) for(int b=0; b<n; b++) for(int c=0; c<n; c++) {
+        double v = getVertex(idx[0]+offset+a, idx[1]+offset+b, idx[2]+offset+c);
+        f += w[0][a]*w[1][b]*w[2][c]*v;
+        if(!!g) {
+          G[0] += dw[0][a]*w[1][b]*w[2][c]*v;
+          G[1] += w[0][a]*dw[1][b]*w[2][c]*v;
+          G[2] += w[0][a]*w[1][b]*dw[2][c]*v;
+        }
+        if(!!H && cubic) {
+          HH[0][0] += ddw[0][a]*w[1][b]*w[2][c]*v;
+          HH[1][1] += w[0][a]*ddw[1][b]*w[2][c]*v;
+          HH[2][2] += w[0][a]*w[1][b]*ddw[2][c]*v;
+          HH[0][1] += dw[0][a]*dw[1][b]*w[2][c]*v;
+          HH[0][2] += dw[0][a]*w[1][b]*dw[2][c]*v;
+          HH[1][2] += w[0][a]*dw[1][b]*dw[2][c]*v;
+        }
+      }
+
+  if(!!g) {
+    g.resize(3);
+    for(uint i=0; i<3; i++) g(i) = G[i]*scale(i);
+    g = rot*g;
+  }
+  if(!!H) {
+    H.resize(3, 3);
+    for(uint i=0; i<3; i++) for(uint j=i; j<3; j++) H(i, j) = H(j, i) = HH[i][j]*scale(i)*scale(j);
+    H = rot*H*~rot;
+  }
+
+  if(fBox) {
+    f += fBox;
+    if(!!g) g += gBox;
+    if(!!H) H += HBox;
+  }
+
+  return f;
+}
+
+uint SDF_SparseGrid::getMemory() const {
+  return (coarse.N+bricks.N)*sizeof(float) + brickIndex.N*sizeof(int);
+}
+
+void SDF_SparseGrid::write(std::ostream& os) const {
+  lo.writeTagged(os, "lo");
+  up.writeTagged(os, "up");
+  res.writeTagged(os, "res");
+  arr{band, (double)cubic}.writeTagged(os, "band_cubic");
+  coarse.writeTagged(os, "coarse", true);
+  brickIndex.writeTagged(os, "brickIndex", true);
+  bricks.writeTagged(os, "bricks", true);
+}
+
+void SDF_SparseGrid::read(std::istream& is) {
+  lo.readTagged(is, "lo");
+  up.readTagged(is, "up");
+  res.readTagged(is, "res");
+  arr bc;
+  bc.readTagged(is, "band_cubic");
+  band=bc(0);
+  cubic=bc(1);
+  coarse.readTagged(is, "coarse");
+  brickIndex.readTagged(is, "brickIndex");
+  bricks.readTagged(is, "bricks");
+  nBricks = {brickIndex.d0, brickIndex.d1, brickIndex.d2};
+}
+
+//===========================================================================
+
 double SDF_SuperQuadric::f(arr& g, arr& H, const arr& x) {
   double fx=0;
   if(!!g) g.resize(3).setZero();
@@ -2,6 +2,8 @@
 
 #include "geo.h"
 
+namespace rai { struct Mesh; struct MeshBVH; }
+
 //===========================================================================
 //
 // analytic distance functions
@@ -68,6 +70,15 @@ struct SDF_Capsule : SDF {
   double f(arr& g, arr& H, const arr& x);
 };
 
+/// signed distance to a closed triangle mesh (in pose coordinates), using its AABB tree; e.g., SDF_GridData(SDF_Mesh(..), lo, up, res)
+struct SDF_Mesh : SDF {
+  rai::Transformation pose;
+  std::shared_ptr<rai::Mesh> mesh;
+  std::shared_ptr<rai::MeshBVH> bvh; ///< the tree of mesh, built (and held) on construction, so that f can be called from several threads
+  SDF_Mesh(const rai::Transformation& _pose, const std::shared_ptr<rai::Mesh>& _mesh);
+  double f(arr& g, arr& H, const arr& x);
+};
+
 struct SDF_Blobby : SDF {
   double f(arr& g, arr& H, const arr& _x){
     double x=_x(0), y=_x(1), z=_x(2);
@@ -86,7 +97,7 @@ struct SDF_GridData : SDF {
   SDF_GridData(const rai::Transformation& _pose, const floatA& _data, const arr& _lo, const arr& _up)
     : pose(_pose), gridData(_data), lo(_lo), up(_up) {}
 
-  SDF_GridData(SDF& f, const arr& _lo, const arr& _up, const uintA& res);
+  SDF_GridData(SDF& f, const arr& _lo, const arr& _up, const uintA& res, uint threads=0); ///< samples f (which must be thread-safe) with threads (0: all cores)
   SDF_GridData() {}
   SDF_GridData(istream& is) { read(is); }
 
@@ -97,6 +108,40 @@ struct SDF_GridData : SDF {
 };
 stdPipes(SDF_GridData)
 
+/** A narrow-band SDF on the grid of res+1 vertices per dimension between lo and up (in pose coordinates), like SDF_GridData,
+ *  but stored in bricks of brickSize^3 vertices: only bricks within band of the surface are sampled and allocated (which
+ *  assumes f to be a distance, i.e. 1-Lipschitz); elsewhere the vertex values are interpolated from a coarse grid on the
+ *  brick corners. f() interpolates trilinearly, or with Catmull-Rom splines (cubic), which gives continuous gradients and
+ *  non-zero Hessians. */
+struct SDF_SparseGrid : SDF {
+  enum { brickSize=8 };
+  rai::Transformation pose=0;
+  arr lo, up;
+  uintA res;          ///< cells per dimension
+  double band=0.;
+  bool cubic=false;
+  uintA nBricks;      ///< bricks per dimension
+  floatA coarse;      ///< values at the brick corners, (nBricks+1) per dimension
+  intA brickIndex;    ///< for each brick its index in bricks, or -1
+  floatA bricks;      ///< the allocated bricks, (n, brickSize^3)
+
+  SDF_SparseGrid(SDF& f, const arr& _lo, const arr& _up, const uintA& _res, double _band, uint threads=0);
+  SDF_SparseGrid(const std::shared_ptr<rai::Mesh>& mesh, double voxelSize, double _band, double margin=-1., uint threads=0); ///< of a closed mesh (box around it with margin, default 2*band)
+  SDF_SparseGrid() {}
+  SDF_SparseGrid(istream& is) { read(is); }
+
+  double f(arr& g, arr& H, const arr& x);
+  float getVertex(int i, int j, int k) const; ///< value at grid vertex ijk (clipped to the grid)
+  uint getMemory() const; ///< bytes of the grid data
+
+  void write(std::ostream& os) const;
+  void read(std::istream& is);
+
+ private:
+  void build(SDF& f, uint threads);
+};
+stdPipes(SDF_SparseGrid)
+
 //===========================================================================
 
 extern ScalarFunction DistanceFunction_SSBox;
@@ -35,6 +35,7 @@
 #include "../Optim/opt-ceres.h"
 
 #include "../Core/util.ipp"
+#include "../Core/thread.h"
 
 #include "pathTools.h"
 
@@ -138,6 +139,7 @@ void KOMO::clone(const KOMO& komo, bool deepCopyFeatures){
   //directly copy pathConfig instead of recreating it (including switches)
   pathConfig.copy(komo.pathConfig, false);
   timeSlices = pathConfig.getFrames(framesToIndices(komo.timeSlices));
+  clearSliceCaches();
 
   //copy running objectives
   for(const shared_ptr<Objective>& o:komo.objectives){
@@ -155,6 +157,14 @@ void KOMO::clone(const KOMO& komo, bool deepCopyFeatures){
   }
 }
 
+void KOMO::unshareCollisionEngines() {
+  if(!computeCollisions) return;
+  world.swiftDelete();
+  world.fclDelete();
+  if(swift) swift = world.swift();
+  if(fcl) fcl = world.fcl();
+}
+
 void KOMO::addTimeOptimization() {
   world.addTauJoint();
   rai::Frame *timeF = world.frames.first();
@@ -651,8 +661,8 @@ void KOMO::initOrg(){
   }
 }
 
-void KOMO::initRandom(int verbose){
-  pathConfig.setRandom(timeSlices.d1, verbose); //opt.verbose);
+void KOMO::initRandom(int verbose, rai::RndStream* stream){
+  pathConfig.setRandom(timeSlices.d1, verbose, stream); //opt.verbose);
   x = pathConfig.getJointState();
 }
 
@@ -1043,7 +1053,7 @@ void KOMO::run_prepare(double addInitializationNoise) {
 }
 
 void KOMO::run(OptOptions options) {
-  Configuration::setJointStateCount=0;
+  pathConfig.setJointStateCount=0;
   if(opt.verbose>0) {
     cout <<"** KOMO::run solver:"
         <<rai::Enum<KOMOsolver>(solver)
@@ -1111,12 +1121,115 @@ void KOMO::run(OptOptions options) {
   if(opt.verbose>0) {
     cout <<"** optimization time:" <<timeTotal
          <<" (kin:" <<timeKinematics <<" coll:" <<timeCollisions <<" feat:" <<timeFeatures <<" newton: " <<timeNewton <<")"
-         <<" setJointStateCount:" <<Configuration::setJointStateCount
+         <<" setJointStateCount:" <<pathConfig.setJointStateCount
         <<"\n   sos:" <<sos <<" ineq:" <<ineq <<" eq:" <<eq <<endl;
   }
   if(opt.verbose>1) cout <<getReport(opt.verbose>2) <<endl;
 }
 
+/** Runs the solver from several initializations concurrently. The problem is set up (pathConfig, grounded objectives)
+ *  only once; each of the threads (default: number of cores) solves its share of restarts on its own clone of this KOMO.
+ *  Restart 0 starts at the current x, all others at x plus Gaussian noise of sdv initNoise (drawn in advance, so the
+ *  result does not depend on scheduling). With pruneDominated, a restart of the Conv_KOMO_NLP-based solvers stops after
+ *  its second outer iteration as soon as it is worse in both costs and constraint violation (by more than 1) than a
+ *  finished restart. Returns all restarts, feasible ones (eq+ineq<1) first by costs, then by violation; x is set to the best. */
+rai::Array<KOMO_Restart> KOMO::optimizeRestarts(uint restarts, double initNoise, uint threads, bool pruneDominated, const rai::OptOptions options) {
+  CHECK(restarts>0, "");
+  double time = -rai::realTime();
+  run_prepare(0.);
+
+  //-- initializations
+  arr lo, up;
+  getBounds(lo, up);
+  arrA x0(restarts);
+  rai::RndStream noise(rnd.num());
+  for(uint i=0; i<restarts; i++) {
+    x0(i) = x;
+    if(i && initNoise>0.) rndGauss(x0(i), noise, initNoise, true);
+    boundClip(x0(i), lo, up);
+  }
+
+  //-- one clone per thread; lazy state is computed before cloning
+  if(!threads) threads = std::thread::hardware_concurrency();
+  threads = rai::MIN(threads, restarts);
+  pathConfig.ensure_q();
+  for(rai::Frame* f:pathConfig.frames) f->ensure_X();
+  rai::Array<shared_ptr<KOMO>> clones(threads);
+  for(shared_ptr<KOMO>& c:clones) {
+    c = make_shared<KOMO>();
+    c->clone(*this);
+    c->solver = solver;
+    c->unshareCollisionEngines();
+    c->opt.verbose = 0;
+    c->opt.parallelFeatures = c->opt.parallelCollisions = 0; //parallel across restarts instead
+  }
+
+  rai::Array<KOMO_Restart> R(restarts);
+  double bestCosts=0., bestViolation=-1.; //of finished (unpruned) restarts; bestViolation<0: none yet
+  Mutex mutex;
+  rai::OptOptions restartOptions = options;
+  restartOptions.verbose = 0;
+  WorkerPool pool(threads);
+  pool.run(restarts, [&](uint i, uint worker) {
+    KOMO& c = *clones(worker);
+    KOMO_Restart& r = R(i);
+    r.id = i;
+    r.time = -rai::realTime();
+    c.x = x0(i);
+    c.dual.clear();
+    if(solver==rai::KS_dense || solver==rai::KS_sparse || solver==rai::KS_sparseFactored) {
+      Conv_KOMO_NLP P(c, solver!=rai::KS_dense);
+      OptConstrained O(c.x, c.dual, P.ptr(), restartOptions);
+      int its=0;
+      while(!O.ministep()) {
+        if(!pruneDominated || O.its==its || O.its<2) continue;
+        its = O.its;
+        double costs = O.L.get_costs(), violation = O.L.get_sumOfGviolations() + O.L.get_sumOfHviolations();
+        auto lock = mutex(RAI_HERE);
+        if(bestViolation>=0. && costs>bestCosts && violation>bestViolation+1.) { r.pruned=true; break; }
+      }
+    } else {
+      c.run(restartOptions);
+    }
+    { arr phi; Conv_KOMO_NLP(c, false).evaluate(phi, NoArr, c.x); } //sos, eq, ineq of the final x
+    r.x = c.x;
+    r.dual = c.dual;
+    r.sos = c.sos;  r.eq = c.eq;  r.ineq = c.ineq;
+    r.time += rai::realTime();
+    if(!r.pruned) {
+      auto lock = mutex(RAI_HERE);
+      double violation = r.eq + r.ineq;
+      if(bestViolation<0. || violation<bestViolation || (violation==bestViolation && r.sos<bestCosts)) {
+        bestCosts = r.sos;
+        bestViolation = violation;
+      }
+    }
+  });
+
+  //-- rank: feasible first (by costs), then by violation
+  uintA rank;
+  rank.setStraightPerm(restarts);
+  std::sort(rank.p, rank.p+rank.N, [&R](uint i, uint j) {
+    const KOMO_Restart& a = R(i), &b = R(j);
+    bool fa = a.eq+a.ineq<1., fb = b.eq+b.ineq<1.;
+    if(fa!=fb) return fa;
+    if(fa) return a.sos<b.sos;
+    return a.eq+a.ineq<b.eq+b.ineq;
+  });
+  R = R.sub(rank);
+
+  x = R(0).x;
+  dual = R(0).dual;
+  { arr phi; Conv_KOMO_NLP(*this, false).evaluate(phi, NoArr, x); }
+  time += rai::realTime();
+  timeTotal += time;
+  if(opt.verbose>0) {
+    cout <<"** KOMO::optimizeRestarts restarts:" <<restarts <<" threads:" <<threads <<" time:" <<time
+         <<"\n   best: restart " <<R(0).id <<" sos:" <<R(0).sos <<" ineq:" <<R(0).ineq <<" eq:" <<R(0).eq <<endl;
+  }
+  return R;
+}
+
 void KOMO::reportProblem(std::ostream& os) {
   os <<"KOMO Problem:" <<endl;
   os <<"  x-dim:" <<x.N <<"  dual-dim:" <<dual.N <<endl;
@@ -1303,6 +1416,7 @@ void KOMO::addStableFrame(const char* name, const char* parent, JointType jointT
     pathConfig.frames = timeSlices;
     uint i=0;
     for(Frame* f: pathConfig.frames) f->ID = i++;
+    pathConfig.reset_frameNameIndex();
   }
 }
 
@@ -1410,6 +1524,7 @@ void KOMO::setupPathConfig() {
 
   }
   timeSlices = pathConfig.frames;
+  clearSliceCaches();
 
   //deactivate prefix dofs
   pathConfig.calc_indexedActiveJoints();
@@ -1459,36 +1574,150 @@ void KOMO::set_x(const arr& x, const uintA& selectedConfigurationsOnly) {
 
   timeKinematics -= rai::cpuTime();
 
-  if(!selectedConfigurationsOnly.N){
+  if(selectedConfigurationsOnly.N){
+    pathConfig.setJointState(x, timeSlices.sub(selectedConfigurationsOnly+k_order));
+  }else if(opt.sparseUpdates){
+    //set only the dofs that changed, so that forward kinematics is recomputed only in their branches
+    const arr& q = pathConfig.getJointState();
+    CHECK_EQ(x.N, q.N, "wrong joint state dimensionalities");
+    DofL dofs;
+    arr qChanged(x.N);
+    uint n=0;
+    for(Dof* d:pathConfig.activeDofs) if(!d->mimic){
+      bool changed=false;
+      for(uint i=0; i<d->dim; i++) if(x.p[d->qIndex+i]!=q.p[d->qIndex+i]){ changed=true; break; }
+      if(changed){
+        dofs.append(d);
+        for(uint i=0; i<d->dim; i++) qChanged.p[n++] = x.p[d->qIndex+i];
+      }
+    }
+    if(n==x.N) pathConfig.setJointState(x); //all changed
+    else if(n) pathConfig.setDofState(qChanged.resizeCopy(n), dofs);
+  }else{
     pathConfig.setJointState(x);
+  }
+
+  stateRevision++;
+  if(opt.sparseUpdates){
+    updateSliceRevisions();
   }else{
-    pathConfig.setJointState(x, timeSlices.sub(selectedConfigurationsOnly+k_order));
-    HALT("this is untested...");
+    sliceRevision.resize(timeSlices.d0) = stateRevision;
   }
 
   timeKinematics += rai::cpuTime();
 
   if(computeCollisions) {
-    timeCollisions -= rai::cpuTime();
+    bool parallel = opt.useFCL && opt.parallelCollisions>1;
+    if(parallel) timeCollisions -= rai::realTime(); //cpuTime sums over all threads
+    else timeCollisions -= rai::cpuTime();
+
+    //-- query the engine only for slices that changed since their pairs were computed
+    if(sliceCollisionPairs.N!=timeSlices.d0){
+      sliceCollisionPairs.clear().resize(timeSlices.d0);
+      sliceCollisionRevision.resize(timeSlices.d0).setZero();
+    }
+    uintA changed;
+    for(uint s=k_order;s<timeSlices.d0;s++) if(sliceCollisionRevision(s)<sliceRevision(s)) changed.append(s);
+    if(!opt.useFCL){
+      arr X;
+      for(uint s:changed){
+        X = pathConfig.getFrameState(timeSlices[s]);
+        sliceCollisionPairs(s) = swift->step(X);
+      }
+    }else if(changed.N){
+      if(parallel && (!collisionPool || collisionPool->nWorkers()!=(uint)opt.parallelCollisions)) {
+        collisionPool = make_shared<WorkerPool>(opt.parallelCollisions);
+      }
+      fcl->pool = (parallel ? collisionPool : nullptr);
+      //all slices in one batch, so that the narrowphase of all slices is one (parallel) pass
+      arrA X(changed.N);
+      for(uint i=0;i<changed.N;i++) X(i) = pathConfig.getFrameState(timeSlices[changed(i)]);
+      uintAA collisionPairs;
+      fcl->step(collisionPairs, X);
+      for(uint i=0;i<changed.N;i++) sliceCollisionPairs(changed(i)) = collisionPairs(i);
+    }
+    for(uint s:changed) sliceCollisionRevision(s) = stateRevision;
+
     pathConfig.proxies.clear();
-    arr X;
-    uintA collisionPairs;
     for(uint s=k_order;s<timeSlices.d0;s++){
-      X = pathConfig.getFrameState(timeSlices[s]);
-      if(!opt.useFCL){
-        collisionPairs = swift->step(X);
-      }else{
-        fcl->step(X);
-        collisionPairs = fcl->collisions;
-      }
-      collisionPairs += timeSlices.d1 * s; //fcl returns frame IDs related to 'world' -> map them into frameIDs within that time slice
+      uintA collisionPairs = sliceCollisionPairs(s) + timeSlices.d1 * s; //engines return frame IDs related to 'world' -> map them into frameIDs within that time slice
       pathConfig.addProxies(collisionPairs);
     }
     pathConfig._state_proxies_isGood=true;
-    timeCollisions += rai::cpuTime();
+    if(parallel) timeCollisions += rai::realTime();
+    else timeCollisions += rai::cpuTime();
   }
 }
 
+/// copies v into z; returns whether they differed
+static bool updateState(double* z, const double* v, uint n) {
+  bool changed=false;
+  for(uint i=0; i<n; i++) if(z[i]!=v[i]) { z[i]=v[i]; changed=true; }
+  return changed;
+}
+
+void KOMO::updateSliceRevisions() {
+  //the state of a slice: the poses of its frames and its dofs (which includes taus and forces, which do not move frames)
+  //the slice of a dof is that of its frame, or of the closest parent in a slice (frames added by switches), or none (-1)
+  const arr& q = pathConfig.getJointState();
+  intA dofSlice(pathConfig.activeDofs.N);
+  uintA n(timeSlices.d0);
+  n = 7*timeSlices.d1;
+  uint nGlobal=0;
+  for(uint i=0; i<dofSlice.N; i++) {
+    Dof* d=pathConfig.activeDofs.elem(i);
+    dofSlice.elem(i)=-1;
+    if(d->mimic || !d->dim) continue;
+    Frame* f=d->frame;
+    while(f && !(f->ID<timeSlices.N && timeSlices.elem(f->ID)==f)) f=f->parent;
+    if(f) { dofSlice.elem(i)=f->ID/timeSlices.d1; n(dofSlice.elem(i)) += d->dim; }
+    else nGlobal += d->dim;
+  }
+
+  boolA changed(timeSlices.d0);
+  changed = false;
+  if(sliceState.N!=timeSlices.d0) sliceState.clear().resize(timeSlices.d0);
+  for(uint s=0; s<timeSlices.d0; s++) if(sliceState(s).N!=n(s)) { sliceState(s).resize(n(s)).setZero(); changed(s)=true; }
+  bool all=false;
+  if(globalState.N!=nGlobal) { globalState.resize(nGlobal).setZero(); all=true; }
+
+  //compare (and update) the frame poses...
+  Frame** f = timeSlices.p;
+  for(uint s=0; s<timeSlices.d0; s++) {
+    double* z = sliceState(s).p;
+    for(uint i=0; i<timeSlices.d1; i++, f++, z+=7) {
+      const Transformation& X = (*f)->ensure_X();
+      if(updateState(z, &X.pos.x, 3) | updateState(z+3, &X.rot.w, 4)) changed.p[s]=true;
+    }
+  }
+  //...and the dofs
+  uintA cursor(timeSlices.d0);
+  cursor = 7*timeSlices.d1;
+  uint cursorGlobal=0;
+  for(uint i=0; i<dofSlice.N; i++) {
+    Dof* d=pathConfig.activeDofs.elem(i);
+    int s=dofSlice.elem(i);
+    if(s>=0) {
+      if(updateState(sliceState(s).p+cursor(s), q.p+d->qIndex, d->dim)) changed(s)=true;
+      cursor(s) += d->dim;
+    } else if(!d->mimic && d->dim) {
+      if(updateState(globalState.p+cursorGlobal, q.p+d->qIndex, d->dim)) all=true;
+      cursorGlobal += d->dim;
+    }
+  }
+
+  sliceRevision.resize(timeSlices.d0);
+  for(uint s=0; s<timeSlices.d0; s++) if(all || changed(s)) sliceRevision(s) = stateRevision;
+}
+
+void KOMO::clearSliceCaches() {
+  sliceRevision.clear();
+  sliceState.clear();
+  globalState.clear();
+  sliceCollisionPairs.clear();
+  sliceCollisionRevision.clear();
+}
+
 shared_ptr<NLP> KOMO::nlp_SparseNonFactored(){
   return make_shared<Conv_KOMO_NLP>(*this, solver==rai::KS_sparse);
 }
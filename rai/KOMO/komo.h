@@ -19,6 +19,8 @@
 
 //===========================================================================
 
+struct WorkerPool;
+
 namespace rai {
   struct FclInterface;
   enum KOMOsolver { KS_none=-1, KS_dense=0, KS_sparse, KS_banded, KS_sparseFactored, KS_NLopt, KS_Ipopt, KS_Ceres };
@@ -34,9 +36,21 @@ namespace rai {
     RAI_PARAM("KOMO/", bool, mimicStable, true)
     RAI_PARAM("KOMO/", bool, useFCL, true)
     RAI_PARAM("KOMO/", bool, unscaleEqIneqReport, false)
+    RAI_PARAM("KOMO/", int, parallelFeatures, 0) //number of threads to evaluate grounded objectives (<=1: serial); timeFeatures then reports wall time
+    RAI_PARAM("KOMO/", int, parallelCollisions, 0) //number of threads for the fcl narrowphase of all time slices (<=1: serial); timeCollisions then reports wall time
+    RAI_PARAM("KOMO/", bool, sparseUpdates, true) //set_x recomputes kinematics, collisions and (in Conv_KOMO_NLP) features only for time slices whose state changed
   };
 }//namespace
 
+/// one local optimum found by KOMO::optimizeRestarts
+struct KOMO_Restart {
+  uint id;                  ///< index of the restart (0: initialized with the current x, without noise)
+  arr x, dual;
+  double sos, eq, ineq;     ///< costs and constraint violations of x (as KOMO::sos etc.)
+  double time;              ///< wall time of this restart
+  bool pruned=false;        ///< terminated early, as it was clearly dominated by a finished restart
+};
+
 struct KOMO : NonCopyable {
 
   //-- the problem definition
@@ -56,6 +70,14 @@ struct KOMO : NonCopyable {
   bool computeCollisions;         ///< whether swift or fcl (collisions/proxies) is evaluated whenever new configurations are set (needed if features read proxy list)
   shared_ptr<rai::FclInterface> fcl;
   shared_ptr<SwiftInterface> swift;
+  shared_ptr<WorkerPool> featurePool; ///< workers for parallel feature evaluation (created on demand, see opt.parallelFeatures)
+  shared_ptr<WorkerPool> collisionPool; ///< workers for parallel collision queries (created on demand, see opt.parallelCollisions)
+  uint stateRevision=0;           ///< counts the calls of set_x
+  uintA sliceRevision;            ///< for each time slice, the stateRevision of the last set_x that changed its state (frame poses and dofs)
+  arrA sliceState;                ///< the state of each time slice at the last set_x (see updateSliceRevisions)
+  arr globalState;                ///< the dofs that set_x could not attribute to a time slice
+  uintAA sliceCollisionPairs;     ///< collision pairs of each time slice (frame IDs relative to the slice), reused while the slice is unchanged
+  uintA sliceCollisionRevision;   ///< the stateRevision at which sliceCollisionPairs were computed
 
   //-- optimizer
   rai::KOMOsolver solver=rai::KS_sparse;
@@ -82,6 +104,7 @@ struct KOMO : NonCopyable {
   void setTiming(double _phases=1., uint _stepsPerPhase=30, double durationPerPhase=5., uint _k_order=2);
 
   void clone(const KOMO& komo, bool deepCopyFeatures=true);
+  void unshareCollisionEngines(); ///< replace the swift/fcl engines (shared with the model or a clone origin) by own ones, so that this KOMO can run concurrently with others
 
   //-- higher-level default setups
   void setIKOpt(); ///< setTiming(1., 1, 1., 1); and velocity objective
@@ -151,7 +174,7 @@ public:
   void setConfiguration_qOrg(int t, const arr& q); ///< set only those DOFs that were defined in the original world (excluding extra DOFs from switches)
   void setConfiguration_X(int t, const arr& X); ///< t<0 allows to set the prefix configurations; while 0 <= t < T allows to set all other initial configurations
   void initOrg();
-  void initRandom(int verbose=0);
+  void initRandom(int verbose=0, rai::RndStream* stream=nullptr); ///< see Configuration::setRandom
   void initWithConstant(const arr& q); ///< set all configurations EXCEPT the prefix to a particular state
   void initWithWaypoints(const arrA& waypoints, uint waypointStepsPerPhase=1, int verbose=-1); ///< set all configurations (EXCEPT prefix) to interpolate given waypoints
   void initWithPath_qOrg(const arr& q);
@@ -170,6 +193,7 @@ public:
   void run_prepare(double addInitializationNoise);   ///< ensure the configurations are setup, decision variable is initialized, and noise added (if >0)
   void run(rai::OptOptions options=NOOPT);          ///< run the solver iterations (configurations and decision variable needs to be setup before)
   void setSpline(uint splineT);      ///< optimize B-spline nodes instead of the path; splineT specifies the time steps per node
+  rai::Array<KOMO_Restart> optimizeRestarts(uint restarts, double initNoise=.1, uint threads=0, bool pruneDominated=true, const rai::OptOptions options=NOOPT); ///< run several restarts concurrently (see komo.cpp); returns all optima ranked, and sets x to the best
 
   //-- reading results
   arr getConfiguration_qAll(int t);  ///< get all DOFs
@@ -214,7 +238,9 @@ public:
   rai::Frame* applySwitch(const rai::KinematicSwitch& sw);
   void retrospectApplySwitches();
   void retrospectChangeJointType(int startStep, int endStep, uint frameID, rai::JointType newJointType);
-  void set_x(const arr& x, const uintA& selectedConfigurationsOnly={});            ///< set the state trajectory of all configurations
+  void set_x(const arr& x, const uintA& selectedConfigurationsOnly={});            ///< set the state trajectory of all configurations (or only of the selected time steps t, then x contains only their dofs)
+  void updateSliceRevisions();    ///< compare each time slice to its sliceState, and update sliceRevision of those that changed
+  void clearSliceCaches();        ///< forget all slice states and collision pairs (e.g., after the pathConfig was re-setup)
 
 
   //===========================================================================
@@ -3,6 +3,10 @@
 #include "../Kin/frame.h"
 #include "../Kin/proxy.h"
 #include "../Kin/forceExchange.h"
+#include "../Core/thread.h"
+#include "../Core/trace.h"
+
+#include <map>
 
 namespace rai{
 
@@ -26,7 +30,48 @@ void reportAfterPhiComputation(KOMO& komo) {
 
 //===========================================================================
 
+/// evaluate all grounded objectives (except those to reuse) concurrently; each result is stored in its own slot Y(i) (with its
+/// own Jacobian buffer), so that the subsequent serial merge in evaluate is exactly the same as for serial evaluation
+void evaluateObjectivesParallel(KOMO& komo, arrA& Y, const boolA& reuse) {
+  uint n = komo.objs.N;
+  CHECK_EQ(Y.N, n, "");
+  if(!komo.featurePool || komo.featurePool->nWorkers()!=(uint)komo.opt.parallelFeatures) {
+    komo.featurePool = make_shared<WorkerPool>(komo.opt.parallelFeatures);
+  }
+
+  //-- all lazy state of the pathConfig needs to be computed before workers read it
+  komo.pathConfig.ensure_q();
+  for(Frame* f:komo.pathConfig.frames) {
+    f->ensure_X();
+    if(f->shape) { f->shape->mesh(); f->shape->sscCore(); }
+  }
+
+  //-- grounded objectives that share the same Feature instance (which may hold evaluation buffers) are evaluated by the same worker in order
+  std::map<Feature*, uint> featureGroup;
+  uintAA groups;
+  for(uint i=0; i<n; i++) {
+    if(reuse(i)) continue;
+    auto it = featureGroup.find(komo.objs.elem(i)->feat.get());
+    if(it==featureGroup.end()) {
+      featureGroup[komo.objs.elem(i)->feat.get()] = groups.N;
+      groups.append(uintA{i});
+    } else {
+      groups(it->second).append(i);
+    }
+  }
+
+  komo.featurePool->run(groups.N, [&komo, &groups, &Y](uint g, uint worker) {
+    for(uint i:groups(g)) {
+      GroundedObjective& ob = *komo.objs.elem(i);
+      arr y = ob.feat->eval(ob.frames);
+      Y(i).takeOver(y);
+      Y(i).jac = std::move(y.jac);
+    }
+  });
+}
+
 void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
+  RAI_TRACE_SCOPE("Conv_KOMO_NLP::evaluate");
   //-- set the trajectory
   komo.set_x(x);
   if(sparse){
@@ -38,7 +83,7 @@ void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
   phi.resize(featureTypes.N);
   if(!!J) {
     if(sparse) {
-      J.sparse().resize(phi.N, x.N, 0);
+      Jassembly.begin(J, phi.N, x.N);
     } else {
       J.resize(phi.N, x.N).setZero();
     }
@@ -46,12 +91,35 @@ void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
 
   komo.sos=komo.ineq=komo.eq=0.;
 
-  komo.timeFeatures -= cpuTime();
+  bool parallel = komo.opt.parallelFeatures>1 && komo.objs.N>1;
+  if(parallel) komo.timeFeatures -= realTime(); //cpuTime sums over all threads
+  else komo.timeFeatures -= cpuTime();
+
+  //-- objectives whose time slices did not change since the last evaluation are reused from the featureCache
+  boolA reuse(komo.objs.N);
+  reuse = false;
+  if(komo.opt.sparseUpdates && featureCache.N==komo.objs.N) {
+    for(uint i=0; i<komo.objs.N; i++) {
+      const arr& y = featureCache(i);
+      reuse(i) = (!J || !y.N || y.jac);
+      for(int t:komo.objs.elem(i)->timeSlices) if(komo.sliceRevision(t+komo.k_order)>featureCacheRevision) { reuse(i)=false; break; }
+    }
+  }
+  featureCache.resize(komo.objs.N);
+  featureCacheRevision = komo.stateRevision;
+
+  if(parallel) evaluateObjectivesParallel(komo, featureCache, reuse);
 
   uint M=0;
-  for(shared_ptr<GroundedObjective>& ob : komo.objs) {
+  for(uint i=0; i<komo.objs.N; i++) {
+      shared_ptr<GroundedObjective>& ob = komo.objs.elem(i);
       //query the task map and check dimensionalities of returns
-      arr y = ob->feat->eval(ob->frames);
+      arr& y = featureCache(i);
+      if(!parallel && !reuse(i)) {
+        arr yi = ob->feat->eval(ob->frames);
+        y.takeOver(yi);
+        y.jac = std::move(yi.jac);
+      }
 //      cout <<"EVAL '" <<ob->name() <<"' phi:" <<y <<endl <<y.J() <<endl<<endl;
       if(!y.N) continue;
       checkNan(y);
@@ -70,8 +138,7 @@ void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
       if(absMax(y)>1e10) RAI_MSG("WARNING y=" <<y);
 
       //write into phi and J
-      arr yJ = y.J_reset();
-      phi.setVectorBlock(y, M);
+      phi.setVectorBlock(y.noJ(), M);
 
       double scale=1.;
       if(komo.opt.unscaleEqIneqReport && ob->feat->scale.N) scale = absMax(ob->feat->scale);
@@ -83,11 +150,9 @@ void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
 
       if(!!J) {
         if(sparse){
-          yJ.sparse().reshape(J.d0, J.d1);
-          yJ.sparse().colShift(M);
-          J += yJ;
+          Jassembly.add(J, *y.jac, M);
         }else{
-          J.setMatrixBlock(yJ, M, 0);
+          J.setMatrixBlock(*y.jac, M, 0);
         }
       }
 
@@ -95,9 +160,11 @@ void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
       M += y.N;
   }
 
-  komo.timeFeatures += cpuTime();
+  if(parallel) komo.timeFeatures += realTime();
+  else komo.timeFeatures += cpuTime();
 
   CHECK_EQ(M, phi.N, "");
+  if(!!J && sparse) Jassembly.end(J);
   komo.featureValues = phi;
   if(!!J) komo.featureJacobians.resize(1).scalar() = J;
 
@@ -375,6 +442,8 @@ arr Conv_KOMO_FactoredNLP::getSingleVariableInitSample(uint var_id){
 
 void Conv_KOMO_FactoredNLP::setSingleVariable(uint var_id, const arr& x) {
   CHECK_EQ(vars(var_id).dim, x.N, "");
+  //an unchanged variable is not set, to not invalidate the forward kinematics of its branch
+  if(komo.opt.sparseUpdates && x==komo.pathConfig.getDofState(vars(var_id).dofs)) return;
   komo.pathConfig.setDofState(x, vars(var_id).dofs);
 }
 
@@ -10,6 +10,9 @@ struct Conv_KOMO_NLP : NLP {
   bool sparse;
 
   arr quadraticPotentialLinear, quadraticPotentialHessian;
+  rai::SparseAssembly Jassembly; ///< reuses the sparse Jacobian's non-zero pattern across evaluations
+  arrA featureCache;             ///< value (with Jacobian) of each grounded objective at the last evaluation, reused while its time slices are unchanged
+  uint featureCacheRevision=0;   ///< the komo.stateRevision of the featureCache
 
   Conv_KOMO_NLP(KOMO& _komo, bool sparse=true);
 
@@ -19,6 +19,23 @@ void SkeletonEntry::write(std::ostream& os) const {
   frames.write(os, " ", nullptr, "()");
 }
 
+uint64_t Skeleton::getHash() const {
+  //FNV-1a over all entries
+  uint64_t h = 14695981039346656037ull;
+  auto add = [&h](const void* p, uint n) {
+    for(const byte* c=(const byte*)p; n--; c++) { h ^= *c; h *= 1099511628211ull; }
+  };
+  for(const SkeletonEntry& s:S) {
+    int sym = s.symbol.x;
+    add(&s.phase0, sizeof(double));
+    add(&s.phase1, sizeof(double));
+    add(&sym, sizeof(int));
+    for(const String& f:s.frames) add(f.p, f.N+1); //incl. the terminating 0 as separator
+    add("|", 1);
+  }
+  return h;
+}
+
 void Skeleton::ensure_komo() {
   if(!komo) {
   }
@@ -21,6 +21,8 @@ struct SkeletonEntry { //-> rename to Mode or something
   StringA frames; //strings referring to things
   SkeletonEntry() {}
   SkeletonEntry(double phase0, double phase1, SkeletonSymbol symbol, StringA frames) : phase0(phase0), phase1(phase1), symbol(symbol), frames(frames) {}
+  bool operator==(const SkeletonEntry& e) const { return phase0==e.phase0 && phase1==e.phase1 && symbol==e.symbol && frames==e.frames; }
+  bool operator!=(const SkeletonEntry& e) const { return !operator==(e); }
   void write(ostream& os) const;
 };
 stdOutPipe(SkeletonEntry)
@@ -54,6 +56,7 @@ struct Skeleton {
   //-- skeleton info
   double getMaxPhase() const;
   intA getSwitches(const Configuration& C) const;
+  uint64_t getHash() const; ///< hash of the entries (phases, symbols, frames, in order) -- equal skeletons define equal problems
 
   //-- get NLP transcriptions
   //keyframes
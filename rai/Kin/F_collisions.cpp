@@ -68,7 +68,7 @@ void F_PairCollision::phi2(arr& y, arr& J, const FrameL& F) {
     coll=make_shared<PairCollision>(*m1, *m2, f1->ensure_X(), f2->ensure_X(), r1, r2);
   }
 #else
-  coll=make_shared<PairCollision>(*m1, *m2, f1->ensure_X(), f2->ensure_X(), r1, r2);
+  coll=make_shared<PairCollision>(*m1, *m2, f1->ensure_X(), f2->ensure_X(), r1, r2, &caches[{f1->ID, f2->ID}]);
 #endif
 
   if(neglectRadii) coll->rad1=coll->rad2=0.;
@@ -122,7 +122,16 @@ void F_AccumulatedCollisions::phi2(arr& y, arr& J, const FrameL& F) {
       //early check: if swift is way out of collision, don't bother computing it precisely
       if(p.d > p.a->shape->radius() + p.b->shape->radius() + .01 + margin) continue;
 
-      if(!p.collision) p.calc_coll();
+      if(!p.collision){
+        if(useCache){
+          //temporal coherence: the pair cannot have come closer than its motion since the last query allows
+          PairCollisionCache& cache = caches[{p.a->ID, p.b->ID}];
+          if(p.distanceLowerBound(cache) > margin){ skipped++; continue; }
+          p.calc_coll(&cache);
+        }else{
+          p.calc_coll();
+        }
+      }
 
       if(p.collision->getDistance()>margin) continue;
 
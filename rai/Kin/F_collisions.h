@@ -9,6 +9,8 @@
 #pragma once
 
 #include "feature.h"
+#include "../Geo/pairCollision.h"
+#include <map>
 
 //===========================================================================
 
@@ -19,6 +21,7 @@ struct F_PairCollision : Feature {
   bool neglectRadii=false;
 
   shared_ptr<struct PairCollision> coll;
+  std::map<std::pair<uint, uint>, PairCollisionCache> caches; ///< per frame pair: warm start for GJK from the previous query
 
   F_PairCollision(Type _type=_negScalar, bool _neglectRadii=false)
     : type(_type), neglectRadii(_neglectRadii) {
@@ -46,6 +49,9 @@ struct F_AccumulatedCollisions : Feature {
   double margin;
   bool selectAll=false;
   bool selectXor=false;
+  bool useCache=true; ///< skip pairs whose distance provably exceeds margin since their last query
+  std::map<std::pair<uint, uint>, PairCollisionCache> caches; ///< per frame pair of the proxies
+  uint skipped=0;     ///< number of pairs skipped thanks to the caches
   F_AccumulatedCollisions(double _margin=.0, bool selAll=false, bool selXor=false) : margin(_margin), selectAll(selAll), selectXor(selXor) {}
   virtual void phi2(arr& y, arr& J, const FrameL& F);
   virtual uint dim_phi2(const FrameL& F){ return 1; }
@@ -0,0 +1,183 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "batchFK.h"
+#include "frame.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+
+namespace {
+
+//===========================================================================
+
+/// a pack of W doubles, processed with one instruction
+struct Pack {
+#if defined(__AVX512F__)
+  enum { W=8 };
+  __m512d v;
+  static Pack load(const double* p) { return {_mm512_loadu_pd(p)}; }
+  static Pack set(double x) { return {_mm512_set1_pd(x)}; }
+  void store(double* p) const { _mm512_storeu_pd(p, v); }
+  Pack operator+(const Pack& b) const { return {_mm512_add_pd(v, b.v)}; }
+  Pack operator-(const Pack& b) const { return {_mm512_sub_pd(v, b.v)}; }
+  Pack operator*(const Pack& b) const { return {_mm512_mul_pd(v, b.v)}; }
+#elif defined(__AVX2__)
+  enum { W=4 };
+  __m256d v;
+  static Pack load(const double* p) { return {_mm256_loadu_pd(p)}; }
+  static Pack set(double x) { return {_mm256_set1_pd(x)}; }
+  void store(double* p) const { _mm256_storeu_pd(p, v); }
+  Pack operator+(const Pack& b) const { return {_mm256_add_pd(v, b.v)}; }
+  Pack operator-(const Pack& b) const { return {_mm256_sub_pd(v, b.v)}; }
+  Pack operator*(const Pack& b) const { return {_mm256_mul_pd(v, b.v)}; }
+#else
+  enum { W=1 };
+  double v;
+  static Pack load(const double* p) { return {*p}; }
+  static Pack set(double x) { return {x}; }
+  void store(double* p) const { *p=v; }
+  Pack operator+(const Pack& b) const { return {v+b.v}; }
+  Pack operator-(const Pack& b) const { return {v-b.v}; }
+  Pack operator*(const Pack& b) const { return {v*b.v}; }
+#endif
+};
+
+/// X = Xparent * Q for all samples, each given as 7 struct-of-arrays rows (pos.xyz, rot.wxyz) of length stride;
+/// if constQ, Q is a single 7D pose used for all samples
+template<bool constQ>
+void composeBatch(double* X, const double* Xparent, const double* Q, uint stride) {
+  auto getQ = [&](uint c, uint n) { return constQ ? Pack::set(Q[c]) : Pack::load(Q+c*stride+n); };
+  Pack two = Pack::set(2.);
+  for(uint n=0; n<stride; n+=Pack::W) {
+    Pack px = Pack::load(Xparent+0*stride+n), py = Pack::load(Xparent+1*stride+n), pz = Pack::load(Xparent+2*stride+n);
+    Pack rw = Pack::load(Xparent+3*stride+n), rx = Pack::load(Xparent+4*stride+n), ry = Pack::load(Xparent+5*stride+n), rz = Pack::load(Xparent+6*stride+n);
+    Pack vx = getQ(0, n), vy = getQ(1, n), vz = getQ(2, n);
+    Pack sw = getQ(3, n), sx = getQ(4, n), sy = getQ(5, n), sz = getQ(6, n);
+
+    //pos = Xparent.pos + Xparent.rot * Q.pos, using t = 2 r x v,  R v = v + w t + r x t
+    Pack tx = two*(ry*vz - rz*vy);
+    Pack ty = two*(rz*vx - rx*vz);
+    Pack tz = two*(rx*vy - ry*vx);
+    (px + vx + rw*tx + (ry*tz - rz*ty)).store(X+0*stride+n);
+    (py + vy + rw*ty + (rz*tx - rx*tz)).store(X+1*stride+n);
+    (pz + vz + rw*tz + (rx*ty - ry*tx)).store(X+2*stride+n);
+
+    //rot = Xparent.rot * Q.rot
+    (rw*sw - rx*sx - ry*sy - rz*sz).store(X+3*stride+n);
+    (rw*sx + rx*sw + ry*sz - rz*sy).store(X+4*stride+n);
+    (rw*sy + ry*sw + rz*sx - rx*sz).store(X+5*stride+n);
+    (rw*sz + rz*sw + rx*sy - ry*sx).store(X+6*stride+n);
+  }
+}
+
+void getPose7(double* x, const rai::Transformation& T) {
+  x[0]=T.pos.x;  x[1]=T.pos.y;  x[2]=T.pos.z;
+  x[3]=T.rot.w;  x[4]=T.rot.x;  x[5]=T.rot.y;  x[6]=T.rot.z;
+}
+
+}
+
+//===========================================================================
+
+rai::BatchFK::BatchFK(Configuration& C, const FrameL& frames) {
+  C.ensure_indexedJoints();
+  qDim = C.getJointStateDimension();
+
+  FrameL order = C.calc_topSort();
+  intA linkOf = consts<int>(-1, C.frames.N);
+  links.resize(order.N);
+  for(uint i=0; i<order.N; i++) {
+    Frame* f = order(i);
+    Link& l = links(i);
+    linkOf(f->ID) = i;
+    l.frame = f;
+    if(!f->parent) {
+      l.Q = f->ensure_X();
+      continue;
+    }
+    l.parent = linkOf(f->parent->ID);
+    CHECK_GE(l.parent, 0, "frames are not topologically sorted");
+    l.Q = f->get_Q();
+    Joint* j = f->joint;
+    if(j && j->active && j->type!=JT_rigid && j->type!=JT_tau) l.joint = (j->mimic ? j->mimic : j);
+  }
+
+  const FrameL& F = (frames.N ? frames : C.frames);
+  output.resize(F.N);
+  for(uint i=0; i<F.N; i++) output(i) = linkOf(F.elem(i)->ID);
+}
+
+void rai::BatchFK::eval(arr& poses, const arr& qBatch) {
+  CHECK_EQ(qBatch.nd, 2, "expected a (N,d)-matrix of joint states");
+  CHECK_EQ(qBatch.d1, qDim, "wrong joint state dimensionality");
+  CHECK(blockSize>0, "");
+  uint N = qBatch.d0;
+  stride = Pack::W*((std::min(N, blockSize)+Pack::W-1)/Pack::W);
+  X.resize(links.N*7*stride);
+  Q.resize(7*stride);
+  poses.resize(N, output.N, 7);
+  if(!N) return;
+
+  //roots are constant
+  double x[7];
+  for(uint i=0; i<links.N; i++) if(links.elem(i).parent<0) {
+    getPose7(x, links.elem(i).Q);
+    for(uint c=0; c<7; c++) for(uint n=0; n<stride; n++) X.p[(i*7+c)*stride+n] = x[c];
+  }
+
+  for(uint n0=0; n0<N; n0+=stride) evalBlock(poses, qBatch, n0, std::min(stride, N-n0));
+}
+
+void rai::BatchFK::evalBlock(arr& poses, const arr& qBatch, uint n0, uint m) {
+  double Qconst[7];
+  rai::Transformation Qn;
+  for(uint i=0; i<links.N; i++) {
+    const Link& l = links.elem(i);
+    if(l.parent<0) continue;
+    double* Xi = X.p+i*7*stride;
+    const double* Xparent = X.p+l.parent*7*stride;
+    if(!l.joint) {
+      getPose7(Qconst, l.Q);
+      composeBatch<true>(Xi, Xparent, Qconst, stride);
+      continue;
+    }
+
+    //the joint transformations of all samples of the block (padding samples are the identity)
+    const double* q = qBatch.p+n0*qDim+l.joint->qIndex;
+    JointType type = l.joint->type;
+    if(type==JT_hingeX || type==JT_hingeY || type==JT_hingeZ) {
+      uint axis = 4+(type-JT_hingeX);
+      memset(Q.p, 0, 7*stride*Q.sizeT);
+      double a = .5*l.joint->scale;
+      for(uint n=0; n<m; n++) {
+        double phi = a*q[n*qDim];
+        Q.p[axis*stride+n] = ::sin(phi);
+        Q.p[3*stride+n] = ::cos(phi);
+      }
+      for(uint n=m; n<stride; n++) Q.p[3*stride+n] = 1.;
+    } else {
+      for(uint n=0; n<stride; n++) {
+        if(n<m) l.joint->calc_Q_from_dofs(Qn, q+n*qDim);
+        else Qn.setZero();
+        getPose7(Qconst, Qn);
+        for(uint c=0; c<7; c++) Q.p[c*stride+n] = Qconst[c];
+      }
+    }
+    composeBatch<false>(Xi, Xparent, Q.p, stride);
+  }
+
+  double* x = poses.p+n0*output.N*7;
+  for(uint n=0; n<m; n++) for(uint i=0; i<output.N; i++) {
+    const double* Xi = X.p+output.p[i]*7*stride+n;
+    for(uint c=0; c<7; c++) *(x++) = Xi[c*stride];
+  }
+}
+
+uint rai::BatchFK::simdWidth() { return Pack::W; }
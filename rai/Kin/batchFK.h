@@ -0,0 +1,50 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "kin.h"
+
+namespace rai {
+
+//===========================================================================
+
+/** Forward kinematics for many joint states at once: maps the (N,d)-matrix of joint states (each row as
+ *  C.getJointState()) to the (N,F,7)-tensor of frame poses (each slice as C.getFrameState(frames)).
+ *  The tree is traversed once per block of samples, in the order of C.calc_topSort(); per frame, the poses
+ *  of all samples in the block are composed on a struct-of-arrays buffer (AVX-512 or AVX2 when built with
+ *  SIMD=avx512 or SIMD=avx2 in config.mk, scalar otherwise). Only the active joints are articulated -- all other
+ *  relative transformations are copied from C at construction, so rebuild the BatchFK when C's structure or
+ *  inactive joints change. */
+struct BatchFK {
+  struct Link {
+    Frame* frame=0;
+    int parent=-1;           ///< index of the parent link (-1 for roots)
+    const Joint* joint=0;    ///< the joint articulating Q (the mimic'ed joint for mimicers); 0 if Q is constant
+    Transformation Q=0;      ///< constant relative transformation (absolute pose X for roots)
+  };
+  Array<Link> links;   ///< all frames in topological order
+  uintA output;        ///< links that are returned, in the order of the given frames
+  uint qDim=0;
+  uint blockSize=64;   ///< samples per traversal of the tree (so that the buffers stay in cache)
+  uint stride=0;       ///< block size padded to the SIMD width
+  arr X;               ///< struct-of-arrays poses of all links: component c of link i of sample n at X.p[(i*7+c)*stride+n]
+  arr Q;               ///< struct-of-arrays buffer of one joint transformation for all samples of a block
+
+  BatchFK(Configuration& C, const FrameL& frames= {});
+
+  void eval(arr& poses, const arr& qBatch);
+  arr eval(const arr& qBatch) { arr poses; eval(poses, qBatch); return poses; }
+
+  static uint simdWidth();
+
+private:
+  void evalBlock(arr& poses, const arr& qBatch, uint n0, uint m);
+};
+
+} //namespace rai
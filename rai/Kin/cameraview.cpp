@@ -130,6 +130,39 @@ void rai::CameraView::computeImageAndDepth(byteA& image, floatA& depth) {
   done(__func__);
 }
 
+void rai::CameraView::computeDepthByRayCasting(floatA& depth) {
+  CHECK(currentSensor, "no sensor selected");
+  updateCamera();
+  const rai::Camera& cam = currentSensor->cam;
+  CHECK(cam.focalLength>0, "need a focal length greater zero!(not implemented for ortho yet)");
+  uint H=currentSensor->height, W=currentSensor->width;
+
+  FrameL F;
+  for(rai::Frame* f:C.frames) if(f->shape && f->shape->type()!=ST_camera && f->shape->type()!=ST_marker && f->shape->mesh().T.N) F.append(f);
+
+  //pixels as in computePointCloud: the ray (x/f, -y/f, -1) in camera coordinates hits at t = true depth
+  depth.resize(H, W);
+  int centerX = (W >> 1);
+  int centerY = (H >> 1);
+  double focal = 1./(cam.focalLength*H);
+  arr origin(3), dir(3);
+  uint i=0;
+  for(int y=-centerY+1; y<=centerY; y++) for(int x=-centerX+1; x<=centerX; x++, i++) {
+      rai::Vector d = cam.X.rot * rai::Vector(focal*x, -focal*y, -1.);
+      double best=-1., t;
+      uint tri;
+      for(rai::Frame* f:F) {
+        const rai::Transformation& X = f->ensure_X();
+        rai::Vector o = cam.X.pos / X, dl = d / X.rot;
+        origin = {o.x, o.y, o.z};
+        dir = {dl.x, dl.y, dl.z};
+        if(f->shape->mesh().rayCast(t, tri, origin, dir, best) ) best = t;
+      }
+      depth.elem(i) = best;
+    }
+  done(__func__);
+}
+
 void rai::CameraView::computeSegmentation(byteA& segmentation) {
   updateCamera();
   renderMode=seg;
@@ -54,6 +54,7 @@ struct CameraView : GLDrawer {
 
   //-- compute/analyze a camera perspective (stored in classes' output fields)
   void computeImageAndDepth(byteA& image, floatA& depth);
+  void computeDepthByRayCasting(floatA& depth); //the same depth image (-1: no hit) by casting rays into the meshes' AABB trees, without OpenGL
   void computeKinectDepth(uint16A& kinect_depth, const arr& depth);
   void computePointCloud(arr& pts, const floatA& depth, bool globalCoordinates=true); // point cloud (rgb of every point is given in image)
   void computeSegmentation(byteA& segmentation);     // -> segmentation
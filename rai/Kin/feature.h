@@ -11,6 +11,7 @@
 #include "kin.h"
 #include "frame.h"
 #include "featureSymbols.h"
+#include "../Core/trace.h"
 
 void grabJ(arr& y, arr& J);
 
@@ -45,7 +46,10 @@ protected:
   virtual uint dim_phi2(const FrameL& F) {  NIY; }
 
  public:
-  arr eval(const FrameL& F) { arr y = phi(F); applyLinearTrans(y); return y; }
+  arr eval(const FrameL& F) {
+    RAI_TRACE_SCOPE(rai::niceTypeidName(typeid(*this)));
+    arr y = phi(F); applyLinearTrans(y); return y;
+  }
 //  Value eval(const FrameL& F) { arr y, J; eval(y, J, F); return Value(y, J); }
   arr eval(const rai::Configuration& C) { return eval(getFrames(C)); }
   uint dim(const FrameL& F) { uint d=dim_phi2(F); return applyLinearTrans_dim(d); }
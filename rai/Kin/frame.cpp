@@ -85,6 +85,7 @@ rai::Frame::~Frame() {
     C.frames.remove(ID);
     for(uint i=0; i<C.frames.N; i++) C.frames.elem(i)->ID=i;
   }
+  C.reset_frameNameIndex();
   C.reset_q();
 }
 
@@ -336,7 +337,7 @@ void rai::Frame::read(const Graph& ats) {
     set_Q()->rot.normalize();
   }
 
-  if(ats["type"]) ats["type"]->key = "shape"; //compatibility with old convention: 'body { type... }' generates shape
+  if(ats["type"]) ats["type"]->setKey("shape"); //compatibility with old convention: 'body { type... }' generates shape
 
   if((n=ats["joint"])) {
     if(ats["B"]) { //there is an extra transform from the joint into this frame -> create an own joint frame
@@ -429,6 +430,20 @@ void rai::Frame::write(std::ostream& os) const {
 
 /************* USER INTERFACE **************/
 
+rai::Frame& rai::Frame::setName(const char* _name) {
+  std::lock_guard<std::mutex> lock(C._frameNameIndexMutex);
+  if(ID<C._frameNameIndexN) { //already indexed: move to the list of the new name, in ID order
+    auto it = C._frameNameIndex.find(std::string(name.p, name.N));
+    if(it!=C._frameNameIndex.end()) it->second.removeValue(ID, false);
+    uintA& ids = C._frameNameIndex[_name];
+    uint i=ids.N;
+    while(i && ids.elem(i-1)>ID) i--;
+    ids.insert(i, ID);
+  }
+  name = _name;
+  return *this;
+}
+
 rai::Frame& rai::Frame::setShape(rai::ShapeType shape, const arr& size) {
   getShape().type() = shape;
   getShape().size = size;
@@ -769,156 +784,20 @@ void rai::Joint::setDofs(const arr& q_full, uint _qIndex) {
   CHECK(dim!=UINT_MAX, "");
   CHECK_LE(_qIndex+dim, q_full.N, "");
   rai::Transformation& Q = frame->Q;
-  Q.setZero();
-  std::shared_ptr<arr> q_copy;
-  double* qp;
-  if(scale==1.) {
-    qp = q_full.p + _qIndex;
-  } else {
-    q_copy = make_shared<arr>(dim);
-    for(uint i=0; i<dim; i++) q_copy->elem(i) = q_full.elem(_qIndex+i);
-    *q_copy *= scale;
-    qp = q_copy->p;
-  }
   if(mimic) {
+    Q.setZero();
     if(type!=JT_tau){
       Q = mimic->frame->get_Q();
     }else{
       frame->tau = mimic->frame->tau;
     }
   } else {
-    switch(type) {
-      case JT_hingeX: {
-        Q.rot.setRadX(qp[0]);
-      } break;
-
-      case JT_hingeY: {
-        Q.rot.setRadY(qp[0]);
-      } break;
-
-      case JT_hingeZ: {
-        Q.rot.setRadZ(qp[0]);
-      } break;
-
-      case JT_universal: {
-        rai::Quaternion rot1, rot2;
-        rot1.setRadX(qp[0]);
-        rot2.setRadY(qp[1]);
-        Q.rot = rot1*rot2;
-      } break;
-
-      case JT_quatBall: {
-        Q.rot.set(qp);
-        {
-          double n=Q.rot.normalization();
-          if(!rai_Kin_frame_ignoreQuatNormalizationWarning) if(n<.1 || n>10.) LOG(-1) <<"quat normalization is extreme: " <<n;
-        }
-        Q.rot.normalize();
-        Q.rot.isZero=false; //WHY? (gradient check fails without!)
-      } break;
-
-      case JT_free: {
-        Q.pos.set(qp);
-        Q.rot.set(qp+3);
-        {
-          double n=Q.rot.normalization();
-          if(!rai_Kin_frame_ignoreQuatNormalizationWarning) if(n<.1 || n>10.) LOG(-1) <<"quat normalization is extreme: " <<n;
-        }
-        Q.rot.normalize();
-        Q.rot.isZero=false;
-      } break;
-
-      case JT_XBall: {
-        Q.pos.x = qp[0];
-        Q.pos.y = 0.;
-        Q.pos.z = 0.;
-        Q.pos.isZero = false;
-        Q.rot.set(qp+1);
-        {
-          double n=Q.rot.normalization();
-          if(n<.1 || n>10.) LOG(-1) <<"quat normalization is extreme: " <<n;
-        }
-        Q.rot.normalize();
-        Q.rot.isZero=false;
-      } break;
-
-      case JT_generic: {
-        for(uint i=0;i<code.N;i++){
-          switch(code[i]){
-            case 't':
-              frame->tau = 1e-1 * qp[i];
-              if(frame->tau<1e-10) frame->tau=1e-10;
-              break;
-            case 'x':  Q.pos.x = qp[i];  Q.pos.isZero=false;  break;
-            case 'X':  Q.pos.x = -qp[i];  Q.pos.isZero=false;  break;
-            case 'y':  Q.pos.y = qp[i];  Q.pos.isZero=false;  break;
-            case 'Y':  Q.pos.y = -qp[i];  Q.pos.isZero=false;  break;
-            case 'z':  Q.pos.z = qp[i];  Q.pos.isZero=false;  break;
-            case 'Z':  Q.pos.z = -qp[i];  Q.pos.isZero=false;  break;
-            case 'a':  Q.rot.addX(qp[i]);  break;
-            case 'A':  Q.rot.addX(-qp[i]);  break;
-            case 'b':  Q.rot.addY(qp[i]);  break;
-            case 'B':  Q.rot.addY(-qp[i]);  break;
-            case 'c':  Q.rot.addZ(qp[i]);  break;
-            case 'C':  Q.rot.addZ(-qp[i]);  break;
-            case 'w':{
-              CHECK_EQ(code.N-i, 4, "");
-              Q.rot.set(qp+i);
-              {
-                double n=Q.rot.normalization();
-                if(n<.1 || n>10.) LOG(-1) <<"quat normalization is extreme: " <<n;
-              }
-              Q.rot.normalize();
-              Q.rot.isZero=false;
-              i+=3;
-            } break;
-          }
-        }
-      } break;
-
-      case JT_transX: {
-        Q.pos = qp[0] * Vector_x;
-      } break;
-
-      case JT_transY: {
-        Q.pos = qp[0] * Vector_y;
-      } break;
-
-      case JT_transZ: {
-        Q.pos = qp[0] * Vector_z;
-      } break;
-
-      case JT_transXY: {
-        Q.pos.set(qp[0], qp[1], 0.);
-      } break;
-
-      case JT_trans3: {
-        Q.pos.set(qp);
-      } break;
-
-      case JT_transXYPhi: {
-        Q.pos.set(qp[0], qp[1], 0.);
-        Q.rot.setRadZ(qp[2]);
-      } break;
-
-      case JT_transYPhi: {
-        Q.pos.set(0., qp[0], 0.);
-        Q.rot.setRadZ(qp[1]);
-      } break;
-
-      case JT_phiTransXY: {
-        Q.rot.setRadZ(qp[0]);
-        Q.pos = Q.rot*Vector(qp[1], qp[2], 0.);
-      } break;
-
-      case JT_rigid:
-        break;
-
-      case JT_tau:
-        frame->tau = 1e-1 * qp[0];
+    calc_Q_from_dofs(Q, q_full.p+_qIndex);
+    if(type==JT_tau || type==JT_generic) {
+      for(uint i=0; i<dim; i++) if(type==JT_tau || code(i)=='t') {
+        frame->tau = 1e-1 * scale * q_full.elem(_qIndex+i);
         if(frame->tau<1e-10) frame->tau=1e-10;
-        break;
-      default: NIY;
+      }
     }
   }
   CHECK_EQ(Q.pos.x, Q.pos.x, "NAN transform");
@@ -939,6 +818,144 @@ void rai::Joint::setDofs(const arr& q_full, uint _qIndex) {
   }
 }
 
+void rai::Joint::calc_Q_from_dofs(rai::Transformation& Q, const double* qp) const {
+  Q.setZero();
+  arr q_copy;
+  if(scale!=1.) {
+    q_copy.setCarray(qp, dim);
+    q_copy *= scale;
+    qp = q_copy.p;
+  }
+  switch(type) {
+    case JT_hingeX: {
+      Q.rot.setRadX(qp[0]);
+    } break;
+
+    case JT_hingeY: {
+      Q.rot.setRadY(qp[0]);
+    } break;
+
+    case JT_hingeZ: {
+      Q.rot.setRadZ(qp[0]);
+    } break;
+
+    case JT_universal: {
+      rai::Quaternion rot1, rot2;
+      rot1.setRadX(qp[0]);
+      rot2.setRadY(qp[1]);
+      Q.rot = rot1*rot2;
+    } break;
+
+    case JT_quatBall: {
+      Q.rot.set(qp);
+      {
+        double n=Q.rot.normalization();
+        if(!rai_Kin_frame_ignoreQuatNormalizationWarning) if(n<.1 || n>10.) LOG(-1) <<"quat normalization is extreme: " <<n;
+      }
+      Q.rot.normalize();
+      Q.rot.isZero=false; //WHY? (gradient check fails without!)
+    } break;
+
+    case JT_free: {
+      Q.pos.set(qp);
+      Q.rot.set(qp+3);
+      {
+        double n=Q.rot.normalization();
+        if(!rai_Kin_frame_ignoreQuatNormalizationWarning) if(n<.1 || n>10.) LOG(-1) <<"quat normalization is extreme: " <<n;
+      }
+      Q.rot.normalize();
+      Q.rot.isZero=false;
+    } break;
+
+    case JT_XBall: {
+      Q.pos.x = qp[0];
+      Q.pos.y = 0.;
+      Q.pos.z = 0.;
+      Q.pos.isZero = false;
+      Q.rot.set(qp+1);
+      {
+        double n=Q.rot.normalization();
+        if(n<.1 || n>10.) LOG(-1) <<"quat normalization is extreme: " <<n;
+      }
+      Q.rot.normalize();
+      Q.rot.isZero=false;
+    } break;
+
+    case JT_generic: {
+      for(uint i=0;i<code.N;i++){
+        switch(code[i]){
+          case 't':  break; //tau is set in setDofs
+          case 'x':  Q.pos.x = qp[i];  Q.pos.isZero=false;  break;
+          case 'X':  Q.pos.x = -qp[i];  Q.pos.isZero=false;  break;
+          case 'y':  Q.pos.y = qp[i];  Q.pos.isZero=false;  break;
+          case 'Y':  Q.pos.y = -qp[i];  Q.pos.isZero=false;  break;
+          case 'z':  Q.pos.z = qp[i];  Q.pos.isZero=false;  break;
+          case 'Z':  Q.pos.z = -qp[i];  Q.pos.isZero=false;  break;
+          case 'a':  Q.rot.addX(qp[i]);  break;
+          case 'A':  Q.rot.addX(-qp[i]);  break;
+          case 'b':  Q.rot.addY(qp[i]);  break;
+          case 'B':  Q.rot.addY(-qp[i]);  break;
+          case 'c':  Q.rot.addZ(qp[i]);  break;
+          case 'C':  Q.rot.addZ(-qp[i]);  break;
+          case 'w':{
+            CHECK_EQ(code.N-i, 4, "");
+            Q.rot.set(qp+i);
+            {
+              double n=Q.rot.normalization();
+              if(n<.1 || n>10.) LOG(-1) <<"quat normalization is extreme: " <<n;
+            }
+            Q.rot.normalize();
+            Q.rot.isZero=false;
+            i+=3;
+          } break;
+        }
+      }
+    } break;
+
+    case JT_transX: {
+      Q.pos = qp[0] * Vector_x;
+    } break;
+
+    case JT_transY: {
+      Q.pos = qp[0] * Vector_y;
+    } break;
+
+    case JT_transZ: {
+      Q.pos = qp[0] * Vector_z;
+    } break;
+
+    case JT_transXY: {
+      Q.pos.set(qp[0], qp[1], 0.);
+    } break;
+
+    case JT_trans3: {
+      Q.pos.set(qp);
+    } break;
+
+    case JT_transXYPhi: {
+      Q.pos.set(qp[0], qp[1], 0.);
+      Q.rot.setRadZ(qp[2]);
+    } break;
+
+    case JT_transYPhi: {
+      Q.pos.set(0., qp[0], 0.);
+      Q.rot.setRadZ(qp[1]);
+    } break;
+
+    case JT_phiTransXY: {
+      Q.rot.setRadZ(qp[0]);
+      Q.pos = Q.rot*Vector(qp[1], qp[2], 0.);
+    } break;
+
+    case JT_rigid:
+      break;
+
+    case JT_tau:
+      break;
+    default: NIY;
+  }
+}
+
 arr rai::Joint::calcDofsFromConfig() const {
   arr q;
   const rai::Transformation& Q=frame->Q;
@@ -144,6 +144,7 @@ struct Frame : NonCopyable {
   void write(std::ostream& os) const;
 
   //-- HIGHER LEVEL USER INTERFACE
+  Frame& setName(const char* _name); ///< rename (keeps the configuration's name index up to date)
   Frame& setShape(rai::ShapeType shape, const arr& size);
   Frame& setPose(const rai::Transformation& _X);
   Frame& setPosition(const arr& pos);
@@ -243,6 +244,7 @@ struct Joint : Dof, NonCopyable {
 
   void setMimic(Joint* j, bool unsetPreviousMimic=false);
   void setDofs(const arr& q, uint n=0);
+  void calc_Q_from_dofs(Transformation& Q, const double* qp) const; ///< the relative transformation for the dofs qp (without touching the frame)
   arr calcDofsFromConfig() const;
   arr getScrewMatrix();
   uint getDimFromType() const;
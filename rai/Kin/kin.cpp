@@ -20,6 +20,7 @@
 #include "viewer.h"
 #include "../Core/graph.h"
 #include "../Core/util.h"
+#include "../Core/trace.h"
 #include "../Geo/fclInterface.h"
 #include "../Geo/qhull.h"
 #include "../Geo/mesh_readAssimp.h"
@@ -42,8 +43,6 @@
 
 namespace rai {
 
-uint Configuration::setJointStateCount = 0;
-
 //===========================================================================
 //
 // contants
@@ -371,10 +370,41 @@ void Configuration::addConfiguration(const Configuration& C, double tau){
 
 /// get first frame with given name
 Frame* Configuration::getFrame(const char* name, bool warnIfNotExist, bool reverse) const {
-  if(!reverse) {
-    for(Frame* b: frames) if(b->name==name) return b;
-  } else {
-    for(uint i=frames.N; i--;) if(frames.elem(i)->name==name) return frames.elem(i);
+  if(frames.N<32) { //small configurations: linear scan
+    if(!reverse) {
+      for(Frame* b: frames) if(b->name==name) return b;
+    } else {
+      for(uint i=frames.N; i--;) if(frames.elem(i)->name==name) return frames.elem(i);
+    }
+    if(warnIfNotExist) RAI_MSG("cannot find frame named '" <<name <<"'");
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(_frameNameIndexMutex);
+
+  //-- extend the name index by the frames appended since the last call
+  for(; _frameNameIndexN<frames.N; _frameNameIndexN++) {
+    const String& n = frames.elem(_frameNameIndexN)->name;
+    _frameNameIndex[std::string(n.p, n.N)].append(_frameNameIndexN);
+  }
+
+  //-- look up; entries of frames renamed since they were indexed are dropped
+  auto it = _frameNameIndex.find(name);
+  if(it!=_frameNameIndex.end()) {
+    uintA& ids = it->second;
+    while(ids.N) {
+      uint i = reverse ? ids.elem(-1) : ids.elem(0);
+      if(i<frames.N && frames.elem(i)->name==name) return frames.elem(i);
+      if(reverse) ids.resizeCopy(ids.N-1); else ids.remove(0);
+    }
+  }
+
+  //-- not indexed: the frame might have been renamed after it was indexed
+  uintA ids;
+  for(Frame* b: frames) if(b->name==name) ids.append(b->ID);
+  if(ids.N) {
+    _frameNameIndex[name] = ids;
+    return frames.elem(reverse ? ids.elem(-1) : ids.elem(0));
   }
   if(warnIfNotExist) RAI_MSG("cannot find frame named '" <<name <<"'");
   return 0;
@@ -611,7 +641,7 @@ arr Configuration::getFrameState(const FrameL& F) const {
 
 /// set the q-vector (all joint and force DOFs)
 void Configuration::setJointState(const arr& _q) {
-  setJointStateCount++; //global counter
+  setJointStateCount++;
 
 #ifndef RAI_NOCHECK
   uint N=getJointStateDimension();
@@ -634,7 +664,7 @@ void Configuration::setJointState(const arr& _q) {
 
 /// set the DOFs (joints and forces) for the given subset of frames
 void Configuration::setDofState(const arr& _q, const DofL& dofs) {
-  setJointStateCount++; //global counter
+  setJointStateCount++;
   ensure_q();
 
   uint nd=0;
@@ -700,9 +730,10 @@ void Configuration::setTaus(const arr& tau) {
   for(uint t=0;t<frames.d0;t++) frames(t,0)->tau = tau(t);
 }
 
-void Configuration::setRandom(uint timeSlices_d1, int verbose){
+void Configuration::setRandom(uint timeSlices_d1, int verbose, RndStream* stream){
+  auto uni = [stream](double lo, double up) { return stream ? stream->uni(lo, up) : rnd.uni(lo, up); };
   for(Dof *d:activeDofs){
-    if(d->sampleUniform>0. && (d->sampleUniform>=1. || d->sampleUniform>=rnd.uni())){
+    if(d->sampleUniform>0. && (d->sampleUniform>=1. || d->sampleUniform>=uni(0., 1.))){
       //** UNIFORM
       if(verbose>0) LOG(0) <<"init '" <<d->frame->name <<'[' <<d->frame->ID <<',' <<(timeSlices_d1?d->frame->ID/timeSlices_d1:0) <<']' <<"' uniform in limits " <<d->limits <<" relative to '" <<d->frame->parent->name <<"'";
 
@@ -715,7 +746,7 @@ void Configuration::setRandom(uint timeSlices_d1, int verbose){
         double lo = d->limits.elem(2*k+0); //lo
         double up = d->limits.elem(2*k+1); //up
         if(up>=lo){
-          q(k) = rnd.uni(lo,up);
+          q(k) = uni(lo,up);
           d->q0(k) = q(k); //CRUCIAL to impose a bias to that random initialization
         }
       }
@@ -738,7 +769,7 @@ void Configuration::setRandom(uint timeSlices_d1, int verbose){
 
       //gauss
       arr q = d->calcDofsFromConfig();
-      rndGauss(q, d->sampleSdv, true);
+      if(stream) rndGauss(q, *stream, d->sampleSdv, true); else rndGauss(q, d->sampleSdv, true);
       if(verbose>0) LOG(0) <<"init '" <<d->frame->name <<'[' <<d->frame->ID <<',' <<(timeSlices_d1?d->frame->ID/timeSlices_d1:0) <<']' <<"' adding noise: " <<q;
 
       //clip
@@ -1136,6 +1167,7 @@ void Configuration::sortFrames() {
   frames = calc_topSort();
   uint i=0;
   for(Frame* f: frames) f->ID = i++;
+  reset_frameNameIndex();
 }
 
 void Configuration::makeObjectsFree(const StringA& objects, double H_cost) {
@@ -1407,6 +1439,7 @@ FrameL Configuration::getCollisionAllPairs(){
 void Configuration::prefixNames(bool clear) {
   if(!clear) for(Frame* a: frames) a->name=STRING('_' <<a->ID <<'_' <<a->name);
   else       for(Frame* a: frames) a->name.clear() <<a->ID;
+  reset_frameNameIndex();
 }
 
 void Configuration::calc_indexedActiveJoints(bool resetActiveJointSet) {
@@ -1592,6 +1625,52 @@ arr Configuration::calc_fwdPropagateVelocities(const arr& qdot) {
 // core: kinematics and dynamics
 //
 
+double* ChainJacobian::col(uint j) {
+  for(uint k=cols.N; k--;) if(cols.p[k]==j) return vals.p+k*d0;
+  cols.append(j);
+  vals.resizeCopy(cols.N, d0);
+  double* c = vals.p+(cols.N-1)*d0;
+  for(uint i=0; i<d0; i++) c[i]=0.;
+  return c;
+}
+
+void ChainJacobian::add(const Vector& v, uint j, double scale) {
+  CHECK_EQ(d0, 3, "");
+  double* c = col(j);
+  c[0] += scale*v.x;
+  c[1] += scale*v.y;
+  c[2] += scale*v.z;
+}
+
+void ChainJacobian::add(const arr& B, uint j) {
+  CHECK_EQ(B.d0, d0, "");
+  if(B.nd==1) {
+    double* c = col(j);
+    for(uint i=0; i<d0; i++) c[i] += B.p[i];
+  } else {
+    for(uint l=0; l<B.d1; l++) {
+      double* c = col(j+l);
+      for(uint i=0; i<d0; i++) c[i] += B.p[i*B.d1+l];
+    }
+  }
+}
+
+void ChainJacobian::write(arr& J, const Configuration& C) const {
+  if(!J) return;
+  if(C.jacMode==Configuration::JM_sparse) {
+    //directly the compact (row, col, value) triplets -- the pattern only depends on the chain, not the values
+    SparseMatrix& S = J.sparse();
+    S.resize(d0, C.getJointStateDimension(), cols.N*d0);
+    for(uint k=0, n=0; k<cols.N; k++) for(uint i=0; i<d0; i++, n++) S.entry(i, cols.p[k], n) = vals.p[k*d0+i];
+  } else {
+    C.jacobian_zero(J, d0);
+    if(!J) return;
+    for(uint k=0; k<cols.N; k++) for(uint i=0; i<d0; i++) J.elem(i, cols.p[k]) += vals.p[k*d0+i];
+  }
+}
+
+//===========================================================================
+
 /// returns the 'Jacobian' of a zero n-vector (initializes Jacobian to proper sparse/dense/rowShifted/noArr)
 void Configuration::jacobian_zero(arr& J, uint n) const {
   if(!J) return;
@@ -1617,14 +1696,21 @@ void Configuration::kinematicsZero(arr& y, arr& J, uint n) const {
 
 /// what is the linear velocity of a world point (pos_world) attached to frame a for a given joint velocity?
 void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) const {
+  if(!J) return;
+  if(jacMode==JM_noArr) { J.setNoArr(); return; }
+  ChainJacobian Jc(3);
+  jacobian_pos(Jc, a, pos_world);
+  Jc.write(J, *this);
+}
+
+void Configuration::jacobian_pos(ChainJacobian& J, Frame* a, const Vector& pos_world) const {
   CHECK_EQ(&a->C, this, "");
   CHECK(_state_indexedJoints_areGood, "");
+  CHECK_EQ(J.d0, 3, "");
 
   a->ensure_X();
 
   uint N=getJointStateDimension();
-  jacobian_zero(J, 3);
-  if(!J) return;
 
   while(a) { //loop backward down the kinematic tree
     if(!a->parent) break; //frame has no inlink -> done
@@ -1636,36 +1722,25 @@ void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) cons
       if(j_idx<N) {
         if(j->type==JT_hingeX || j->type==JT_hingeY || j->type==JT_hingeZ) {
           Vector tmp = j->axis ^ (pos_world-j->X()*j->Q().pos);
-          tmp *= j->scale;
-          J.elem(0, j_idx) += tmp.x;
-          J.elem(1, j_idx) += tmp.y;
-          J.elem(2, j_idx) += tmp.z;
+          J.add(tmp, j_idx, j->scale);
         } else if(j->type==JT_transX || j->type==JT_transY || j->type==JT_transZ || j->type==JT_XBall) {
-          J.elem(0, j_idx) += j->scale * j->axis.x;
-          J.elem(1, j_idx) += j->scale * j->axis.y;
-          J.elem(2, j_idx) += j->scale * j->axis.z;
+          J.add(j->axis, j_idx, j->scale);
         } else if(j->type==JT_transXY) {
           arr R = j->X().rot.getArr();
           R *= j->scale;
-          J.setMatrixBlock(R.sub(0, -1, 0, 1), 0, j_idx);
+          J.add(R.sub(0, -1, 0, 1), j_idx);
         } else if(j->type==JT_transXYPhi) {
           arr R = j->X().rot.getArr();
           R *= j->scale;
-          J.setMatrixBlock(R.sub(0, -1, 0, 1), 0, j_idx);
+          J.add(R.sub(0, -1, 0, 1), j_idx);
           Vector tmp = j->axis ^ (pos_world-(j->X().pos + j->X().rot*a->Q.pos));
-          tmp *= j->scale;
-          J.elem(0, j_idx+2) += tmp.x;
-          J.elem(1, j_idx+2) += tmp.y;
-          J.elem(2, j_idx+2) += tmp.z;
+          J.add(tmp, j_idx+2, j->scale);
         } else if(j->type==JT_phiTransXY) {
           Vector tmp = j->axis ^ (pos_world-j->X().pos);
-          tmp *= j->scale;
-          J.elem(0, j_idx) += tmp.x;
-          J.elem(1, j_idx) += tmp.y;
-          J.elem(2, j_idx) += tmp.z;
+          J.add(tmp, j_idx, j->scale);
           arr R = (j->X().rot*a->Q.rot).getArr();
           R *= j->scale;
-          J.setMatrixBlock(R.sub(0, -1, 0, 1), 0, j_idx+1);
+          J.add(R.sub(0, -1, 0, 1), j_idx+1);
         }
         if(j->type==JT_generic){
           arr R = j->frame->parent->get_X().rot.getArr();
@@ -1677,24 +1752,24 @@ void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) cons
           for(uint i=0;i<j->code.N;i++){
             switch(j->code[i]){
               case 't': break;
-              case 'x':  J.setMatrixBlock(Rt[0], 0, j_idx+i);  break;
-              case 'X':  J.setMatrixBlock(-Rt[0], 0, j_idx+i);  break;
-              case 'y':  J.setMatrixBlock(Rt[1], 0, j_idx+i);  break;
-              case 'Y':  J.setMatrixBlock(-Rt[1], 0, j_idx+i);  break;
-              case 'z':  J.setMatrixBlock(Rt[2], 0, j_idx+i);  break;
-              case 'Z':  J.setMatrixBlock(-Rt[2], 0, j_idx+i);  break;
-              case 'a':  J.setMatrixBlock(-D*Rt[0], 0, j_idx+i);  break;
-              case 'A':  J.setMatrixBlock(D*Rt[0], 0, j_idx+i);  break;
-              case 'b':  J.setMatrixBlock(-D*Rt[1], 0, j_idx+i);  break;
-              case 'B':  J.setMatrixBlock(D*Rt[1], 0, j_idx+i);  break;
-              case 'c':  J.setMatrixBlock(-D*Rt[2], 0, j_idx+i);  break;
-              case 'C':  J.setMatrixBlock(D*Rt[2], 0, j_idx+i);  break;
+              case 'x':  J.add(Rt[0], j_idx+i);  break;
+              case 'X':  J.add(-Rt[0], j_idx+i);  break;
+              case 'y':  J.add(Rt[1], j_idx+i);  break;
+              case 'Y':  J.add(-Rt[1], j_idx+i);  break;
+              case 'z':  J.add(Rt[2], j_idx+i);  break;
+              case 'Z':  J.add(-Rt[2], j_idx+i);  break;
+              case 'a':  J.add(-D*Rt[0], j_idx+i);  break;
+              case 'A':  J.add(D*Rt[0], j_idx+i);  break;
+              case 'b':  J.add(-D*Rt[1], j_idx+i);  break;
+              case 'B':  J.add(D*Rt[1], j_idx+i);  break;
+              case 'c':  J.add(-D*Rt[2], j_idx+i);  break;
+              case 'C':  J.add(D*Rt[2], j_idx+i);  break;
               case 'w':{
                 arr Jrot = j->X().rot.getArr() * a->Q.rot.getJacobian(); //transform w-vectors into world coordinate
                 Jrot *= j->scale;
                 Jrot = crossProduct(Jrot, conv_vec2arr(d));  //cross-product of all 4 w-vectors with lever
                 Jrot /= sqrt(sumOfSqr(q({j_idx+i, j_idx+i+3})));   //account for the potential non-normalization of q
-                J.setMatrixBlock(Jrot, 0, j_idx+i);
+                J.add(Jrot, j_idx+i);
                 i+=3;
               } break;
             }
@@ -1704,12 +1779,12 @@ void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) cons
           arr R = conv_vec2arr(j->X().rot.getX());
           R *= j->scale;
           R.reshape(3, 1);
-          J.setMatrixBlock(R, 0, j_idx);
+          J.add(R, j_idx);
         }
         if(j->type==JT_trans3 || j->type==JT_free) {
           arr R = j->X().rot.getArr();
           R *= j->scale;
-          J.setMatrixBlock(R, 0, j_idx);
+          J.add(R, j_idx);
         }
         if(j->type==JT_quatBall || j->type==JT_free || j->type==JT_XBall) {
           uint offset = 0;
@@ -1720,7 +1795,7 @@ void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) cons
           Jrot /= sqrt(sumOfSqr(q({j->qIndex+offset, j->qIndex+offset+3})));   //account for the potential non-normalization of q
           //          for(uint i=0;i<4;i++) for(uint k=0;k<3;k++) J.elem(k,j_idx+offset+i) += Jrot(k,i);
           Jrot *= j->scale;
-          J.setMatrixBlock(Jrot, 0, j_idx+offset);
+          J.add(Jrot, j_idx+offset);
         }
       }
     }
@@ -1735,11 +1810,18 @@ void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) cons
 
 /// what is the angular velocity of frame a for a given joint velocity?
 void Configuration::jacobian_angular(arr& J, Frame* a) const {
+  if(!J) return;
+  if(jacMode==JM_noArr) { J.setNoArr(); return; }
+  ChainJacobian Jc(3);
+  jacobian_angular(Jc, a);
+  Jc.write(J, *this);
+}
+
+void Configuration::jacobian_angular(ChainJacobian& J, Frame* a) const {
+  CHECK_EQ(J.d0, 3, "");
   a->ensure_X();
 
   uint N = getJointStateDimension();
-  jacobian_zero(J, 3);
-  if(!J) return;
 
   while(a) { //loop backward down the kinematic tree
     Joint* j=a->joint;
@@ -1749,9 +1831,7 @@ void Configuration::jacobian_angular(arr& J, Frame* a) const {
       if(j_idx<N) {
         if((j->type>=JT_hingeX && j->type<=JT_hingeZ) || j->type==JT_transXYPhi || j->type==JT_phiTransXY) {
           if(j->type==JT_transXYPhi) j_idx += 2; //refer to the phi only
-          J.elem(0, j_idx) += j->scale * j->axis.x;
-          J.elem(1, j_idx) += j->scale * j->axis.y;
-          J.elem(2, j_idx) += j->scale * j->axis.z;
+          J.add(j->axis, j_idx, j->scale);
         }
         if(j->type==JT_quatBall || j->type==JT_free || j->type==JT_XBall) {
           uint offset = 0;
@@ -1761,7 +1841,7 @@ void Configuration::jacobian_angular(arr& J, Frame* a) const {
           Jrot /= sqrt(sumOfSqr(q({j->qIndex+offset, j->qIndex+offset+3}))); //account for the potential non-normalization of q
           //          for(uint i=0;i<4;i++) for(uint k=0;k<3;k++) J.elem(k,j_idx+offset+i) += Jrot(k,i);
           Jrot *= j->scale;
-          J.setMatrixBlock(Jrot, 0, j_idx+offset);
+          J.add(Jrot, j_idx+offset);
         }
         if(j->type==JT_generic) {
           arr R = j->frame->parent->get_X().rot.getArr();
@@ -1771,17 +1851,17 @@ void Configuration::jacobian_angular(arr& J, Frame* a) const {
           for(uint i=0;i<j->code.N;i++){
             switch(j->code[i]){
               case 't': break;
-              case 'a':  J.setMatrixBlock(Rt[0], 0, j_idx+i);  break;
-              case 'A':  J.setMatrixBlock(-Rt[0], 0, j_idx+i);  break;
-              case 'b':  J.setMatrixBlock(Rt[1], 0, j_idx+i);  break;
-              case 'B':  J.setMatrixBlock(-Rt[1], 0, j_idx+i);  break;
-              case 'c':  J.setMatrixBlock(Rt[2], 0, j_idx+i);  break;
-              case 'C':  J.setMatrixBlock(-Rt[2], 0, j_idx+i);  break;
+              case 'a':  J.add(Rt[0], j_idx+i);  break;
+              case 'A':  J.add(-Rt[0], j_idx+i);  break;
+              case 'b':  J.add(Rt[1], j_idx+i);  break;
+              case 'B':  J.add(-Rt[1], j_idx+i);  break;
+              case 'c':  J.add(Rt[2], j_idx+i);  break;
+              case 'C':  J.add(-Rt[2], j_idx+i);  break;
               case 'w':{
                 arr Jrot = j->X().rot.getArr() * a->Q.rot.getJacobian(); //transform w-vectors into world coordinate
                 Jrot *= j->scale;
                 Jrot /= sqrt(sumOfSqr(q({j_idx+i, j_idx+i+3}))); //account for the potential non-normalization of q
-                J.setMatrixBlock(Jrot, 0, j_idx+i);
+                J.add(Jrot, j_idx+i);
                 i+=3;
               } break;
             }
@@ -1843,9 +1923,16 @@ void Configuration::kinematicsVec(arr& y, arr& J, Frame* a, const Vector& vec) c
   vec_world = a->ensure_X().rot*vec;
   if(!!y) y = conv_vec2arr(vec_world);
   if(!!J) {
-    arr A;
+    if(jacMode==JM_noArr) { J.setNoArr(); return; }
+    ChainJacobian A(3);
     jacobian_angular(A, a);
-    J = crossProduct(A, conv_vec2arr(vec_world));
+    for(uint k=0; k<A.cols.N; k++) { //each column: w x vec_world
+      double* c = A.vals.p+3*k;
+      Vector w(c[0], c[1], c[2]);
+      w = w ^ vec_world;
+      c[0]=w.x; c[1]=w.y; c[2]=w.z;
+    }
+    A.write(J, *this);
   }
 }
 
@@ -1860,14 +1947,23 @@ void Configuration::kinematicsMat(arr& y, arr& J, Frame* a) const {
     y.reshape(9);
   }
   if(!!J) {
-    arr A;
+    if(jacMode==JM_noArr) { J.setNoArr(); return; }
+    ChainJacobian A(3);
     jacobian_angular(A, a);
-    jacobian_zero(J, 9);
-    if(A.N){
-      J.setMatrixBlock(crossProduct(A, R[0]), 0, 0);
-      J.setMatrixBlock(crossProduct(A, R[1]), 3, 0);
-      J.setMatrixBlock(crossProduct(A, R[2]), 6, 0);
+    ChainJacobian JR(9);
+    JR.cols = A.cols;
+    JR.vals.resize(A.cols.N, 9);
+    Vector Rrow[3] = { Vector(R[0]), Vector(R[1]), Vector(R[2]) };
+    for(uint k=0; k<A.cols.N; k++) { //each column: w x R[i] for each row of R
+      const double* c = A.vals.p+3*k;
+      Vector w(c[0], c[1], c[2]);
+      for(uint i=0; i<3; i++) {
+        Vector v = w ^ Rrow[i];
+        double* cR = JR.vals.p+9*k+3*i;
+        cR[0]=v.x; cR[1]=v.y; cR[2]=v.z;
+      }
     }
+    JR.write(J, *this);
   }
 }
 
@@ -1879,21 +1975,34 @@ void Configuration::kinematicsQuat(arr& y, arr& J, Frame* a) const { //TODO: all
 
   const Quaternion& rot_a = a->ensure_X().rot;
   if(!!y) y = rot_a.getArr4d();
-  arr ROT_A = rot_a.getQuaternionMultiplicationMatrix();
+  if(!J) return;
+  if(jacMode==JM_noArr) { J.setNoArr(); return; }
+
+  if(jacMode==JM_sparse || jacMode==JM_dense) {
+    //compact: each column of J is ROT_A * (0, .5*w)
+    ChainJacobian A(3);
+    jacobian_angular(A, a);
+    arr ROT_A = rot_a.getQuaternionMultiplicationMatrix();
+    ChainJacobian JQ(4);
+    JQ.cols = A.cols;
+    JQ.vals.resize(A.cols.N, 4);
+    for(uint k=0; k<A.cols.N; k++) {
+      const double* c = A.vals.p+3*k;
+      double* cQ = JQ.vals.p+4*k;
+      for(uint i=0; i<4; i++) cQ[i] = .5*(ROT_A.p[4*i+1]*c[0] + ROT_A.p[4*i+2]*c[1] + ROT_A.p[4*i+3]*c[2]);
+    }
+    JQ.write(J, *this);
+    return;
+  }
 
+  arr ROT_A = rot_a.getQuaternionMultiplicationMatrix();
   arr A;
   jacobian_angular(A, a);
   if(!A){
     J.setNoArr();
     return;
   }
-  if(isSparse(A)) {
-    J = A;
-    J.sparse().reshape(4, A.d1);
-    J.sparse().colShift(1);
-    J *= .5;
-    J = ROT_A * J;
-  } else if(isRowShifted(A)) {
+  if(isRowShifted(A)) {
     J = A;
     J *= .5;
     J.rowShifted().insRow(0);
@@ -2096,6 +2205,10 @@ void Configuration::swiftDelete() {
   self->swift.reset();
 }
 
+void Configuration::fclDelete() {
+  self->fcl.reset();
+}
+
 /// return a PhysX extension
 PhysXInterface& Configuration::physx() {
   if(!self->physx) {
@@ -2207,6 +2320,7 @@ void Configuration::addProxies(const uintA& collisionPairs) {
 }
 
 void Configuration::stepSwift() {
+  RAI_TRACE_SCOPE("Configuration::stepSwift");
   arr X = getFrameState();
   uintA collisionPairs = swift()->step(X, false);
   //  reportProxies();
@@ -2219,6 +2333,7 @@ void Configuration::stepSwift() {
 }
 
 void Configuration::stepFcl() {
+  RAI_TRACE_SCOPE("Configuration::stepFcl");
   //-- get the frame state of collision objects
   arr X = getFrameState();
   //-- step fcl
@@ -2343,7 +2458,7 @@ void Configuration::copyProxies(const ProxyA& _proxies) {
 
 /// prototype for \c operator<<
 void Configuration::write(std::ostream& os, bool explicitlySorted) const {
-  for(Frame* f: frames) if(!f->name.N) f->name <<'_' <<f->ID;
+  for(Frame* f: frames) if(!f->name.N) f->setName(STRING('_' <<f->ID));
   if(!explicitlySorted){
     for(Frame* f: frames) f->write(os);
   }else{
@@ -2354,7 +2469,7 @@ void Configuration::write(std::ostream& os, bool explicitlySorted) const {
 }
 
 void Configuration::write(Graph& G) const {
-  for(Frame* f: frames) if(!f->name.N) f->name <<'_' <<f->ID;
+  for(Frame* f: frames) if(!f->name.N) f->setName(STRING('_' <<f->ID));
   for(Frame* f: frames) f->write(G.newSubgraph({f->name}));
 }
 
@@ -2558,16 +2673,16 @@ Graph Configuration::getGraph() const {
     Node* n = G.elem(f->ID);
     if(f->parent) {
       n->addParent(G.elem(f->parent->ID));
-      n->key = STRING("Q= " <<f->get_Q());
+      n->setKey(STRING("Q= " <<f->get_Q()));
     }
     if(f->joint) {
-      n->key = (STRING("joint " <<f->joint->type));
+      n->setKey(STRING("joint " <<f->joint->type));
     }
     if(f->shape) {
-      n->key = (STRING("shape " <<f->shape->type()));
+      n->setKey(STRING("shape " <<f->shape->type()));
     }
     if(f->inertia) {
-      n->key = (STRING("inertia m=" <<f->inertia->mass));
+      n->setKey(STRING("inertia m=" <<f->inertia->mass));
     }
   }
 #else
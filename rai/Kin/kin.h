@@ -14,6 +14,10 @@
 #include "../Geo/geo.h"
 #include "../Geo/mesh.h"
 
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
 struct OpenGL;
 struct PhysXInterface;
 struct SwiftInterface;
@@ -57,6 +61,21 @@ namespace rai {
 
 //===========================================================================
 
+/// Jacobian in compact (columns, values) form: only the joint columns touched along a kinematic chain are stored,
+/// so that its computation scales with the chain depth rather than the joint state dimension
+struct ChainJacobian {
+  uint d0;     ///< number of rows
+  uintA cols;  ///< touched columns (joint state indices)
+  arr vals;    ///< (cols.N, d0): for each touched column its values
+  explicit ChainJacobian(uint _d0) : d0(_d0) {}
+  double* col(uint j); ///< values of column j (appended as zero if not touched yet)
+  void add(const Vector& v, uint j, double scale=1.);
+  void add(const arr& B, uint j); ///< add the columns of B (or vector B) to columns j, j+1, ..
+  void write(arr& J, const Configuration& C) const; ///< write into the full-width J, in the configuration's jacMode
+};
+
+//===========================================================================
+
 /// data structure to store a kinematic/physical situation (lists of frames (with joints, shapes, inertias), forces & proxies)
 struct Configuration : GLDrawer {
   unique_ptr<struct sConfiguration> self;
@@ -73,13 +92,16 @@ struct Configuration : GLDrawer {
   bool _state_indexedJoints_areGood=false; // the active sets, incl. their topological sorting, are up to date
   bool _state_q_isGood=false; // the q-vector represents the current relative transforms (and force dofs)
   bool _state_proxies_isGood=false; // the proxies have been created for the current state
+  mutable std::unordered_map<std::string, uintA> _frameNameIndex; // name -> frame IDs of the first _frameNameIndexN frames (extended by getFrame(); rename frames with Frame::setName)
+  mutable uint _frameNameIndexN=0;
+  mutable std::mutex _frameNameIndexMutex; // getFrame() extends the index, also of configurations shared between threads
   //TODO: need a _state for all the plugin engines (SWIFT, PhysX)? To auto-reinitialize them when the config changed structurally?
 
   //-- format in which Jacobians are returned
   enum JacobianMode { JM_dense, JM_sparse, JM_rowShifted, JM_noArr, JM_emptyShape };
   JacobianMode jacMode = JM_dense;
 
-  static uint setJointStateCount;
+  uint setJointStateCount=0; ///< counter of setJointState calls (per configuration, as configurations may be evaluated in parallel)
 
   /// @name constructors
   Configuration();
@@ -141,7 +163,7 @@ struct Configuration : GLDrawer {
   void setFrameState(const arr& X, const uintA& F){ setFrameState(X, getFrames(F)); } ///< same as setFrameState() with getFrames()
   void setTaus(double tau);
   void setTaus(const arr& tau);
-  void setRandom(uint timeSlices_d1=0, int verbose=0);
+  void setRandom(uint timeSlices_d1=0, int verbose=0, RndStream* stream=nullptr); ///< samples the DOFs (from the given stream, e.g. one per thread; default: the global rnd)
 
   /// @name active DOFs selection
   void setActiveDofs(const DofL& dofs);
@@ -166,6 +188,7 @@ struct Configuration : GLDrawer {
   /// @name structural operations, changes of configuration
   void clear();
   void reset_q();
+  void reset_frameNameIndex() const { std::lock_guard<std::mutex> lock(_frameNameIndexMutex); if(_frameNameIndexN) { _frameNameIndex.clear(); _frameNameIndexN=0; } } ///< needed when frames are reordered
   void reconfigureRoot(Frame* newRoot, bool ofLinkOnly);  ///< n becomes the root of the kinematic tree; joints accordingly reversed; lists resorted
   void flipFrames(Frame* a, Frame* b);
   void pruneRigidJoints();        ///< delete rigid joints -> they become just links
@@ -199,6 +222,8 @@ struct Configuration : GLDrawer {
   /// @name Jacobians and kinematics (low level)
   void jacobian_pos(arr& J, Frame* a, const Vector& pos_world) const; //usually called internally with kinematicsPos
   void jacobian_angular(arr& J, Frame* a) const; //usually called internally with kinematicsVec or Quat
+  void jacobian_pos(ChainJacobian& J, Frame* a, const Vector& pos_world) const;
+  void jacobian_angular(ChainJacobian& J, Frame* a) const;
   void jacobian_tau(arr& J, Frame* a) const;
   void jacobian_zero(arr& J, uint n) const;
 
@@ -241,6 +266,7 @@ struct Configuration : GLDrawer {
   std::shared_ptr<SwiftInterface> swift();
   std::shared_ptr<FclInterface> fcl();
   void swiftDelete();
+  void fclDelete();
   PhysXInterface& physx();
   OdeInterface& ode();
   FeatherstoneInterface& fs();
@@ -30,18 +30,25 @@ void rai::Proxy::copy(const rai::Configuration& C, const rai::Proxy& p) {
 //  if(p.collision) collision = p.collision;
 }
 
-void rai::Proxy::calc_coll() {
-  rai::Shape* s1 = a->shape;
-  rai::Shape* s2 = b->shape;
+/// the collision geometry of a proxy's shapes: the sphere-swept core (with its radius) or the mesh
+static void getCollisionMeshes(const rai::Proxy& p, rai::Mesh*& m1, rai::Mesh*& m2, double& r1, double& r2) {
+  rai::Shape* s1 = p.a->shape;
+  rai::Shape* s2 = p.b->shape;
   CHECK(s1 && s2, "");
 
-  double r1=0.; if(s1->size.N) r1=s1->size.elem(-1);
-  double r2=0.; if(s2->size.N) r2=s2->size.elem(-1);
-  rai::Mesh* m1 = &s1->sscCore();  if(!m1->V.N) { m1 = &s1->mesh(); r1=0.; }
-  rai::Mesh* m2 = &s2->sscCore();  if(!m2->V.N) { m2 = &s2->mesh(); r2=0.; }
+  r1=0.; if(s1->size.N) r1=s1->size.elem(-1);
+  r2=0.; if(s2->size.N) r2=s2->size.elem(-1);
+  m1 = &s1->sscCore();  if(!m1->V.N) { m1 = &s1->mesh(); r1=0.; }
+  m2 = &s2->sscCore();  if(!m2->V.N) { m2 = &s2->mesh(); r2=0.; }
+}
+
+void rai::Proxy::calc_coll(PairCollisionCache* cache) {
+  rai::Mesh *m1, *m2;
+  double r1, r2;
+  getCollisionMeshes(*this, m1, m2, r1, r2);
 
   if(collision) collision.reset();
-  collision = make_shared<PairCollision>(*m1, *m2, s1->frame.ensure_X(), s2->frame.ensure_X(), r1, r2);
+  collision = make_shared<PairCollision>(*m1, *m2, a->ensure_X(), b->ensure_X(), r1, r2, cache);
 
   d = collision->distance-collision->rad1-collision->rad2;
   normal = collision->normal;
@@ -51,6 +58,13 @@ void rai::Proxy::calc_coll() {
   if(collision->rad2>0.) posB += collision->rad2*normal;
 }
 
+double rai::Proxy::distanceLowerBound(const PairCollisionCache& cache) const {
+  rai::Mesh *m1, *m2;
+  double r1, r2;
+  getCollisionMeshes(*this, m1, m2, r1, r2);
+  return cache.distanceLowerBound(*m1, *m2, a->ensure_X(), b->ensure_X()) - r1 - r2;
+}
+
 typedef rai::Array<rai::Proxy*> ProxyL;
 
 void rai::Proxy::glDraw(OpenGL& gl) {
@@ -35,7 +35,8 @@ struct Proxy : GLDrawer {
 
   void copy(const Configuration& C, const Proxy& p);
   void ensure_coll() { if(!collision) calc_coll(); }
-  void calc_coll();
+  void calc_coll(PairCollisionCache* cache=nullptr);
+  double distanceLowerBound(const PairCollisionCache& cache) const; ///< lower bound of d from the last query in cache (w/o computing the collision)
   virtual void glDraw(OpenGL&);
   void write(ostream& os, bool brief=true) const;
 };
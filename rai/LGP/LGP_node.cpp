@@ -24,6 +24,7 @@ namespace rai {
 uint COUNT_kin=0;
 uint COUNT_node=0;
 uintA COUNT_opt=consts<uint>(0, BD_max);
+uintA COUNT_cached=consts<uint>(0, BD_max);
 double COUNT_time=0.;
 String OptLGPDataPath;
 
@@ -68,6 +69,7 @@ void LGP_Node::resetData() {
   feasible = consts<byte>(true, L);
   problem.resize(L);
   computeTime = zeros(L);
+  fromCache = consts<byte>(false, L);
   highestBound=0.;
 }
 
@@ -129,6 +131,16 @@ void LGP_Node::expand(int verbose) {
 }
 
 void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
+  if(!optBound_prepare(bound, collisions, verbose)) return;
+  bool success = optBound_run(bound);
+  if(success && !fromCache(bound)) {
+    COUNT_kin += problem(bound).komo->pathConfig.setJointStateCount;
+    COUNT_time += problem(bound).komo->timeTotal;
+  }
+  optBound_finish(bound, success);
+}
+
+bool LGP_Node::optBound_prepare(BoundType bound, bool collisions, int verbose) {
   if(tree.filComputes) (*tree.filComputes) <<id <<'-' <<step <<'-' <<bound <<endl;
   ensure_skeleton();
   skeleton->setConfiguration(tree.kin);
@@ -149,7 +161,7 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
     if(tree.filComputes) (*tree.filComputes) <<"SKELETON->KOMO CRASHED:" <<*skeleton <<endl;
     feasible(bound) = false;
     labelInfeasible();
-    return;
+    return false;
   }
 #else
   if(komoProblem(bound)) komoProblem(bound).reset();
@@ -165,6 +177,22 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
   shared_ptr<KOMO>& komo = problem(bound).komo;
   komo->opt.verbose = rai::MAX(verbose, 0);
 
+  //-- answer exact duplicates from the cache; otherwise warm start from the ancestors' solutions
+  fromCache(bound) = false;
+  if(tree.useBoundCache) {
+    LGP_BoundCacheEntry* e = tree.findBound(*skeleton, bound);
+    if(e && e->x.N==komo->x.N) {
+      komo->x = e->x;
+      komo->dual = e->dual;
+      komo->set_x(komo->x);
+      komo->sos = e->sos;  komo->eq = e->eq;  komo->ineq = e->ineq;
+      fromCache(bound) = true;
+      return true;
+    }
+    //BD_pose shifts the phases to its short horizon; BD_seqPath is initialized from BD_seq already
+    if(bound==BD_seq) warmStart(bound);
+  }
+
   //-- verbosity...
   if(tree.verbose>1){
     if(komo->opt.verbose>0) {
@@ -194,7 +222,33 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
     if(komo->opt.verbose>5) komo->opt.animateOptimization = komo->opt.verbose-5;
   }
 
-  //-- optimize
+  return true;
+}
+
+void LGP_Node::warmStart(BoundType bound) {
+  KOMO& komo = *problem(bound).komo;
+  for(LGP_Node* a=parent; a; a=a->parent) {
+    a->ensure_skeleton();
+    LGP_BoundCacheEntry* e = tree.findBound(*a->skeleton, bound, skeleton->collisions);
+    if(!e) continue;
+    //the ancestor's skeleton is a prefix -- copy the time slices of the shared phases (as long as the DOFs agree);
+    //the remaining slices keep komo's own (bound clipped) initialization
+    komo.set_x(komo.x);
+    uint t=0;
+    for(; t<e->path.N && t<komo.T; t++) {
+      if(e->path(t).N!=komo.getConfiguration_qAll(t).N) break;
+      komo.setConfiguration_qAll(t, e->path(t));
+    }
+    if(t) {
+      komo.x = komo.pathConfig.getJointState();
+      return;
+    }
+  }
+}
+
+bool LGP_Node::optBound_run(BoundType bound) {
+  if(fromCache(bound)) return true;
+  shared_ptr<KOMO>& komo = problem(bound).komo;
   try {
     komo->run();
 
@@ -205,20 +259,32 @@ void LGP_Node::optBound(BoundType bound, bool collisions, int verbose) {
 
   } catch(std::runtime_error& err) {
     cout <<"KOMO CRASHED: " <<err.what() <<endl;
+    return false;
+  }
+  return true;
+}
+
+void LGP_Node::optBound_finish(BoundType bound, bool success) {
+  if(!success) {
     if(tree.filComputes) (*tree.filComputes) <<"KOMO CRASHED"<<endl;
     problem(bound).komo.reset();
     feasible(bound) = false;
     labelInfeasible();
     return;
   }
-  COUNT_kin += Configuration::setJointStateCount;
-  COUNT_opt(bound)++;
-  COUNT_time += komo->timeTotal;
+
+  shared_ptr<KOMO>& komo = problem(bound).komo;
   count(bound)++;
+  if(fromCache(bound)) {
+    COUNT_cached(bound)++;
+  } else {
+    COUNT_opt(bound)++;
+    if(tree.useBoundCache) tree.storeBound(*skeleton, bound, *komo);
 
-  DEBUG(komo->getReport(false, 1, FILE("z.problem")););
-  Graph result = komo->getReport((komo->opt.verbose>0 && bound>=2));
-  DEBUG(FILE("z.problem.cost") <<result;);
+    DEBUG(komo->getReport(false, 1, FILE("z.problem")););
+    Graph result = komo->getReport((komo->opt.verbose>0 && bound>=2));
+    DEBUG(FILE("z.problem.cost") <<result;);
+  }
 //  cout <<komo->getCollisionPairs() <<endl;
 
   double cost_here = komo->sos;
@@ -472,11 +538,13 @@ void LGP_Node::getGraph(Graph& G, Node* n, bool brief) {
   }
 
   if(!brief) {
-    n->key <<STRING("\ns:" <<step <<" t:" <<time <<" bound:" <<highestBound <<" feas:" <<!isInfeasible <<" term:" <<isTerminal <<' ' <<folState->isNodeOfGraph->key);
+    String key = n->key;
+    key <<STRING("\ns:" <<step <<" t:" <<time <<" bound:" <<highestBound <<" feas:" <<!isInfeasible <<" term:" <<isTerminal <<' ' <<folState->isNodeOfGraph->key);
     for(uint l=0; l<L; l++) if(count(l))
-      n->key <<STRING('\n' <<Enum<BoundType>::name(l) <<" #:" <<count(l) <<" c:" <<cost(l) <<"|" <<constraints(l) <<" " <<(feasible(l)?'1':'0') <<" time:" <<computeTime(l));
-    if(folAddToState) n->key <<STRING("\nsymAdd:" <<*folAddToState);
-    if(note.N) n->key <<'\n' <<note;
+      key <<STRING('\n' <<Enum<BoundType>::name(l) <<" #:" <<count(l) <<" c:" <<cost(l) <<"|" <<constraints(l) <<" " <<(feasible(l)?'1':'0') <<" time:" <<computeTime(l));
+    if(folAddToState) key <<STRING("\nsymAdd:" <<*folAddToState);
+    if(note.N) key <<'\n' <<note;
+    n->setKey(key);
   }
 
   G.getRenderingInfo(n).dotstyle="shape=box";
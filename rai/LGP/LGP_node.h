@@ -21,7 +21,7 @@ struct LGP_Tree;
 typedef Array<LGP_Node*> LGP_NodeL;
 
 extern uint COUNT_kin, COUNT_node;
-extern uintA COUNT_opt;
+extern uintA COUNT_opt, COUNT_cached;
 extern double COUNT_time;
 extern String OptLGPDataPath;
 
@@ -67,6 +67,7 @@ struct LGP_Node {
   boolA feasible;   ///< feasibility for each level
   uintA count;      ///< how often was this level evaluated
   arr computeTime;  ///< computation times for each level
+  boolA fromCache;  ///< whether the level's problem was answered from tree.boundCache (and not solved)
   double highestBound=0.;
 
   // display helpers
@@ -83,6 +84,10 @@ struct LGP_Node {
   //- computations on the node
   void expand(int verbose=0);           ///< expand this node (symbolically: compute possible decisions and add their effect nodes)
   void optBound(BoundType bound, bool collisions=false, int verbose=-1);
+  //-- optBound in three phases, so that the KOMO problems of several nodes can be solved concurrently:
+  bool optBound_prepare(BoundType bound, bool collisions=false, int verbose=-1); ///< creates the KOMO problem (touches the tree -- serial); false if that failed
+  bool optBound_run(BoundType bound);    ///< solves the KOMO problem (touches only problem(bound) -- thread safe); false if it crashed
+  void optBound_finish(BoundType bound, bool success); ///< updates the bounds, counts, and infeasibility labels (touches the tree -- serial)
   void resetData();
 
   //-- helpers to get other nodes
@@ -97,6 +102,7 @@ struct LGP_Node {
   void ensure_skeleton();
 
 private:
+  void warmStart(BoundType bound); ///< initializes problem(bound) with the cached solution of the closest ancestor
   void setInfeasible(); ///< set this and all children infeasible
   void labelInfeasible(); ///< sets this infeasible AND propagates this label up-down to others
   LGP_Node* treePolicy_random(); ///< returns leave -- by descending children randomly
@@ -116,6 +116,10 @@ LGP_Tree::LGP_Tree()
   : verbose(1), numSteps(0) {
   collisions = getParameter<bool>("LGP/collisions", true);
   displayTree = getParameter<bool>("LGP/displayTree", false);
+  parallelBounds = getParameter<uint>("LGP/parallelBounds", 0);
+  useBoundCache = getParameter<bool>("LGP/boundCache", true);
+  pruneTranspositions = getParameter<bool>("LGP/pruneTranspositions", false);
+  transpositions.maxSize = getParameter<uint>("LGP/transpositionsMax", transpositions.maxSize);
 
   verbose = getParameter<double>("LGP/verbose", 1);
   if(verbose>1) fil.open(dataPath + "optLGP.dat"); //STRING("z.optLGP." <<rai::date() <<".dat"));
@@ -456,19 +460,20 @@ bool LGP_Tree::execChoice(String& cmd) {
   return true;
 }
 
-LGP_Node* LGP_Tree::getBest(LGP_NodeL& fringe, uint level) {
+LGP_Node* LGP_Tree::getBest(LGP_NodeL& fringe, uint level, const LGP_NodeL* skip) {
   if(!fringe.N) return nullptr;
   LGP_Node* best=nullptr;
   for(LGP_Node* n:fringe) {
     if(n->isInfeasible || !n->count(level)) continue;
+    if(skip && skip->contains(n)) continue;
     if(!best || (n->feasible(level) && n->cost(level)<best->cost(level))) best=n;
   }
   return best;
 }
 
-LGP_Node* LGP_Tree::popBest(LGP_NodeL& fringe, uint level) {
+LGP_Node* LGP_Tree::popBest(LGP_NodeL& fringe, uint level, const LGP_NodeL* skip) {
   if(!fringe.N) return nullptr;
-  LGP_Node* best=getBest(fringe, level);
+  LGP_Node* best=getBest(fringe, level, skip);
   if(!best) return nullptr;
   fringe.removeValue(best);
   return best;
@@ -487,6 +492,8 @@ LGP_Node* LGP_Tree::expandNext(int stopOnDepth, LGP_NodeL* addIfTerminal) { //ex
       terminals.append(ch);
       LGP_NodeL path = ch->getTreePath();
       for(LGP_Node* n:path) if(!n->count(1)) fringe_poseToGoal.setAppend(n); //pose2 is a FIFO
+    } else if(pruneTranspositions && isTransposition(ch)) {
+      ch->note <<"TRANSPOSITION ";
     } else {
       fringe_expand.append(ch);
     }
@@ -496,6 +503,14 @@ LGP_Node* LGP_Tree::expandNext(int stopOnDepth, LGP_NodeL* addIfTerminal) { //ex
   return n;
 }
 
+bool LGP_Tree::isTransposition(LGP_Node* n) {
+  auto state = make_shared<FOL_World::CompactState>(fol.encodeState(*n->folState));
+  LGP_Node** known = transpositions.find(state);
+  if(known && (*known)->cost(BD_symbolic)<=n->cost(BD_symbolic)) return true;
+  transpositions.set(state, n);
+  return false;
+}
+
 void LGP_Tree::optBestOnLevel(BoundType bound, LGP_NodeL& drawFringe, BoundType drawFrom, LGP_NodeL* addIfTerminal, LGP_NodeL* addChildren) { //optimize a seq
   if(!drawFringe.N) return;
   LGP_Node* n = popBest(drawFringe, drawFrom);
@@ -535,6 +550,101 @@ void LGP_Tree::optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_NodeL* ad
   }
 }
 
+/// solves up to maxJobs bound problems on parallelBounds threads: the three levels of step() (pose, seq, seqPath)
+/// take turns in drawing the next node from their fringe (first, or best as in optBestOnLevel); each result is
+/// fed back into the tree (and the fringes) as soon as its solve finished, under a lock which also guards drawing
+/// and creating the KOMO problems -- only the solves run concurrently; workers that find nothing to draw wait
+/// for running solves to finish (which may feed the fringes) and only return when none is left
+void LGP_Tree::optBoundsParallel(uint maxJobs) {
+  struct Level { BoundType bound; LGP_NodeL& fringe; int drawFrom; LGP_NodeL& addIfTerminal; };
+  Level levels[3] = {{BD_pose, fringe_poseToGoal, -1, fringe_seq},
+                     {BD_seq, fringe_seq, BD_pose, fringe_path},
+                     {BD_seqPath, fringe_path, BD_seq, fringe_solved}};
+  uint nextLevel=0, jobs=0;
+  LGP_NodeL running;
+  Mutex treeMutex;
+  std::condition_variable solveFinished;
+
+  //-- draw the next node (tree must be locked)
+  auto drawNext = [&](LGP_Node*& n, Level*& level) -> bool {
+    for(uint k=0; k<3; k++) {
+      Level& l = levels[(nextLevel+k)%3];
+      for(;;) {
+        n=nullptr;
+        if(l.drawFrom<0) { //first in fringe whose parent is not pending -- running or still queued (the pose bound adds the parent's cost)
+          for(LGP_Node* m:l.fringe) if(!(m->parent && (running.contains(m->parent) || l.fringe.contains(m->parent)))) { n=m; break; }
+          if(n) l.fringe.removeValue(n);
+        } else {
+          n = popBest(l.fringe, l.drawFrom, &running);
+        }
+        if(!n) break;
+        if(n->count(l.bound)) continue; //already computed
+        nextLevel = (nextLevel+k+1)%3;
+        level = &l;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  if(!boundPool || boundPool->nWorkers()!=parallelBounds) boundPool = make_shared<WorkerPool>(parallelBounds);
+  double time = -realTime();
+  boundPool->run(boundPool->nWorkers(), [&](uint, uint) {
+    for(;;) {
+      LGP_Node* n;
+      Level* level;
+      {
+        auto lock = treeMutex(RAI_HERE);
+        for(;;) {
+          if(jobs>=maxJobs) return;
+          if(!drawNext(n, level)) {
+            if(!running.N) return;
+            solveFinished.wait(lock);
+            continue;
+          }
+          jobs++;
+          if(n->optBound_prepare(level->bound, collisions, verbose-2)) break;
+        }
+        //the problem's configurations reference the collision engines of kin -- give it its own
+        shared_ptr<KOMO>& komo = n->problem(level->bound).komo;
+        if(!n->fromCache(level->bound)) komo->unshareCollisionEngines();
+        running.append(n);
+      }
+
+      bool success = n->optBound_run(level->bound);
+
+      {
+        auto lock = treeMutex(RAI_HERE);
+        running.removeValue(n);
+        if(success && !n->fromCache(level->bound)) COUNT_kin += n->problem(level->bound).komo->pathConfig.setJointStateCount;
+        n->optBound_finish(level->bound, success);
+        if(n->feasible(level->bound) && n->isTerminal) level->addIfTerminal.append(n);
+        focusNode = n;
+      }
+      solveFinished.notify_all();
+    }
+  });
+  COUNT_time += time+realTime(); //the cpuTime of the individual solves sums over all threads
+}
+
+LGP_BoundCacheEntry* LGP_Tree::findBound(const Skeleton& S, BoundType bound, int collisions) {
+  if(collisions<0) collisions = S.collisions;
+  auto it = boundCache.find({S.getHash(), bound, (bool)collisions});
+  if(it==boundCache.end()) return nullptr;
+  LGP_BoundCacheEntry& e = it->second;
+  if(!(e.S==S.S)) return nullptr;
+  return &e;
+}
+
+void LGP_Tree::storeBound(const Skeleton& S, BoundType bound, KOMO& komo) {
+  LGP_BoundCacheEntry& e = boundCache[{S.getHash(), bound, S.collisions}];
+  e.S = S.S;
+  e.x = komo.x;
+  e.dual = komo.dual;
+  e.path = komo.getPath_qAll();
+  e.sos = komo.sos;  e.eq = komo.eq;  e.ineq = komo.ineq;
+}
+
 void LGP_Tree::clearFromInfeasibles(LGP_NodeL& fringe) {
   for(uint i=fringe.N; i--;)
     if(fringe.elem(i)->isInfeasible) fringe.remove(i);
@@ -550,6 +660,7 @@ String LGP_Tree::report(bool detailed) {
   String out;
   out <<"TIME= " <<cpuTime() <<" TIME= " <<COUNT_time <<" KIN= " <<COUNT_kin << " TREE= " <<COUNT_node
       <<" POSE= " <<COUNT_opt(BD_pose) <<" SEQ= " <<COUNT_opt(BD_seq) <<" PATH= " <<COUNT_opt(BD_path)+COUNT_opt(BD_seqPath)
+      <<" CACHED= " <<sum(COUNT_cached)
       <<" bestPose= " <<(bpose?bpose->cost(1):100.)
       <<" bestSeq= " <<(bseq ?bseq ->cost(2):100.)
       <<" bestPath= " <<(bpath?bpath->cost(displayBound):100.)
@@ -571,17 +682,21 @@ void LGP_Tree::step() {
 
   uint numSol = fringe_solved.N;
 
-//  if(rnd.uni()<.5) optBestOnLevel(BD_pose, fringe_pose, BD_symbolic, &fringe_seq, &fringe_pose);
-  optFirstOnLevel(BD_pose, fringe_poseToGoal, &fringe_seq);
-  optBestOnLevel(BD_seq, fringe_seq, BD_pose, &fringe_path, nullptr);
-  if(verbose>0 && fringe_path.N) cout <<"EVALUATING PATH " <<fringe_path.last()->getTreePathString() <<endl;
-  optBestOnLevel(BD_seqPath, fringe_path, BD_seq, &fringe_solved, nullptr);
+  if(parallelBounds>1) {
+    optBoundsParallel(3*parallelBounds); //as many bounds per worker as the serial step computes
+  } else {
+//    if(rnd.uni()<.5) optBestOnLevel(BD_pose, fringe_pose, BD_symbolic, &fringe_seq, &fringe_pose);
+    optFirstOnLevel(BD_pose, fringe_poseToGoal, &fringe_seq);
+    optBestOnLevel(BD_seq, fringe_seq, BD_pose, &fringe_path, nullptr);
+    if(verbose>0 && fringe_path.N) cout <<"EVALUATING PATH " <<fringe_path.last()->getTreePathString() <<endl;
+    optBestOnLevel(BD_seqPath, fringe_path, BD_seq, &fringe_solved, nullptr);
+  }
 
-  if(fringe_solved.N>numSol) {
-    if(verbose>0) cout <<"NEW SOLUTION FOUND! " <<fringe_solved.last()->getTreePathString() <<endl;
-    solutions.set()->append(new LGP_Tree_SolutionData(*this, fringe_solved.last()));
-    solutions.set()->sort(sortComp2);
+  for(uint i=numSol; i<fringe_solved.N; i++) {
+    if(verbose>0) cout <<"NEW SOLUTION FOUND! " <<fringe_solved(i)->getTreePathString() <<endl;
+    solutions.set()->append(new LGP_Tree_SolutionData(*this, fringe_solved(i)));
   }
+  if(fringe_solved.N>numSol) solutions.set()->sort(sortComp2);
 
   //-- update queues (if something got infeasible)
   clearFromInfeasibles(fringe_expand);
@@ -609,6 +724,7 @@ void LGP_Tree::buildTree(uint depth) {
 
   timerRead(true);
   for(uint k=0;; k++) {
+    if(!fringe_expand.N) break; //with pruned transpositions the tree can be exhausted before the depth
     LGP_Node* b = expandNext(depth);
     if(!b) break;
   }
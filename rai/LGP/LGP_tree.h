@@ -11,6 +11,9 @@
 #include "LGP_node.h"
 #include "../Core/thread.h"
 
+#include <map>
+#include <tuple>
+
 struct KinPathViewer;
 
 namespace rai {
@@ -36,6 +39,14 @@ struct LGP_Tree_SolutionData : GLDrawer {
   void glDraw(struct OpenGL& gl);
 };
 
+/// a solved bound problem, cached by skeleton (see LGP_Tree::boundCache)
+struct LGP_BoundCacheEntry {
+  Array<SkeletonEntry> S; ///< the skeleton (to exclude hash collisions)
+  arr x, dual;            ///< the solution
+  arrA path;              ///< the solution as joint states per time slice (for warm starts of longer skeletons)
+  double sos, eq, ineq;
+};
+
 struct LGP_Tree : GLDrawer {
   LGP_Node* root=0, *focusNode=0;
   FOL_World fol;
@@ -49,6 +60,12 @@ struct LGP_Tree : GLDrawer {
   bool displayTree=true;
   BoundType displayBound=BD_seqPath;
   bool collisions=false;
+  uint parallelBounds=0; ///< number of threads solving bound problems of different nodes concurrently (<=1: serial)
+  shared_ptr<WorkerPool> boundPool;
+  bool useBoundCache=true; ///< answer bound problems of equal skeletons from the cache, and warm start BD_seq from the ancestors' solutions
+  std::map<std::tuple<uint64_t, int, bool>, LGP_BoundCacheEntry> boundCache; ///< solved problems by (skeleton hash, bound, collisions); assumes kin is not changed
+  bool pruneTranspositions=false; ///< do not expand nodes whose symbolic state was reached before at lower symbolic cost (this drops their geometric alternatives)
+  TranspositionTable<LGP_Node*> transpositions; ///< expanded-into nodes by compact symbolic state
   shared_ptr<DisplayThread> dth;
   shared_ptr<ConfigurationViewer> singleView;
   String dataPath;
@@ -79,12 +96,14 @@ struct LGP_Tree : GLDrawer {
 
   //-- methods called in the run loop
  private:
-  LGP_Node* getBest(LGP_NodeL& fringe, uint level);
-  LGP_Node* popBest(LGP_NodeL& fringe, uint level);
+  LGP_Node* getBest(LGP_NodeL& fringe, uint level, const LGP_NodeL* skip=nullptr);
+  LGP_Node* popBest(LGP_NodeL& fringe, uint level, const LGP_NodeL* skip=nullptr);
   LGP_Node* expandNext(int stopOnLevel=-1, LGP_NodeL* addIfTerminal=nullptr);
+  bool isTransposition(LGP_Node* n); ///< whether n's symbolic state is known from a node of lower or equal symbolic cost (otherwise n is stored)
 
   void optBestOnLevel(BoundType bound, LGP_NodeL& drawFringe, BoundType drawBound, LGP_NodeL* addIfTerminal, LGP_NodeL* addChildren);
   void optFirstOnLevel(BoundType bound, LGP_NodeL& fringe, LGP_NodeL* addIfTerminal);
+  void optBoundsParallel(uint maxJobs);
   void clearFromInfeasibles(LGP_NodeL& fringe);
 
  public:
@@ -96,6 +115,10 @@ struct LGP_Tree : GLDrawer {
   void optFixedSequence(const String& seq, BoundType specificBound=BD_all, bool collisions=false);
   void optMultiple(const StringA& seqs);
 
+  //-- bound cache
+  LGP_BoundCacheEntry* findBound(const Skeleton& S, BoundType bound, int collisions=-1); ///< nullptr if not cached (collisions<0: as S.collisions)
+  void storeBound(const Skeleton& S, BoundType bound, KOMO& komo);
+
   //-- work directly on the tree
   LGP_Node* walkToNode(const String& seq);
 
@@ -8,6 +8,9 @@
 
 #include "fol.h"
 
+#include <algorithm>
+#include <unordered_set>
+
 #define DEBUG(x) //x
 
 namespace rai {
@@ -80,6 +83,69 @@ Node* getFirstVariable(Node* literal, Graph* varScope) {
   return nullptr;
 }
 
+//===========================================================================
+
+FactIndex& getFactIndex(Graph& KB) {
+  for(GraphEditCallback* cb:KB.callbacks) {
+    FactIndex* idx = dynamic_cast<FactIndex*>(cb);
+    if(idx) return *idx;
+  }
+  FactIndex* idx = new FactIndex(KB);
+  for(Node* n:KB) idx->cb_new(n);
+  KB.callbacks.append(idx);
+  return *idx;
+}
+
+void FactIndex::update() {
+  for(Node* fact:pending) if(fact) {
+    for(uint i=0; i<fact->parents.N; i++) {
+      Array<NodeL>& lists = args[fact->parents.elem(i)];
+      if(lists.N<=i) lists.resizeCopy(i+1);
+      lists.elem(i).append(fact);
+    }
+  }
+  pending.clear();
+  pendingPos.clear();
+}
+
+void FactIndex::clear() {
+  args.clear();
+  pending.clear();
+  pendingPos.clear();
+}
+
+void FactIndex::cb_delete(Node* fact) {
+  auto pos = pendingPos.find(fact);
+  if(pos!=pendingPos.end()) { pending.elem(pos->second)=nullptr; pendingPos.erase(pos); return; }
+  for(uint i=0; i<fact->parents.N; i++) {
+    auto it = args.find(fact->parents.elem(i));
+    if(it==args.end() || it->second.N<=i) continue; //e.g. after clear()
+    NodeL& L = it->second.elem(i);
+    if(L.N && L.elem(-1)==fact) L.resizeCopy(L.N-1); else L.removeValue(fact, false);
+  }
+}
+
+const NodeL& FactIndex::candidates(Node* literal, const NodeL& subst, const Graph* subst_scope) {
+  static const NodeL none;
+  update();
+  const NodeL* best=nullptr;
+  for(uint i=0; i<literal->parents.N; i++) {
+    Node* arg = literal->parents.elem(i);
+    if(&arg->container==subst_scope) { //a variable: bound only if substituted
+      if(&subst==&NoNodeL || arg->index>=subst.N || !subst.elem(arg->index)) continue;
+      arg = subst.elem(arg->index);
+    } else if(arg->key=="ANY") continue;
+    auto it = args.find(arg);
+    if(it==args.end() || it->second.N<=i || !it->second.elem(i).N) return none;
+    const NodeL& L = it->second.elem(i);
+    if(!best || L.N<best->N) best=&L;
+  }
+  if(!best) return KB;
+  return *best;
+}
+
+//===========================================================================
+
 /// check if these are literally equal (all arguments are identical, be they vars or consts) -- fact1 is only a tuple, not an node of the graph
 bool tuplesAreEqual(NodeL& tuple0, NodeL& tuple1) {
   if(tuple0.N!=tuple1.N) return false;
@@ -138,14 +204,7 @@ bool getEqualFactInKB(Graph& KB, Node* fact, bool checkAlsoValue) {
       } else HALT("unknown aggregate mode '" <<graph.last()->key <<"'");
     } else HALT("unknown special literal key'" <<fact->key <<"'");
   }
-#if 0
-  //first find the section of all facts that derive from the same symbols
-  NodeL candidates=fact->parents(0)->children;
-  for(uint p=1; p<fact->parents.N; p++)
-    candidates = setSection(candidates, fact->parents(p)->children);
-#else
-  NodeL& candidates = KB;
-#endif
+  const NodeL& candidates = getFactIndex(KB).candidates(fact);
   //now check only these candidates
   for(Node* fact1:candidates) if(&fact1->container==&KB && fact1!=fact) {
       if(factsAreEqual(fact, fact1, checkAlsoValue)) return true;
@@ -176,13 +235,7 @@ Node* getEqualFactInList(Node* fact, NodeL& facts, bool checkAlsoValue) {
 
 /// check if subst is a feasible substitution for a literal (by checking with all facts that have same predicate)
 bool getEqualFactInKB(Graph& KB, Node* literal, const NodeL& subst, const Graph* subst_scope, bool checkAlsoValue) {
-#if 0
-  //TODO: this should construct the tuple, call the above method, then additionally checkForValue -> write a method that checks value only
-  NodeL candidates = literal->parents(0)->children;
-  NodeL candidates = getLiteralsOfScope(KB);
-#else
-  NodeL& candidates = KB;
-#endif
+  const NodeL& candidates = getFactIndex(KB).candidates(literal, subst, subst_scope);
   for(Node* fact:candidates) if(&fact->container==&KB && fact!=literal) {
       if(factsAreEqual(fact, literal, subst, subst_scope, checkAlsoValue)) return true;
     }
@@ -191,19 +244,7 @@ bool getEqualFactInKB(Graph& KB, Node* literal, const NodeL& subst, const Graph*
 
 /// find, modulo ignoring variables (i.e., for all possible subst), all facts that match the tuple (from those, possible substitutions can be found)
 NodeL getPotentiallyEqualFactsInKB(Graph& KB, Node* tuple, const Graph& varScope, bool checkAlsoValue) {
-#if 0
-  Node* rarestSymbol=nullptr;
-  uint rarestSymbolN=0;
-  for(Node* sym:tuple->parents) if(&sym->container!=&varScope) { //loop through all grounded symbols, not variables
-      if(!rarestSymbol || sym->children.N<rarestSymbolN) {
-        rarestSymbol = sym;
-        rarestSymbolN = sym->children.N;
-      }
-    }
-  const NodeL& candidates = rarestSymbol->children;//that totally doesn't scale!!!
-#else
-  const NodeL& candidates = KB;
-#endif
+  const NodeL& candidates = getFactIndex(KB).candidates(tuple, NoNodeL, &varScope);
   NodeL matches;
   for(Node* fact:candidates) if(&fact->container==&KB && fact!=tuple) {
       if(factsAreEqual(fact, tuple, NoNodeL, &varScope, checkAlsoValue, true))
@@ -245,7 +286,7 @@ void removeInfeasibleSymbolsFromDomain(Graph& facts, NodeL& domain, Node* litera
 
   NodeL dom;
   dom.reserveMEM(domain.N);
-  for(Node* fact:facts) { //for(Node *fact:predicate->children) if(&fact->container==&facts){
+  for(Node* fact:getFactIndex(facts).candidates(literal, NoNodeL, varScope)) {
     //-- check that all arguments are the same, except for var!
     bool match=true;
     Node* value=nullptr;
@@ -272,11 +313,11 @@ void removeInfeasibleSymbolsFromDomain(Graph& facts, NodeL& domain, Node* litera
   }
 
   //for a negative boolean literal, we REMOVE the matches instead of allowing for them
-  if(literal->isBoolAndFalse()) {
-    setMinus(domain, dom);
-  } else {
-    domain = setSection(domain, dom);
-  }
+  std::unordered_set<Node*> inDom(dom.begin(), dom.end());
+  bool remove = literal->isBoolAndFalse();
+  uint j=0;
+  for(Node* value:domain) if(!inDom.count(value)==remove) domain.elem(j++)=value;
+  domain.resizeCopy(j);
 }
 
 /// directly create a new fact
@@ -317,7 +358,7 @@ bool applySubstitutedLiteral(Graph& facts, Node* literal, const NodeL& subst, Gr
 
   //first collect tuple matches
   NodeL matches;
-  for(Node* fact:facts) { //for(Node *fact:literal->parents(0)->children) if(&fact->container==&facts){
+  for(Node* fact:getFactIndex(facts).candidates(literal, subst, subst_scope)) {
     if(factsAreEqual(fact, literal, subst, subst_scope, false)) matches.append(fact);
   }
 
@@ -386,6 +427,116 @@ bool substitutedRulePreconditionHolds(Graph& KB, Node* rule, const NodeL& subst,
   return holds;
 }
 
+/// the variable assignment of getSubstitutions2 as an indexed join: variables are assigned in a fixed order (most
+/// constrained first); values are generated from the facts matching a positive constraint whose other variables are
+/// assigned (if there is one), else taken from the domain; every constraint is checked once all its variables are assigned
+struct SubstitutionJoin {
+  Graph& KB;
+  Graph& varScope;
+  const Array<NodeL>& domainOf;
+  int verbose;
+  uintA order;       ///< variables in order of assignment
+  Array<NodeL> checkAt; ///< constraints to check after assigning order(k)
+  NodeL generatorAt; ///< a positive constraint generating the values of order(k), or nullptr
+  std::vector<std::unordered_map<Node*, uint>> rank; ///< position of a value in domainOf(var)
+  NodeL values;      ///< the current (partial) substitution
+  uintA ranks;       ///< positions of its values in the domains
+  uintA found;       ///< ranks of all feasible substitutions (appended)
+
+  SubstitutionJoin(Graph& KB, Graph& varScope, const NodeL& constraints, const Array<NodeL>& domainOf, int verbose)
+    : KB(KB), varScope(varScope), domainOf(domainOf), verbose(verbose) {
+    uint n=domainOf.N;
+    values.resize(n).setZero();
+    ranks.resize(n).setZero();
+    rank.resize(n);
+    for(uint i=0; i<n; i++) for(uint r=0; r<domainOf(i).N; r++) rank[i][domainOf(i).elem(r)]=r;
+
+    //-- variables of each constraint
+    Array<uintA> varsOf(constraints.N);
+    for(uint c=0; c<constraints.N; c++) for(Node* var:getVariables(constraints(c), &varScope)) varsOf(c).setAppend(var->index);
+
+    //-- greedy order: most constraints with assigned variables first, then smallest domain
+    boolA assigned(n);
+    assigned = false;
+    for(uint k=0; k<n; k++) {
+      int best=-1;
+      uint bestLinks=0;
+      for(uint i=0; i<n; i++) if(!assigned(i)) {
+          uint links=0;
+          for(const uintA& V:varsOf) if(V.contains(i)) for(uint j:V) if(assigned(j)) { links++; break; }
+          if(best==-1 || links>bestLinks || (links==bestLinks && domainOf(i).N<domainOf(best).N)) { best=i; bestLinks=links; }
+        }
+      order.append(best);
+      assigned(best)=true;
+    }
+
+    //-- each constraint is checked (and possibly generates values) at the step its last variable is assigned
+    uintA stepOf(n);
+    for(uint k=0; k<n; k++) stepOf(order(k))=k;
+    checkAt.resize(n);
+    generatorAt.resize(n).setZero();
+    for(uint c=0; c<constraints.N; c++) {
+      uint k=0;
+      for(uint i:varsOf(c)) if(stepOf(i)>k) k=stepOf(i);
+      checkAt(k).append(constraints(c));
+      if(!generatorAt(k) && !constraints(c)->isBoolAndFalse()) generatorAt(k)=constraints(c);
+    }
+  }
+
+  /// the values of variable v for which some fact matches literal (with all other variables assigned)
+  void generate(uintA& cand, Node* literal, uint v) {
+    std::unordered_set<Node*> seen;
+    for(Node* fact:getFactIndex(KB).candidates(literal, values, &varScope)) {
+      if(&fact->container!=&KB || fact->parents.N!=literal->parents.N || fact->key!=literal->key) continue;
+      Node* value=nullptr;
+      bool match=true;
+      for(uint i=0; i<fact->parents.N && match; i++) {
+        Node* lit_arg = literal->parents.elem(i);
+        Node* fact_arg = fact->parents.elem(i);
+        if(lit_arg->key=="ANY") continue;
+        if(&lit_arg->container==&varScope) {
+          if(lit_arg->index==v) { if(value && value!=fact_arg) match=false; value=fact_arg; }
+          else if(values(lit_arg->index)!=fact_arg) match=false;
+        } else if(lit_arg!=fact_arg) match=false;
+      }
+      if(!match || !value || !valuesAreEqual(fact, literal, true) || !seen.insert(value).second) continue;
+      auto r = rank[v].find(value);
+      if(r!=rank[v].end()) cand.append(r->second);
+    }
+  }
+
+  void search(uint k) {
+    if(k==order.N) {
+      if(verbose>3) { cout <<"adding feasible substitution "; rai::listWrite(values, cout); cout <<endl; }
+      found.append(ranks);
+      return;
+    }
+    uint v=order(k);
+    uintA cand;
+    if(generatorAt(k)) generate(cand, generatorAt(k), v);
+    else cand.setStraightPerm(domainOf(v).N);
+    for(uint r:cand) {
+      Node* value = domainOf(v).elem(r);
+      bool feasible=true;
+      for(uint j=0; j<k && feasible; j++) if(values(order(j))==value) feasible=false; //only allow for disjoint assignments
+      if(!feasible) continue;
+      values(v)=value;
+      ranks(v)=r;
+      for(Node* literal:checkAt(k)) {
+        if(literal->isBoolAndFalse()) { //deal differently with false literals
+          feasible = !getEqualFactInKB(KB, literal, values, &varScope, false); //check match ignoring value
+        } else { //normal
+          feasible = getEqualFactInKB(KB, literal, values, &varScope);
+        }
+        if(verbose>3) { cout <<"checking literal '" <<*literal <<"' with args "; rai::listWrite(values, cout); cout <<(feasible?" -- good":" -- failed") <<endl; }
+        if(!feasible) break;
+      }
+      if(feasible) search(k+1);
+    }
+    values(v)=nullptr;
+  }
+};
+
 /// the list of literals is a conjunctive clause (e.g. precondition)
 /// all literals must be in the same scope (element of the same subGraph)
 /// we return all feasible substitutions of the literal's variables by constants
@@ -430,11 +581,13 @@ NodeL getSubstitutions2(Graph& KB, NodeL& relations, int verbose) {
   Array<NodeL> domainOf(vars.N);
   Array<unsigned char> domainIsConstrained(vars.N);
   Array<NodeL> domainsForThisRel(vars.N);
+  std::vector<std::unordered_set<Node*>> inDomainForThisRel(vars.N);
   if(vars.N) domainIsConstrained = false;
 
   for(Node* rel:relations) if(nFreeVars(rel->index)>0) { //first go through all (non-negated) relations...
       if(!rel->isOfType<bool>() || rel->get<bool>()==true) { //normal (not negated boolean)
         for(auto& d:domainsForThisRel) d.clear();
+        for(auto& d:inDomainForThisRel) d.clear();
         NodeL matches = getPotentiallyEqualFactsInKB(KB, rel, varScope, true);
         if(!matches.N) {
           if(verbose>1) cout <<"Relation " <<*rel <<" has no match -> no subst" <<endl;
@@ -444,7 +597,10 @@ NodeL getSubstitutions2(Graph& KB, NodeL& relations, int verbose) {
           Node* var = rel->parents(i);
           if(&var->container==&varScope) { //this is a var
             CHECK(var->index<vars.N, "relation '" <<*rel <<"' has variable '" <<var->key <<"' that is not in the scope");
-            for(Node* m:matches) domainsForThisRel(var->index).setAppend(m->parents(i)); //setAppend not necessary
+            for(Node* m:matches) {
+              Node* value = m->parents(i);
+              if(inDomainForThisRel[var->index].insert(value).second) domainsForThisRel(var->index).append(value);
+            }
           }
         }
         if(verbose>3) {
@@ -455,7 +611,10 @@ NodeL getSubstitutions2(Graph& KB, NodeL& relations, int verbose) {
         }
         for(uint i=0; i<vars.N; i++) if(domainsForThisRel(i).N) {
             if(domainIsConstrained(i)) {
-              domainOf(i) = setSection(domainOf(i), domainsForThisRel(i));
+              NodeL& dom = domainOf(i);
+              uint j=0;
+              for(Node* value:dom) if(inDomainForThisRel[i].count(value)) dom.elem(j++)=value;
+              dom.resizeCopy(j);
             } else {
               domainOf(i) = domainsForThisRel(i);
               domainIsConstrained(i)=true;
@@ -498,49 +657,19 @@ NodeL getSubstitutions2(Graph& KB, NodeL& relations, int verbose) {
 
   if(verbose>2) { cout <<"remaining constraint literals:" <<endl; rai::listWrite(constraints, cout); cout <<endl; }
 
-  //-- naive CSP: loop through everything
-  uint subN=0;
-  NodeL substitutions;
-  NodeL values(vars.N); values.setZero();
-  {
-    //-- using 'getIndexTuple' we can linearly enumerate all configurations of all variables
-    uintA domainN(vars.N);
-    for(uint i=0; i<vars.N; i++) domainN(i) = domainOf(i).N; //collect dims/cardinalities of domains
-    uint configurationsN = product(domainN); //number of all possible configurations
-    for(uint config=0; config<configurationsN; config++) { //loop through all possible configurations
-      uintA valueIndex = getIndexTuple(config, domainN);
-      bool feasible=true;
-      for(uint i=0; i<vars.N; i++) values(vars(i)->index) = domainOf(i)(valueIndex(i)); //assign the configuration
-#if 1 //only allow for disjoint assignments -- DISABLED!?
-      for(uint i=0; i<values.N && feasible; i++) for(uint j=i+1; j<values.N && feasible; j++) {
-        if(values(i)==values(j)) feasible=false;
-      }
-#endif
-      if(!feasible) continue;
-      for(Node* literal:constraints) { //loop through all constraints
-        //         if(literal->parents.N && literal->parents(0)==EQ){ //check equality of subsequent literals
-        //           Node *it1 = literal->container(literal->index+1);
-        //           Node *it2 = literal->container(literal->index+2);
-        //           feasible = matchingFactsAreEqual(facts, it1, it2, values, &varScope);
-        //         }else{
-        if(literal->isBoolAndFalse()) { //deal differently with false literals
-          feasible = getEqualFactInKB(KB, literal, values, &varScope, false); //check match ignoring value
-          feasible = !feasible; //invert result
-        } else { //normal
-          feasible = getEqualFactInKB(KB, literal, values, &varScope);
-        }
-        //         }
-        if(verbose>3) { cout <<"checking literal '" <<*literal <<"' with args "; rai::listWrite(values, cout); cout <<(feasible?" -- good":" -- failed") <<endl; }
-        if(!feasible) break;
-      }
-      if(feasible) {
-        if(verbose>3) { cout <<"adding feasible substitution "; rai::listWrite(values, cout); cout <<endl; }
-        substitutions.append(values);
-        subN++;
-      }
-    }
-  }
-  substitutions.reshape(subN, vars.N);
+  //-- indexed join over the domains, with all variables assigned disjoint values
+  SubstitutionJoin join(KB, varScope, constraints, domainOf, verbose);
+  join.search(0);
+
+  //-- return them in the order of enumerating the domains' product (first variable slowest)
+  uint subN=join.found.N/vars.N;
+  uintA perm(subN);
+  for(uint s=0; s<subN; s++) perm(s)=s;
+  const uint* found=join.found.p;
+  uint n=vars.N;
+  std::sort(perm.p, perm.p+perm.N, [found, n](uint a, uint b) { return std::lexicographical_compare(found+a*n, found+a*n+n, found+b*n, found+b*n+n); });
+  NodeL substitutions(subN, vars.N);
+  for(uint s=0; s<subN; s++) for(uint i=0; i<n; i++) substitutions(s, i) = domainOf(i).elem(found[perm(s)*n+i]);
 
   if(verbose>1) {
     cout <<"POSSIBLE SUBSTITUTIONS: " <<substitutions.d0 <<endl;
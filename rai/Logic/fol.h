@@ -36,6 +36,31 @@ Node* getFirstVariable(Node* literal, Graph* varScope);
 Node* getFirstNonSymbolOfScope(Graph& KB);
 Node* getSecondNonSymbolOfScope(Graph& KB);
 
+//---------- an index of the facts of a KB (e.g. a state)
+
+/// the facts of a KB indexed by argument: for each symbol and argument position (0=predicate) the list of facts, in KB order.
+/// It is attached to its KB via getFactIndex(KB) and updated on fact creation/deletion through Graph::callbacks;
+/// facts must not change their arguments once indexed (new facts are indexed lazily, so substituting them right after creation is fine)
+struct FactIndex : GraphEditCallback {
+  Graph& KB;
+  std::unordered_map<Node*, Array<NodeL>> args; ///< symbol -> per position -> facts
+  NodeL pending; ///< facts created since the last query (nullptr for those deleted meanwhile)
+  std::unordered_map<Node*, uint> pendingPos; ///< fact -> its position in pending
+
+  FactIndex(Graph& _KB) : KB(_KB) {}
+  virtual void cb_new(Node* n) { pendingPos[n]=pending.N; pending.append(n); }
+  virtual void cb_delete(Node* n);
+  virtual void cb_clear() { clear(); }
+  virtual void cb_graphDestruct() { delete this; }
+
+  void clear();
+
+  /// a superset of all KB facts that can match the literal, using all arguments bound by constants or subst (or the whole KB)
+  const NodeL& candidates(Node* literal, const NodeL& subst=NoNodeL, const Graph* subst_scope=nullptr);
+  void update();
+};
+FactIndex& getFactIndex(Graph& KB);
+
 //---------- checking equality of two single facts, or fact and literal, or find facts in a KB that match a fact or literal
 
 bool tuplesAreEqual(NodeL& tuple0, NodeL& tuple1);
@@ -10,6 +10,9 @@
 
 #include "fol.h"
 
+#include <algorithm>
+#include <cstring>
+
 #define DEBUG(x) //x
 
 namespace rai {
@@ -81,8 +84,16 @@ void FOL_World::init(const Graph& _KB) {
     timeCost = params->get<double>("timeCost", timeCost);
     deadEndCost = params->get<double>("deadEndCost", deadEndCost);
     maxHorizon = (uint)params->get<double>("maxHorizon", maxHorizon);
+    compactStates = params->get<bool>("compactStates", compactStates);
   }
 
+  //ids of compact states refer to the nodes of this KB
+  compactSymbols.clear();
+  compactSymbolIds.clear();
+  compactKeys = {""}; //key id 0 is 'no key'
+  compactKeyIds.clear();
+  compactKeyIds[""] = 0;
+
   if(verbose>1) {
     cout <<"****************** FOL_World: creation info:" <<endl;
     cout <<"*** start_state=" <<*start_state <<endl;
@@ -131,10 +142,10 @@ TreeSearchDomain::TransitionReturn FOL_World::transition(const Handle& action) {
     NodeL decisionTuple = {d->rule};
     decisionTuple.append(d->substitution);
     lastDecisionInState = createNewFact(*state, decisionTuple);
-    lastDecisionInState->key = ("decision");
+    lastDecisionInState->setKey("decision");
   } else {
     lastDecisionInState = createNewFact(*state, {Wait_keyword});
-    lastDecisionInState->key = ("decision");
+    lastDecisionInState->setKey("decision");
   }
 
   //-- apply effects of decision
@@ -255,12 +266,27 @@ bool FOL_World::is_feasible_action(const TreeSearchDomain::Handle& action) {
 }
 
 const TreeSearchDomain::Handle FOL_World::get_stateCopy() {
+  if(compactStates) {
+    auto c = std::make_shared<CompactState>(encodeState(*state));
+    c->T_step = T_step;
+    c->T_real = T_real;
+    c->R_total = R_total;
+    return c;
+  }
   return std::make_shared<const State>(createStateCopy(), *this);
 }
 
 void FOL_World::set_state(const TreeSearchDomain::Handle& _state) {
+  if(auto c = std::dynamic_pointer_cast<const CompactState>(_state)) {
+    if(!state) state = &KB.newSubgraph({"STATE"}, {start_state->isNodeOfGraph});
+    decodeState(*state, *c);
+    T_step = c->T_step;
+    T_real = c->T_real;
+    R_total = c->R_total;
+    return;
+  }
   const State* s = std::dynamic_pointer_cast<const State>(_state).get();
-  CHECK(s, "the given handle was not a FOL_World::State handle");
+  CHECK(s, "the given handle was neither a FOL_World::State nor a CompactState handle");
   setState(s->state, s->T_step);
   T_real = s->T_real;
 }
@@ -292,7 +318,7 @@ void FOL_World::make_current_state_new_start() {
   if(!start_state) start_state = &KB.newSubgraph({"START_STATE"}, state->isNodeOfGraph->parents);
   state->index();
   start_state->copy(*state);
-  start_state->isNodeOfGraph->key="START_STATE";
+  start_state->isNodeOfGraph->setKey("START_STATE");
   start_T_step = T_step;
   start_T_real = T_real;
   DEBUG(KB.checkConsistency();)
@@ -347,6 +373,7 @@ bool FOL_World::get_info(InfoTag tag) const {
     case hasMaxReward: return true;
     case hasMinReward: return true;
     case isMarkov: return true;
+    case hasHashableStates: return compactStates;
     case writeState: {
       cout <<"INFO: deadEnd=" <<deadEnd <<" successEnd=" <<successEnd <<" T_step=" <<T_step <<" T_real=" <<T_real <<" R_total=" <<R_total <<" state=" <<endl;
       state->write(cout, " ", "{}");
@@ -405,6 +432,74 @@ Graph* FOL_World::createStateCopy() {
   return new_state;
 }
 
+FOL_World::CompactState FOL_World::encodeState(const Graph& s) {
+  //-- one record (#args, key, value type, value lo, value hi, args..) per fact
+  Array<uintA> records(s.N);
+  for(uint i=0; i<s.N; i++) {
+    Node* fact = s.elem(i);
+    uintA& r = records(i);
+    r.resize(5+fact->parents.N);
+    r(0) = fact->parents.N;
+    auto key = compactKeyIds.emplace(fact->key.p ? fact->key.p : "", compactKeys.N);
+    if(key.second) compactKeys.append(fact->key);
+    r(1) = key.first->second;
+    if(fact->isOfType<bool>()) {
+      r(2) = 0;  r(3) = fact->get<bool>();  r(4) = 0;
+    } else if(fact->isOfType<double>()) {
+      double x = fact->get<double>();
+      if(x==0.) x=0.; //no -0.
+      uint64_t bits;
+      memcpy(&bits, &x, sizeof(bits));
+      r(2) = 1;  r(3) = uint(bits);  r(4) = uint(bits>>32);
+    } else HALT("compact states only encode bool and double facts, not " <<*fact);
+    for(uint j=0; j<fact->parents.N; j++) {
+      Node* sym = fact->parents.p[j];
+      auto id = compactSymbolIds.emplace(sym, compactSymbols.N);
+      if(id.second) compactSymbols.append(sym);
+      r(5+j) = id.first->second;
+    }
+  }
+
+  //-- sort the records, so that equal fact sets have equal encodings
+  uintA order(s.N);
+  for(uint i=0; i<order.N; i++) order.p[i]=i;
+  std::sort(order.p, order.p+order.N, [&records](uint a, uint b) {
+    const uintA& x=records.p[a], &y=records.p[b];
+    return std::lexicographical_compare(x.p, x.p+x.N, y.p, y.p+y.N);
+  });
+  auto facts = std::make_shared<uintA>();
+  for(uint i:order) facts->append(records.p[i]);
+
+  CompactState c;
+  c.hash = facts->N;
+  for(uint w:*facts) c.hash ^= std::hash<uint>()(w) + 0x9e3779b9 + (c.hash<<6) + (c.hash>>2);
+  c.facts = facts;
+  return c;
+}
+
+void FOL_World::decodeState(Graph& s, const CompactState& c) const {
+  CHECK(c.facts, "empty compact state");
+  s.clear();
+  const uintA& F = *c.facts;
+  NodeL parents;
+  for(uint i=0; i<F.N;) {
+    uint n = F.p[i];
+    CHECK_LE(i+5+n, F.N, "corrupt compact state");
+    parents.resize(n);
+    for(uint j=0; j<n; j++) parents.p[j] = compactSymbols(F.p[i+5+j]);
+    const char* key = F.p[i+1] ? compactKeys(F.p[i+1]).p : nullptr;
+    if(F.p[i+2]==0) {
+      s.newNode<bool>(key, parents, F.p[i+3]!=0);
+    } else {
+      uint64_t bits = uint64_t(F.p[i+3]) | (uint64_t(F.p[i+4])<<32);
+      double x;
+      memcpy(&x, &bits, sizeof(x));
+      s.newNode<double>(key, parents, x);
+    }
+    i += 5+n;
+  }
+}
+
 void FOL_World::writePDDLdomain(std::ostream& os, const char* domainName) const {
   os <<"(define (domain " <<domainName;
 
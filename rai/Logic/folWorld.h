@@ -67,10 +67,28 @@ struct FOL_World : TreeSearchDomain {
     void write(ostream& os) const { os <<*state; }
   };
 
+  /// a compact, canonical encoding of a symbolic state (alternative to State, which refers to a copy of the state graph):
+  /// the sorted records (#args, key, value type, value (2 words), args..) of all facts, with symbols and keys interned by
+  /// the FOL_World (and only meaningful w.r.t. it); copies share the immutable records and the hash is precomputed
+  struct CompactState : SAO {
+    std::shared_ptr<const uintA> facts;
+    size_t hash=0;
+    uint T_step=0;
+    double T_real=0., R_total=0.;
+
+    virtual bool operator==(const SAO& other) const {
+      auto ob = dynamic_cast<const CompactState*>(&other);
+      return ob!=nullptr && ob->hash==hash && (ob->facts==facts || *ob->facts==*facts);
+    }
+    virtual size_t get_hash() const { return hash; }
+    void write(ostream& os) const { os <<"CompactState(" <<(facts?facts->N:0) <<" words, hash " <<hash <<')'; }
+  };
+
   //-- parameters
   bool hasWait;
   double gamma, stepCost, timeCost, deadEndCost;
   uint maxHorizon;
+  bool compactStates=false; ///< get_stateCopy() returns CompactState instead of State handles
 
   //-- internal state
   uint T_step, start_T_step; ///< discrete "time": decision steps so far
@@ -89,6 +107,12 @@ struct FOL_World : TreeSearchDomain {
   Node* Terminate_keyword=0, *Wait_keyword=0, *Quit_keyword=0, *Quit_literal=0, *Subgoal_keyword=0, *Subgoal_literal=0;
   Graph* subgoals=0;
 
+  //-- interned symbols and keys of compact states
+  NodeL compactSymbols;
+  std::unordered_map<Node*, uint> compactSymbolIds;
+  StringA compactKeys;
+  std::unordered_map<std::string, uint> compactKeyIds;
+
   int verbose;
   int verbFil;
   ofstream fil;
@@ -139,6 +163,8 @@ struct FOL_World : TreeSearchDomain {
   Graph* getState();
   void setState(Graph*, int setT_step=-1);
   Graph* createStateCopy();
+  CompactState encodeState(const Graph& s);
+  void decodeState(Graph& s, const CompactState& c) const;
 
   void write(std::ostream& os) const { os <<KB; }
   void writePDDLdomain(std::ostream& os, const char* domainName="raiFolDomain") const;
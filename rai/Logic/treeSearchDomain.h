@@ -12,6 +12,8 @@
 #include <vector>
 #include <memory>
 #include <tuple>
+#include <list>
+#include <unordered_map>
 #include "../Core/array.h"
 
 namespace rai {
@@ -76,8 +78,8 @@ struct TreeSearchDomain {
   /// Reset the environment's state to the start state
   virtual void reset_state() = 0;
 
-  /// static information on the environment
-  enum InfoTag { getGamma, hasTerminal, isDeterministic, hasMaxReward, getMaxReward, hasMinReward, getMinReward, isMarkov, writeState };
+  /// static information on the environment (hasHashableStates: state handles implement get_hash and equality by content)
+  enum InfoTag { getGamma, hasTerminal, isDeterministic, hasMaxReward, getMaxReward, hasMinReward, getMinReward, isMarkov, writeState, hasHashableStates };
   virtual bool get_info(InfoTag tag) const = 0;
   virtual double get_info_value(InfoTag tag) const = 0;
 
@@ -89,6 +91,54 @@ extern std::shared_ptr<const TreeSearchDomain::SAO> NoHandle;
 
 //===========================================================================
 
+/** A table from states (handles of a domain with hasHashableStates) to search nodes, to detect transpositions -- equal
+ *  states reached along different decision paths. The table only indexes the nodes, it does not own them. It is
+ *  memory-bounded: beyond maxSize entries the least recently used are dropped, so later duplicates of these go undetected. */
+template<class T> struct TranspositionTable {
+  typedef TreeSearchDomain::Handle Handle;
+  struct Hash { size_t operator()(const Handle& s) const { return s->get_hash(); } };
+  struct Equal { bool operator()(const Handle& a, const Handle& b) const { return *a==*b; } };
+  typedef std::list<std::pair<Handle, T>> Entries;
+
+  Entries entries; ///< most recently used first
+  std::unordered_map<Handle, typename Entries::iterator, Hash, Equal> map;
+  uint maxSize;
+  uint hits=0, evicted=0;
+
+  TranspositionTable(uint maxSize=1000000) : maxSize(maxSize) {}
+
+  /// the node stored for this state, or nullptr
+  T* find(const Handle& state) {
+    auto it = map.find(state);
+    if(it==map.end()) return nullptr;
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return &it->second->second;
+  }
+
+  /// store (or replace) the node for this state
+  void set(const Handle& state, const T& x) {
+    auto it = map.find(state);
+    if(it!=map.end()) {
+      it->second->second = x;
+      entries.splice(entries.begin(), entries, it->second);
+      return;
+    }
+    entries.emplace_front(state, x);
+    map.emplace(state, entries.begin());
+    while(map.size()>maxSize) {
+      map.erase(entries.back().first);
+      entries.pop_back();
+      evicted++;
+    }
+  }
+
+  uint size() const { return map.size(); }
+  void clear() { map.clear(); entries.clear(); hits=evicted=0; }
+};
+
+//===========================================================================
+
 struct TreeSearchNode{
   double f_prio=0.;
 
@@ -32,7 +32,7 @@ const rai::Array<rai::TreeSearchDomain::Handle> BlindBranch::get_actions() {
   return actions;
 }
 
-const rai::TreeSearchDomain::Handle BlindBranch::get_state() {
+const rai::TreeSearchDomain::Handle BlindBranch::get_stateCopy() {
   return rai::TreeSearchDomain::Handle(new State(state, T));
 }
 
@@ -51,6 +51,7 @@ bool BlindBranch::get_info(InfoTag tag) const {
     case hasMaxReward: return true;
     case hasMinReward: return true;
     case isMarkov: return true;
+    case hasHashableStates: return true;
     default: HALT("unknown tag" <<tag);
   }
 }
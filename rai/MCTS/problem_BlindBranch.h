@@ -26,6 +26,7 @@ struct BlindBranch : rai::TreeSearchDomain {
       const State& s = dynamic_cast<const State&>(other);
       return sum==s.sum && T==s.T;
     }
+    size_t get_hash() const { return std::hash<int>()(sum) ^ (std::hash<uint>()(T)<<1); }
   };
 
   int state; //the state = sum of so-far actions
@@ -38,9 +39,10 @@ struct BlindBranch : rai::TreeSearchDomain {
   TransitionReturn transition(const Handle& action);
   TransitionReturn transition_randomly();
   const rai::Array<Handle> get_actions();
-  const Handle get_state();
+  const Handle get_stateCopy();
   void set_state(const Handle& _state);
   bool is_terminal_state() const;
+  void make_current_state_new_start() { NIY; }
 
   bool get_info(InfoTag tag) const;
   double get_info_value(InfoTag tag) const;
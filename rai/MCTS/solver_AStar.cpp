@@ -61,8 +61,7 @@ void AStar_Node::getGraph(rai::Graph& G, rai::Node* n) {
   } else {
     n = G.newNode<bool>({STRING("a:"<<*action)}, {n}, true);
   }
-  n->key <<STRING("d:" <<d <<" t:" <<time <<' ');
-  n->key <<STRING("f:" <<g+h <<" g:" <<g <<" h:" <<h);
+  n->setKey(STRING(n->key <<"d:" <<d <<" t:" <<time <<' ' <<"f:" <<g+h <<" g:" <<g <<" h:" <<h));
 //  if(mcStats && mcStats->n) n->keys.append(STRING("MC best:" <<mcStats->X.first() <<" n:" <<mcStats->n));
 //  n->keys.append(STRING("sym  #" <<mcCount <<" f:" <<symCost <<" terminal:" <<isTerminal));
 //  n->keys.append(STRING("pose #" <<poseCount <<" f:" <<poseCost <<" g:" <<poseConstraints <<" feasible:" <<poseFeasible));
@@ -71,6 +70,7 @@ void AStar_Node::getGraph(rai::Graph& G, rai::Node* n) {
 //  if(folAddToState) n->keys.append(STRING("symAdd:" <<*folAddToState));
 
   G.getRenderingInfo(n).dotstyle="shape=box";
+  if(isDuplicate) G.getRenderingInfo(n).dotstyle <<" style=dashed";
   if(isInfeasible) {
     if(isTerminal)  G.getRenderingInfo(n).dotstyle <<" style=filled fillcolor=violet";
     else G.getRenderingInfo(n).dotstyle <<" style=filled fillcolor=red";
@@ -103,7 +103,9 @@ void AStar_Node::write(ostream& os, bool recursive) const {
 //===========================================================================
 
 AStar::AStar(rai::TreeSearchDomain& world) : root(nullptr), size(0), depth(0) {
+  useTranspositions = world.get_info(world.isMarkov) && world.get_info(world.hasHashableStates);
   root = new AStar_Node(*this, world);
+  if(useTranspositions) transpositions.set(root->state, root);
   queue.add(0., root);
 }
 
@@ -113,12 +115,20 @@ bool AStar::step() {
     return false;
   }
   auto next =  queue.pop();
+  if(next->isDuplicate) return false; //superseded by a better node of the same state after it was queued
   if(next->isTerminal) {
     solutions.append(next);
     return true;
   }
   next->expand();
   for(AStar_Node* ch:next->children) {
+    if(useTranspositions) {
+      AStar_Node** known = transpositions.find(ch->state);
+      if(known && (*known)->g>=ch->g) { ch->isDuplicate=true; continue; }
+      //the first, or a better path to this state: (re-)open it; a worse node still in the queue is skipped when popped
+      if(known) (*known)->isDuplicate=true;
+      transpositions.set(ch->state, ch);
+    }
     queue.add(- ch->g - ch->h, ch, true);
   }
   return false;
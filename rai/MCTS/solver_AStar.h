@@ -38,6 +38,7 @@ struct AStar_Node {
   bool isExpanded=false;
   bool isInfeasible=false;
   bool isTerminal=false;
+  bool isDuplicate=false; ///< its state was reached by another node with at least its g -> not expanded
 
   /// root node init
   AStar_Node(AStar& astar, rai::TreeSearchDomain& world);
@@ -77,6 +78,8 @@ struct AStar {
   PriorityQueue<AStar_Node*> queue;
   rai::Array<AStar_Node*> solutions;
   uint size, depth;
+  bool useTranspositions; ///< detect duplicate states (if the world is Markov and has hashable states)
+  rai::TranspositionTable<AStar_Node*> transpositions;
 
   AStar(rai::TreeSearchDomain& world);
 
@@ -18,7 +18,7 @@ void MCStatistics::add(double R, uint topSize) {
 }
 
 PlainMC::PlainMC(rai::TreeSearchDomain& world)
-  : world(world), gamma(.9), verbose(2), topSize(10) {
+  : world(world), gamma(.9), verbose(2), topSize(10), rndStream(rnd.num()) {
   reset();
   gamma = world.get_info_value(rai::TreeSearchDomain::getGamma);
   rai::FileToken fil("PlainMC.blackList");
@@ -70,7 +70,7 @@ double PlainMC::finishRollout(int stepAbort) {
       if(verbose>1) { cout <<" -- no decisions left -> terminal" <<endl; }
       break;
     }
-    uint a = rand()%actions.N;
+    uint a = rndStream.num(actions.N);
     if(verbose>1) cout <<"****************** MC: random decision: " <<*actions(a) <<endl;
     rolloutDecisions.append(actions(a));
     ret = world.transition(actions(a));
@@ -135,7 +135,7 @@ double PlainMC::generateRollout(int stepAbort, const rai::Array<rai::TreeSearchD
 
 double PlainMC::addRollout(int stepAbort) {
   // random first choice
-  uint a = rnd(A.N);
+  uint a = rndStream.num(A.N);
 
   //generate rollout
   generateRollout(stepAbort, {A(a)});
@@ -35,6 +35,7 @@ struct PlainMC {
   int verbose;
   uint topSize;
   StringA blackList;
+  rai::RndStream rndStream; ///< the rollouts' random decisions (seeded from the global rnd on construction)
 
   //partly internal: results of a rollout
   uint rolloutStep;
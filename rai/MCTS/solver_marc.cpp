@@ -12,6 +12,8 @@ void MCTS::addRollout(int stepAbort) {
   int step=0;
   MCTS_Node* n = &root;
   world.reset_state();
+  rai::Array<MCTS_Node*> path = {n}; //the visited nodes (parents are not unique when merging transpositions)
+  if(useTranspositions && !root.N) transpositions.set(world.get_stateCopy(), &root);
 
   //-- tree policy
   double Return_tree=0.;
@@ -41,6 +43,16 @@ void MCTS::addRollout(int stepAbort) {
     n = treePolicy(n);
     if(verbose>1) cout <<"****************** MCTS: made tree policy decision" <<endl;
     Return_tree += n->r = world.transition(n->decision).reward;
+    path.append(n);
+    if(useTranspositions) {
+      if(!n->N && !n->transposition) { //first visit: has the state been reached before along another path?
+        auto state = world.get_stateCopy();
+        MCTS_Node** known = transpositions.find(state);
+        if(!known) transpositions.set(state, n);
+        else if(!path.contains(*known)) n->transposition = *known;
+      }
+      if(n->transposition) n = n->transposition; //continue with the children of the known node
+    }
   }
 
   //-- rollout
@@ -55,20 +67,24 @@ void MCTS::addRollout(int stepAbort) {
   if(step>=stepAbort) Return_rollout -= 100.;
   if(verbose>0) cout <<"****************** MCTS: terminal state reached; step=" <<step <<" Return=" <<Return_tree + Return_rollout <<endl;
 
-  //-- backup
+  //-- backup along the path; a merged node also collects the returns of all paths reaching its state
   double Return_togo = Return_rollout;
-  for(;;) {
-    if(!n) break;
-    n->N++;
-    n->R += n->r;   //total immediate reward
+  for(uint i=path.N; i--;) {
+    n = path(i);
+    if(n->transposition) backup(n->transposition, Return_togo + n->transposition->r);
     Return_togo += n->r; //add up total return from n to terminal
-    n->Q += Return_togo;
-    if(n->children.N && n->N>n->children.N) { //propagate bounds
-      n->Qup = max(Qfunction(n, +1));
-      n->Qme = max(Qfunction(n,  0));
-      n->Qlo = max(Qfunction(n, -1));
-    }
-    n = n->parent;
+    backup(n, Return_togo);
+  }
+}
+
+void MCTS::backup(MCTS_Node* n, double Return_togo) {
+  n->N++;
+  n->R += n->r;   //total immediate reward
+  n->Q += Return_togo;
+  if(n->children.N && n->N>n->children.N) { //propagate bounds
+    n->Qup = max(Qfunction(n, +1));
+    n->Qme = max(Qfunction(n,  0));
+    n->Qlo = max(Qfunction(n, -1));
   }
 }
 
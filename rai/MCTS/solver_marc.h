@@ -26,8 +26,9 @@ struct MCTS_Node {
 
   uint t;               ///< depth of this node
   void* data;           ///< dummy helper (to convert to other data structures)
+  MCTS_Node* transposition; ///< another node with the same state (reached first), which holds the children -- the tree is a DAG
 
-  MCTS_Node(MCTS_Node* parent, rai::TreeSearchDomain::Handle decision):parent(parent), decision(decision), Qup(0.), Qme(0.), Qlo(0.), r(0.), R(0.), N(0), Q(0.), t(0), data(nullptr) {
+  MCTS_Node(MCTS_Node* parent, rai::TreeSearchDomain::Handle decision):parent(parent), decision(decision), Qup(0.), Qme(0.), Qlo(0.), r(0.), R(0.), N(0), Q(0.), t(0), data(nullptr), transposition(nullptr) {
     if(parent) {
       t=parent->t+1;
       parent->children.append(this);
@@ -42,11 +43,16 @@ struct MCTS {
   MCTS_Node root;
   int verbose;
   double beta;
+  bool useTranspositions; ///< merge nodes of equal states (if the world is Markov and has hashable states)
+  rai::TranspositionTable<MCTS_Node*> transpositions;
 
-  MCTS(rai::TreeSearchDomain& world):world(world), root(nullptr, nullptr), verbose(2), beta(2.) {}
+  MCTS(rai::TreeSearchDomain& world):world(world), root(nullptr, nullptr), verbose(2), beta(2.) {
+    useTranspositions = world.get_info(world.isMarkov) && world.get_info(world.hasHashableStates);
+  }
 
   void addRollout(int stepAbort=-1);                 ///< adds one more rollout to the tree
   MCTS_Node* treePolicy(MCTS_Node* n);   ///< policy to choose the child from which to do a rollout or to expand
+  void backup(MCTS_Node* n, double Return_togo); ///< adds a return (from n on, including n's immediate reward) to n's statistics
   double Qvalue(MCTS_Node* n, int optimistic); ///< current value estimates at a node
   arr Qfunction(MCTS_Node* n=nullptr, int optimistic=0); ///< the Q-function (value estimates of all children) at a node
   arr Qvariance(MCTS_Node* n=nullptr);
@@ -16,7 +16,8 @@ BayesOpt::BayesOpt(const ScalarFunction& _f, const arr& bounds_lo, const arr& bo
     bounds_lo(bounds_lo), bounds_hi(bounds_hi),
     f_now(nullptr), f_smaller(nullptr),
     alphaMinima_now(ScalarFunction(), bounds_lo, bounds_hi),
-    alphaMinima_smaller(ScalarFunction(), bounds_lo, bounds_hi) {
+    alphaMinima_smaller(ScalarFunction(), bounds_lo, bounds_hi),
+    rndStream(rnd.num()) {
 
   init_lengthScale *= sum(bounds_hi - bounds_lo)/bounds_lo.N;
 
@@ -43,7 +44,9 @@ BayesOpt::~BayesOpt() {
 void BayesOpt::step() {
   arr x;
   if(!data_X.N) {
-    x = bounds_lo + (bounds_hi-bounds_lo) % rand(bounds_lo.N);
+    arr u(bounds_lo.N);
+    rndUniform(u, rndStream);
+    x = bounds_lo + (bounds_hi-bounds_lo) % u;
   } else {
     x = pickNextPoint();
   }
@@ -27,6 +27,7 @@ struct BayesOpt {
   struct DefaultKernelFunction* kernel_now;
   struct DefaultKernelFunction* kernel_smaller;
   double lengthScale;
+  rai::RndStream rndStream; ///< for the initial sample (seeded from the global rnd on construction)
 
   //lengthScale is always relative to hi-lo
   BayesOpt(const ScalarFunction& f, const arr& bounds_lo, const arr& bounds_hi, double init_lengthScale=1., double prior_var=1., rai::OptOptions o=NOOPT);
@@ -15,7 +15,8 @@ GlobalIterativeNewton::GlobalIterativeNewton(const ScalarFunction& f, const arr&
     newton(x, f, opt),
     grad(x, f, opt),
     bounds_lo(bounds_lo), bounds_hi(bounds_up),
-    best(nullptr) {
+    best(nullptr),
+    rndStream(rnd.num()) {
   newton.setBounds(bounds_lo, bounds_up);
   newton.options.verbose = 0;
 }
@@ -68,7 +69,9 @@ void addRunFrom(GlobalIterativeNewton& gin, const arr& x) {
 }
 
 void GlobalIterativeNewton::step() {
-  arr x = bounds_lo + (bounds_hi-bounds_lo) % rand(bounds_lo.N);
+  arr u(bounds_lo.N);
+  rndUniform(u, rndStream);
+  arr x = bounds_lo + (bounds_hi-bounds_lo) % u;
   if(newton.options.verbose>1) cout <<"***** optGlobalIterativeNewton: new iteration from x=" <<x <<endl;
   addRunFrom(*this, x);
 }
@@ -92,7 +95,7 @@ void GlobalIterativeNewton::reOptimizeAllPoints() {
   arr X;
   for(LocalMinimum& m:localMinima) X.append(m.x);
   X.reshape(localMinima.N, X.N/localMinima.N);
-  rndGauss(X, .01, true);
+  rndGauss(X, rndStream, .01, true);
   localMinima.clear();
   for(uint i=0; i<X.d0; i++) addRunFrom(*this, X[i]);
 }
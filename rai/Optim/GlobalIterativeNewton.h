@@ -20,6 +20,7 @@ struct GlobalIterativeNewton {
   struct LocalMinimum { arr x; double fx; uint hits; };
   rai::Array<LocalMinimum> localMinima;
   LocalMinimum* best;
+  rai::RndStream rndStream; ///< for the restart points (seeded from the global rnd on construction)
 
   GlobalIterativeNewton(const ScalarFunction& f, const arr& bounds_lo, const arr& bounds_up, rai::OptOptions o=NOOPT);
   ~GlobalIterativeNewton();
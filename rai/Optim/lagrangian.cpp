@@ -97,7 +97,7 @@ void LagrangianProblem::evaluate(arr& phi, arr& J, const arr& _x) {
   if(!!J) { //term Jacobians
     if(isSparse(J_x)){
       J.sparse().resize(phi.N, J_x.d1, 0);
-      J_x.sparse().setupRowsCols();
+      J_x.sparse().ensureRowsCols();
     }else{
       J.resize(phi.N, J_x.d1).setZero();
     }
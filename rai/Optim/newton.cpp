@@ -8,6 +8,7 @@
 
 #include "newton.h"
 #include "optimization.h"
+#include "../Core/trace.h"
 
 #include <iomanip>
 
@@ -60,6 +61,7 @@ void OptNewton::reinit(const arr& _x) {
 //===========================================================================
 
 OptNewton::StopCriterion OptNewton::step() {
+  RAI_TRACE_SCOPE("OptNewton::step");
   if(!evals) reinit(x);
 
   double fy;
@@ -122,14 +124,22 @@ OptNewton::StopCriterion OptNewton::step() {
     } else if(isRowShifted(R)) {
       for(uint i=0; i<R.d0; i++) R.rowShifted().entry(i, 0) += beta; //(R(i,0) is the diagonal in the packed matrix!!)
     } else if(isSparseMatrix(R)) {
-      for(uint i=0; i<R.d0; i++) R.sparse().addEntry(i, i) = beta;
+      if(rootFinding) for(uint i=0; i<R.d0; i++) R.sparse().addEntry(i, i) = beta;
+      //otherwise sparseLDL adds the damping to the diagonal itself, leaving the pattern of R unchanged
     } else NIY;
   }
   {
     bool inversionFailed=false;
     try {
       if(!rootFinding) {
-        Delta = lapack_Ainv_b_sym(R, -gx);
+        if(isSparseMatrix(R)) {
+          //indefiniteness is detected from the pivots of the factorization
+          if(sparseLDL.factorize(R.sparse(), beta)) Delta = sparseLDL.solve(-gx);
+          else inversionFailed=true;
+        } else {
+          //for RowShifted R: LAPACK's banded Cholesky dpbsv, O(n b^2) for band width b; it throws if R is not pos-def
+          Delta = lapack_Ainv_b_sym(R, -gx);
+        }
       } else {
         lapack_mldivide(Delta, R, -gx);
       }
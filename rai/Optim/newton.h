@@ -9,6 +9,7 @@
 #pragma once
 
 #include "options.h"
+#include "sparseLDL.h"
 #include "../Core/array.h"
 
 int optNewton(arr& x, const ScalarFunction& f, rai::OptOptions opt=NOOPT);
@@ -38,4 +39,5 @@ public:
   bool rootFinding=false;
   ostream* logFile=nullptr, *simpleLog=nullptr;
   double timeNewton=0., timeEval=0.;
+  SparseLDL sparseLDL; ///< factorization of sparse Hessians; its symbolic analysis is reused across steps
 };
@@ -113,7 +113,7 @@ double PrimalDualProblem::primalDual(arr& r, arr& R, const arr& x_lambda) {
       Rsparse = &R.sparse();
       Rsparse->reshape(r.N, r.N);
       LJx_sparse = &L.J_x.sparse();
-      LJx_sparse->setupRowsCols();
+      LJx_sparse->ensureRowsCols();
     }
 
     // top-mid: transposed \del h
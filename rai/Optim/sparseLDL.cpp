@@ -0,0 +1,221 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "sparseLDL.h"
+#include "../Core/trace.h"
+
+#include <queue>
+#include <algorithm>
+
+#define NONE uint(-1)
+
+//===========================================================================
+
+uintA minimumDegreeOrdering(uint n, const intA& elems) {
+  //-- symmetric adjacency (without diagonal and duplicates)
+  rai::Array<uintA> adj(n);
+  uintA mark(n);
+  mark.setZero();
+  for(uint k=0; k<elems.d0; k++) {
+    uint i=elems.p[2*k], j=elems.p[2*k+1];
+    if(i==j) continue;
+    adj(i).append(j);
+    adj(j).append(i);
+  }
+  uint stamp=0;
+  for(uint i=0; i<n; i++) {
+    stamp++;
+    uintA& Ni = adj(i);
+    uint m=0;
+    for(uint w:Ni) if(mark.p[w]!=stamp) { mark.p[w]=stamp; Ni.p[m++]=w; }
+    Ni.resizeCopy(m);
+  }
+
+  //-- eliminate nodes in order of minimal degree in the elimination graph
+  typedef std::pair<uint, uint> DegNode;
+  std::priority_queue<DegNode, std::vector<DegNode>, std::greater<DegNode>> queue;
+  for(uint i=0; i<n; i++) queue.push({adj(i).N, i});
+  boolA eliminated(n);
+  eliminated.setZero();
+  uintA perm;
+  perm.reserveMEM(n);
+  while(!queue.empty()) {
+    DegNode top = queue.top();
+    queue.pop();
+    uint v = top.second;
+    if(eliminated.p[v] || top.first!=adj(v).N) continue; //outdated queue entry
+    eliminated.p[v]=true;
+    perm.append(v);
+    //neighbors of v become a clique; adjacency lists only ever contain non-eliminated nodes
+    uintA& Nv = adj(v);
+    for(uint u:Nv) {
+      stamp++;
+      uintA& Nu = adj(u);
+      uint m=0;
+      for(uint w:Nu) if(!eliminated.p[w] && mark.p[w]!=stamp) { mark.p[w]=stamp; Nu.p[m++]=w; }
+      Nu.resizeCopy(m);
+      for(uint w:Nv) if(w!=u && mark.p[w]!=stamp) { mark.p[w]=stamp; Nu.append(w); }
+      queue.push({Nu.N, u});
+    }
+    Nv.clear();
+  }
+  CHECK_EQ(perm.N, n, "");
+  return perm;
+}
+
+//===========================================================================
+
+void SparseLDL::analyze(const rai::SparseMatrix& A) {
+  RAI_TRACE_SCOPE("SparseLDL::analyze");
+  CHECK_EQ(A.Z.nd, 2, "");
+  CHECK_EQ(A.Z.d0, A.Z.d1, "LDL^T requires a square (symmetric) matrix");
+  n = A.Z.d0;
+  elems = A.elems;
+  analyzeCount++;
+
+  //-- ordering
+  perm = minimumDegreeOrdering(n, elems);
+  permInv.resize(n);
+  for(uint k=0; k<n; k++) permInv.p[perm.p[k]] = k;
+
+  //-- CSC pattern of the upper triangle of the permuted matrix, always including the diagonal
+  uintA colN(n);
+  colN = 1u;
+  for(uint k=0; k<elems.d0; k++) {
+    int i=elems.p[2*k], j=elems.p[2*k+1];
+    if(i>j) colN.p[std::max(permInv.p[i], permInv.p[j])]++;
+  }
+  Cp.resize(n+1);
+  Cp.p[0]=0;
+  for(uint c=0; c<n; c++) Cp.p[c+1] = Cp.p[c]+colN.p[c];
+  Ci.resize(Cp.p[n]);
+  for(uint c=0; c<n; c++) { Ci.p[Cp.p[c]] = c; colN.p[c] = 1; }
+  for(uint k=0; k<elems.d0; k++) {
+    int i=elems.p[2*k], j=elems.p[2*k+1];
+    if(i>j) {
+      uint pi=permInv.p[i], pj=permInv.p[j];
+      uint c=std::max(pi, pj), r=std::min(pi, pj);
+      Ci.p[Cp.p[c] + colN.p[c]++] = r;
+    }
+  }
+  //sort rows within columns and remove duplicates
+  uint nz=0;
+  for(uint c=0; c<n; c++) {
+    uint* start = Ci.p+Cp.p[c];
+    uint* stop = Ci.p+Cp.p[c+1];
+    std::sort(start, stop);
+    uint* last = std::unique(start, stop);
+    Cp.p[c] = nz;
+    for(uint* r=start; r!=last; r++) Ci.p[nz++] = *r;
+  }
+  Cp.p[n] = nz;
+  Ci.resizeCopy(nz);
+  Cdiag.resize(n);
+  for(uint c=0; c<n; c++) Cdiag.p[c] = Cp.p[c+1]-1; //the diagonal is the last (largest) row of a column
+
+  //-- map each non-zero of A to its position in the permuted matrix
+  Cmap.resize(elems.d0);
+  for(uint k=0; k<elems.d0; k++) {
+    int i=elems.p[2*k], j=elems.p[2*k+1];
+    if(i<j) { Cmap.p[k]=NONE; continue; }
+    uint pi=permInv.p[i], pj=permInv.p[j];
+    uint c=std::max(pi, pj), r=std::min(pi, pj);
+    Cmap.p[k] = std::lower_bound(Ci.p+Cp.p[c], Ci.p+Cp.p[c+1], r) - Ci.p;
+  }
+
+  //-- elimination tree and column counts of L
+  parent.resize(n);
+  Lnz.resize(n);
+  uintA flag(n);
+  for(uint k=0; k<n; k++) {
+    parent.p[k]=NONE;
+    flag.p[k]=k;
+    Lnz.p[k]=0;
+    for(uint p=Cp.p[k]; p<Cp.p[k+1]; p++) {
+      for(uint i=Ci.p[p]; i<k && flag.p[i]!=k; i=parent.p[i]) {
+        if(parent.p[i]==NONE) parent.p[i]=k;
+        Lnz.p[i]++;
+        flag.p[i]=k;
+      }
+    }
+  }
+  Lp.resize(n+1);
+  Lp.p[0]=0;
+  for(uint k=0; k<n; k++) Lp.p[k+1] = Lp.p[k]+Lnz.p[k];
+  Li.resize(Lp.p[n]);
+  Lx.resize(Lp.p[n]);
+  D.resize(n);
+  Cx.resize(nz);
+}
+
+bool SparseLDL::factorize(const rai::SparseMatrix& A, double damping) {
+  RAI_TRACE_SCOPE("SparseLDL::factorize");
+  if(n!=A.Z.d0 || elems.N!=A.elems.N || memcmp(elems.p, A.elems.p, elems.N*elems.sizeT)) analyze(A);
+  factorizeCount++;
+
+  //-- values of the permuted matrix
+  Cx.setZero();
+  for(uint k=0; k<Cmap.N; k++) if(Cmap.p[k]!=NONE) Cx.p[Cmap.p[k]] += A.Z.p[k];
+  if(damping) for(uint c=0; c<n; c++) Cx.p[Cdiag.p[c]] += damping;
+
+  //-- up-looking LDL^T: row k of L from a sparse triangular solve along the elimination tree
+  arr y(n);
+  y.setZero();
+  uintA pattern(n), flag(n);
+  failedPivot=-1;
+  for(uint k=0; k<n; k++) {
+    uint top=n;
+    flag.p[k]=k;
+    Lnz.p[k]=0;
+    for(uint p=Cp.p[k]; p<Cp.p[k+1]; p++) {
+      uint i=Ci.p[p];
+      y.p[i] += Cx.p[p];
+      uint len=0;
+      for(; flag.p[i]!=k; i=parent.p[i]) { pattern.p[len++]=i; flag.p[i]=k; }
+      while(len>0) pattern.p[--top] = pattern.p[--len];
+    }
+    D.p[k] = y.p[k];
+    y.p[k] = 0.;
+    for(; top<n; top++) {
+      uint i=pattern.p[top];
+      double yi=y.p[i];
+      y.p[i]=0.;
+      uint p=Lp.p[i], pstop=Lp.p[i]+Lnz.p[i];
+      for(; p<pstop; p++) y.p[Li.p[p]] -= Lx.p[p]*yi;
+      double l_ki = yi/D.p[i];
+      D.p[k] -= l_ki*yi;
+      Li.p[p] = k;
+      Lx.p[p] = l_ki;
+      Lnz.p[i]++;
+    }
+    if(!(D.p[k]>0.)) { failedPivot=k; return false; } //not positive definite (or NAN)
+  }
+  return true;
+}
+
+arr SparseLDL::solve(const arr& b) const {
+  RAI_TRACE_SCOPE("SparseLDL::solve");
+  CHECK_EQ(b.nd, 1, "");
+  CHECK_EQ(b.N, n, "");
+  CHECK_EQ(failedPivot, -1, "factorization failed -- can't solve");
+  arr x(n);
+  for(uint k=0; k<n; k++) x.p[k] = b.p[perm.p[k]];
+  for(uint j=0; j<n; j++) {
+    double xj=x.p[j];
+    for(uint p=Lp.p[j]; p<Lp.p[j+1]; p++) x.p[Li.p[p]] -= Lx.p[p]*xj;
+  }
+  for(uint j=0; j<n; j++) x.p[j] /= D.p[j];
+  for(uint j=n; j--;) {
+    double xj=x.p[j];
+    for(uint p=Lp.p[j]; p<Lp.p[j+1]; p++) xj -= Lx.p[p]*x.p[Li.p[p]];
+    x.p[j]=xj;
+  }
+  arr y(n);
+  for(uint k=0; k<n; k++) y.p[perm.p[k]] = x.p[k];
+  return y;
+}
@@ -0,0 +1,43 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "../Core/array.h"
+
+//===========================================================================
+
+/// fill-reducing minimum degree ordering of the symmetric pattern (i,j) given as elems (as in SparseMatrix)
+uintA minimumDegreeOrdering(uint n, const intA& elems);
+
+//===========================================================================
+
+/** Sparse LDL^T factorization of a symmetric SparseMatrix A (only its lower triangle is read, duplicates are summed).
+ *  The symbolic analysis (minimum degree ordering, elimination tree, pattern of L) is done once and reused by all
+ *  later factorizations as long as the non-zero pattern of A does not change, e.g., across Newton iterations.
+ *  factorize returns false if A+damping*I is not positive definite (a non-positive pivot occurred). */
+struct SparseLDL {
+  //symbolic analysis
+  uint n=0;
+  intA elems;             ///< pattern of the analyzed A (to detect changes)
+  uintA perm, permInv;    ///< fill-reducing ordering: row k of the factored matrix is row perm(k) of A
+  uintA Cp, Ci, Cdiag;    ///< CSC (upper triangle) pattern of the permuted A; Cdiag(k): position of diagonal entry
+  uintA Cmap;             ///< for every non-zero of A the position in Cx (or -1 if in the upper triangle)
+  uintA parent, Lp;       ///< elimination tree and column pointers of L
+  //numeric factorization
+  arr Cx;                 ///< values of the permuted A
+  uintA Li, Lnz;          ///< row indices and counts of L
+  arr Lx, D;              ///< L (strictly lower, column-wise) and the pivots D
+  int failedPivot=-1;     ///< index of the first non-positive pivot of the last factorization (-1 if none)
+  uint analyzeCount=0, factorizeCount=0;
+
+  void analyze(const rai::SparseMatrix& A);
+  bool factorize(const rai::SparseMatrix& A, double damping=0.);
+  arr solve(const arr& b) const;
+  uint nnzL() const { return Lp.N?Lp.last():0; }
+};
@@ -22,6 +22,25 @@ ConfigurationProblem::ConfigurationProblem(const rai::Configuration& _C, bool _c
   }
 }
 
+shared_ptr<ConfigurationProblem> ConfigurationProblem::clone() const {
+  shared_ptr<ConfigurationProblem> P = make_shared<ConfigurationProblem>(C, computeAllCollisions, collisionTolerance);
+  P->q0 = q0;
+  P->limits = limits;
+  P->max_step = max_step;
+  P->collisionPairs = collisionPairs;
+  P->verbose = verbose;
+  P->cacheResolution = cacheResolution;
+  P->cacheEnvironment = cacheEnvironment;
+  P->continuousCheck = continuousCheck;
+  P->continuousMaxSteps = continuousMaxSteps;
+  for(const shared_ptr<GroundedObjective>& o:objectives) {
+    shared_ptr<GroundedObjective> ob = make_shared<GroundedObjective>(o->feat->deepCopy(), o->type, o->timeSlices);
+    ob->frames = P->C.getFrames(framesToIndices(o->frames));
+    P->objectives.append(ob);
+  }
+  return P;
+}
+
 shared_ptr<GroundedObjective> ConfigurationProblem::addObjective(const FeatureSymbol& feat, const StringA& frames, ObjectiveType type, const arr& scale, const arr& target){
   shared_ptr<Feature> f = symbols2feature(feat, frames, C, scale, target, 0);
 
@@ -29,23 +48,224 @@ shared_ptr<GroundedObjective> ConfigurationProblem::addObjective(const FeatureSy
   ob->frames = C.getFrames(f->frameIDs);
 
   objectives.append(ob);
+  clearCache();
   return ob;
 }
 
 void ConfigurationProblem::setExplicitCollisionPairs(const StringA& _collisionPairs){
   computeAllCollisions = false;
   collisionPairs = C.getFrameIDs(_collisionPairs);
+  collisionPairs.reshape(-1, 2);
+  clearCache();
 }
 
 shared_ptr<QueryResult> ConfigurationProblem::query(const arr& x){
+  if(cacheResolution>0.) ensure_cache();
+  return query_cached(x);
+}
+
+shared_ptr<QueryResult> ConfigurationProblem::query_cached(const arr& x){
+  if(cacheResolution<=0.) return query_uncached(x);
+  std::string key = cacheKey(x);
+  auto it = queryCache.find(key);
+  if(it!=queryCache.end()){ cacheHits++; return it->second; }
+  shared_ptr<QueryResult> qr = query_uncached(x);
+  queryCache[key] = qr;
+  return qr;
+}
+
+double corput(uint n, uint base){
+  double q=0;
+  double bk=(double)1/base;
+
+  while (n > 0) {
+    q += (n % base)*bk;
+    n /= base;
+    bk /= base;
+  }
+  return q;
+}
+
+bool ConfigurationProblem::checkConnection(const arr& start, const arr& end, uint disc, bool binary){
+  std::string key;
+  if(cacheResolution>0.){
+    ensure_cache();
+    //symmetric in start and end
+    std::string a = cacheKey(start), b = cacheKey(end);
+    if(b<a) std::swap(a, b);
+    key = a + b + std::to_string(disc) + (binary ? 'b' : 'l');
+    auto it = edgeCache.find(key);
+    if(it!=edgeCache.end()){ cacheHits++; return it->second; }
+  }
+
+  bool feasible=true;
+  int cont = (continuousCheck ? checkConnectionContinuous(start, end) : -1);
+  if(cont>=0){
+    feasible = cont;
+  }else if (binary){
+    for (uint i=1; i<disc; ++i){
+      double ind = corput(i, 2);
+      arr p = start + ind * (end-start);
+
+      if(!query_cached(p)->isFeasible){
+        feasible = false;
+        break;
+      }
+    }
+  }
+  else{
+    for (uint i=1; i<disc-1; ++i){
+      arr p = start + 1.0 * i / (disc-1) * (end-start);
+
+      if(!query_cached(p)->isFeasible){
+        feasible = false;
+        break;
+      }
+    }
+  }
+
+  if(key.size()) edgeCache[key] = feasible;
+  return feasible;
+}
+
+/// the radius of the sphere (around the frame's origin) enclosing the collision geometry, cf. getCollisionMeshes in proxy.cpp
+static double getShapeRadius(rai::Frame* f){
+  rai::Shape* s = f->shape;
+  if(s->sscCore().V.N) return s->sscCore().getRadius() + s->radius();
+  return s->mesh().getRadius();
+}
+
+/** An upper bound on the path length of any point of f's collision geometry when the joint state moves from start to
+ *  end along the straight edge. Walking up the kinematic chain, R bounds the distance of any point of the geometry from
+ *  the current frame's origin (using the largest relative translations at either end of the edge, as they are linear
+ *  in q): a rotational dof moves it by at most |dq| R, a translational one by |dq|. Returns -1 for joints (balls, free,
+ *  generic, etc.) that are not covered. */
+static double getMotionBound(rai::Frame* f, const arr& start, const arr& end){
+  double B=0., R=getShapeRadius(f);
+  rai::Transformation Q0, Q1;
+  for(; f->parent; f=f->parent){
+    rai::Joint* j = f->joint;
+    if(!j || !j->active || j->type==rai::JT_rigid){
+      R += f->get_Q().pos.length();
+      continue;
+    }
+    const rai::Joint* jq = (j->mimic ? j->mimic : j);
+    const double *q0 = start.p+jq->qIndex, *q1 = end.p+jq->qIndex;
+    double rot=0., trans=0.;
+    switch(j->type){
+      case rai::JT_hingeX: case rai::JT_hingeY: case rai::JT_hingeZ:
+        rot = fabs(q1[0]-q0[0]);  break;
+      case rai::JT_universal:
+        rot = fabs(q1[0]-q0[0]) + fabs(q1[1]-q0[1]);  break;
+      case rai::JT_transX: case rai::JT_transY: case rai::JT_transZ: case rai::JT_transXY: case rai::JT_trans3:
+        for(uint i=0;i<j->dim;i++) trans += rai::sqr(q1[i]-q0[i]);
+        trans = sqrt(trans);  break;
+      case rai::JT_transXYPhi:
+        trans = sqrt(rai::sqr(q1[0]-q0[0]) + rai::sqr(q1[1]-q0[1]));
+        rot = fabs(q1[2]-q0[2]);  break;
+      case rai::JT_transYPhi:
+        trans = fabs(q1[0]-q0[0]);
+        rot = fabs(q1[1]-q0[1]);  break;
+      default:
+        return -1.;
+    }
+    B += j->scale*(rot*R + trans);
+    j->calc_Q_from_dofs(Q0, q0);
+    j->calc_Q_from_dofs(Q1, q1);
+    R += rai::MAX(Q0.pos.length(), Q1.pos.length());
+  }
+  return B;
+}
+
+/** Conservative advancement along q(t) = start + t (end-start): at t, the distance d of each collision pair bounds how far
+ *  t can advance before the pair may penetrate deeper than collisionTolerance, namely by (d+collisionTolerance)/(B_a+B_b),
+ *  with motion bounds B (per unit t) of both frames. Each step costs one distance query of all pairs; far from obstacles
+ *  a few steps certify the whole edge. As the limits are a box, the edge is within them iff both ends are. */
+int ConfigurationProblem::checkConnectionContinuous(const arr& start, const arr& end){
+  //inequality objectives can't be bounded along the edge
+  for(shared_ptr<GroundedObjective>& ob : objectives) if(ob->type==OT_ineq) return -1;
+
+  if(!isWithinLimits(start) || !isWithinLimits(end)) return 0;
+
+  //collision pairs
+  uintA pairs = collisionPairs;
+  if(computeAllCollisions){
+    pairs.clear();
+    for(rai::Frame* a:C.frames) if(a->shape && a->shape->cont){
+      for(rai::Frame* b:C.frames) if(b->ID>a->ID && a->shape->canCollideWith(b)) pairs.append(uintA{a->ID, b->ID});
+    }
+  }
+  pairs.reshape(-1, 2);
+
+  //motion bounds
+  arr B(pairs.d0);
+  for(uint i=0;i<pairs.d0;i++){
+    double Ba = getMotionBound(C.frames(pairs(i,0)), start, end);
+    double Bb = getMotionBound(C.frames(pairs(i,1)), start, end);
+    if(Ba<0. || Bb<0.) return -1;
+    B(i) = Ba+Bb;
+  }
+
+  rai::Proxy p;
+  double t=0.;
+  for(uint k=0;k<continuousMaxSteps;k++){
+    C.setJointState(start + t*(end-start));
+    evals++;
+    double dt=1.;
+    for(uint i=0;i<pairs.d0;i++){
+      p.a = C.frames(pairs(i,0));
+      p.b = C.frames(pairs(i,1));
+      p.calc_coll();
+      if(p.d<-collisionTolerance) return 0;
+      if(B(i)>0.) dt = rai::MIN(dt, (p.d+collisionTolerance)/B(i));
+    }
+    t += dt;
+    if(t>=1.) return 1;
+  }
+  return 0;
+}
+
+void ConfigurationProblem::clearCache(){
+  queryCache.clear();
+  edgeCache.clear();
+}
+
+void ConfigurationProblem::ensure_cache(){
+  //poses of the frames that the joint state does not move, and the feasibility criteria
+  FrameL F;
+  for(rai::Frame* f:C.frames){
+    rai::Frame* a=f;
+    while(a && !(a->joint && a->joint->active)) a=a->parent;
+    if(!a) F.append(f);
+  }
+  arr X = C.getFrameState(F);
+  X.reshape(-1);
+  for(double l:limits) X.append(l);
+  for(uint i:collisionPairs) X.append(i);
+  X.append({collisionTolerance, (double)computeAllCollisions, (double)continuousCheck, (double)objectives.N});
+  if(X.N!=cacheEnvironment.N || (X.N && maxDiff(X, cacheEnvironment)>0.)){
+    clearCache();
+    cacheEnvironment = X;
+  }
+}
+
+std::string ConfigurationProblem::cacheKey(const arr& x) const{
+  std::string key(x.N*sizeof(int64_t), 0);
+  int64_t* k = (int64_t*)&key[0];
+  for(uint i=0;i<x.N;i++) k[i] = llround(x.elem(i)/cacheResolution);
+  return key;
+}
+
+bool ConfigurationProblem::isWithinLimits(const arr& x) const{
   if(limits.N){
     for(uint i=0;i<x.N;i++){
-      if(limits(i,1)>limits(i,0) && (x.elem(i)<limits(i,0) || x.elem(i)>limits(i,1))){
-        //LOG(-1) <<"QUERY OUT OF LIMIT: joint " <<i <<": " <<x.elem(i) <<' ' <<limits[i];
-      }
+      if(limits(i,1)>limits(i,0) && (x.elem(i)<limits(i,0) || x.elem(i)>limits(i,1))) return false;
     }
   }
+  return true;
+}
 
+shared_ptr<QueryResult> ConfigurationProblem::query_uncached(const arr& x){
   C.setJointState(x);
   if(computeAllCollisions){
     //C.stepSwift();
@@ -107,7 +327,7 @@ shared_ptr<QueryResult> ConfigurationProblem::query(const arr& x){
   qr->coll_J.reshape(qr->coll_y.N, x.N);
 
   //is feasible?
-  qr->isFeasible = (!qr->coll_y.N || min(qr->coll_y)>=-collisionTolerance);
+  qr->isFeasible = isWithinLimits(x) && (!qr->coll_y.N || min(qr->coll_y)>=-collisionTolerance);
 
   //goal features
   N=0;
@@ -123,6 +343,7 @@ shared_ptr<QueryResult> ConfigurationProblem::query(const arr& x){
       qr->goal_y(i+j) = z(j);
       qr->goal_J[i+j] = z.J()[j];
     }
+    if(ob->type==OT_ineq && z.N && max(z)>0.) qr->isFeasible = false;
     i += z.N;
   }
   CHECK_EQ(i, N, "");
@@ -50,10 +50,37 @@ struct ConfigurationProblem {
   int verbose=0; //-> verbose
   uint evals=0;
 
+  //caching: query results and checked edges are stored under their configurations quantized to cacheResolution;
+  //a configuration within the same cell returns the stored result (without setting C). cacheResolution<=0: no caching
+  //the cache is cleared when C changes otherwise (frames that the joint state does not move are moved, added or removed)
+  //or the feasibility criteria change (objectives, collision pairs, collisionTolerance, limits, continuousCheck);
+  //this is checked once per query and once per checkConnection (not per interpolated configuration)
+  double cacheResolution=0.;
+  uint cacheHits=0;
+  std::unordered_map<std::string, shared_ptr<QueryResult>> queryCache;
+  std::unordered_map<std::string, bool> edgeCache;
+  arr cacheEnvironment; //poses of the frames not moved by the joint state and the criteria, for which the cache is valid
+
+  //continuous collision checking of edges (checkConnection) by conservative advancement, instead of sampling;
+  //same criteria as query: collisionTolerance, limits; edges of problems with inequality objectives are sampled
+  bool continuousCheck=false;
+  uint continuousMaxSteps=1000;
+
   ConfigurationProblem(const rai::Configuration& _C, bool _computeCollisions=true, double _collisionTolerance=1e-3);
+  shared_ptr<ConfigurationProblem> clone() const; ///< a copy with its own configuration (and collision engine), e.g. for concurrent queries
 
   shared_ptr<GroundedObjective> addObjective(const FeatureSymbol& feat, const StringA& frames, ObjectiveType type, const arr& scale=NoArr, const arr& target=NoArr);
   void setExplicitCollisionPairs(const StringA& _collisionPairs);
 
-  shared_ptr<QueryResult> query(const arr& x);
+  shared_ptr<QueryResult> query(const arr& x); ///< feasible: within limits, no collision deeper than collisionTolerance, inequality objectives <=0
+  bool isWithinLimits(const arr& x) const;
+  bool checkConnection(const arr& start, const arr& end, uint disc, bool binary); ///< are the configurations interpolating the straight edge feasible?
+  int checkConnectionContinuous(const arr& start, const arr& end); ///< 1: the straight edge is certified feasible; 0: not; -1: not applicable (joint types, objectives)
+  void clearCache();
+
+private:
+  shared_ptr<QueryResult> query_cached(const arr& x); ///< query, without checking that the cache is valid
+  shared_ptr<QueryResult> query_uncached(const arr& x);
+  std::string cacheKey(const arr& x) const;
+  void ensure_cache(); ///< clears the cache if the environment changed
 };
@@ -57,9 +57,22 @@ arr ReceedingHorizonPathSmoother::run(int verbose){
     komo.run(rai::OptOptions().set_stopIters(10));
     
     // get results from komo
+    arr previous = smoothed({i, i+horizon-1}).copy();
     for(uint j=0; j<horizon; ++j){
       smoothed[i+j] = komo.getConfiguration_qOrg(j);
     }
+
+    // the collision objectives only hold at the time slices: check the edges in between
+    if(checkEdges){
+      uint last = rai::MIN(i+horizon, smoothed.d0-1);
+      for(uint j=i; j<=last; ++j){
+        if(!P.checkConnection(smoothed[j-1], smoothed[j], 20, true)){
+          if(verbose>1) LOG(0) <<"smoothed window " <<i <<" has an infeasible edge -- keeping the previous one";
+          smoothed({i, i+horizon-1}) = previous;
+          break;
+        }
+      }
+    }
     
     if(disp){
       std::cout << komo.getReport(true, 0) << std::endl;
@@ -7,6 +7,7 @@ struct ReceedingHorizonPathSmoother {
   uint horizon;
   double totalDuration;
   const arr initialPath;
+  bool checkEdges=false; ///< keep a window's previous configurations if its smoothed edges are not collision-free (P.checkConnection, e.g. with P.continuousCheck)
 
   ReceedingHorizonPathSmoother(ConfigurationProblem& _P, const arr& initialPath, double _duration=20, uint _horizon=10)
     : P(_P),
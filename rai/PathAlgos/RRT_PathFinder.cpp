@@ -4,47 +4,6 @@
 #include "../Kin/viewer.h"
 #include "../GL/gl.h"
 
-double corput(uint n, uint base){
-  double q=0;
-  double bk=(double)1/base;
-
-  while (n > 0) {
-    q += (n % base)*bk;
-    n /= base;
-    bk /= base;
-  }
-  return q;
-}
-
-bool checkConnection(ConfigurationProblem& P,
-                     const arr &start,
-                     const arr &end,
-                     const uint disc,
-                     const bool binary){
-  if (binary){
-    for (uint i=1; i<disc; ++i){
-      double ind = corput(i, 2);
-      arr p = start + ind * (end-start);
-
-      // TODO: change to check feasibility properly (with path constraints)
-      if(!P.query(p)->isFeasible){
-        return false;
-      }
-    }
-  }
-  else{
-    for (uint i=1; i<disc-1; ++i){
-      arr p = start + 1.0 * i / (disc-1) * (end-start);
-
-      // TODO: change to check feasibility properly (with path constraints)
-      if(!P.query(p)->isFeasible){
-        return false;
-  }
-    }
-  }
-  return true;
-}
-
 //===========================================================================
 
 RRT_SingleTree::RRT_SingleTree(const arr& q0, const shared_ptr<QueryResult>& q0_qr){
@@ -52,11 +11,13 @@ RRT_SingleTree::RRT_SingleTree(const arr& q0, const shared_ptr<QueryResult>& q0_
   add(q0, 0, q0_qr);
 }
 
-uint RRT_SingleTree::add(const arr& q, uint parentID, const shared_ptr<QueryResult>& _qr){
+uint RRT_SingleTree::add(const arr& q, uint parentID, const shared_ptr<QueryResult>& _qr, bool _edgeChecked){
   drawMutex.lock(RAI_HERE);
   ann.append(q);
   parent.append(parentID);
   queries.append(_qr);
+  edgeChecked.append(_edgeChecked);
+  dead.append(false);
   disp3d.append(_qr->disp3d);
   disp3d.reshape(-1,3);
 
@@ -67,15 +28,35 @@ uint RRT_SingleTree::add(const arr& q, uint parentID, const shared_ptr<QueryResu
   return parent.N-1;
 }
 
+void RRT_SingleTree::kill(uint i){
+  if(dead(i)) return;
+  //children have larger indices than their parents
+  dead(i) = true;
+  nDead++;
+  for(uint j=i+1;j<dead.N;j++) if(!dead(j) && dead(parent(j))){ dead(j)=true; nDead++; }
+}
+
+uint RRT_SingleTree::getNN(const arr& target){
+  if(!nDead) return ann.getNN(target);
+  //the root is never dead
+  uintA idx;
+  for(uint k=8;;k*=2){
+    if(k>ann.X.d0) k=ann.X.d0;
+    ann.getkNN(idx, target, k);
+    for(uint i:idx) if(!dead(i)) return i;
+  }
+  return 0;
+}
+
 double RRT_SingleTree::getNearest(const arr& target){
   //find NN
-  nearestID = ann.getNN(target);
+  nearestID = getNN(target);
   return length(target - ann.X[nearestID]);
 }
 
 arr RRT_SingleTree::getProposalTowards(const arr& target, double stepsize){
   //find NN
-  nearestID = ann.getNN(target);
+  nearestID = getNN(target);
 
   //compute default step
   arr delta = target - ann.X[nearestID]; //difference vector between q and nearest neighbor
@@ -85,9 +66,9 @@ arr RRT_SingleTree::getProposalTowards(const arr& target, double stepsize){
   return getNode(nearestID) + delta;
 }
 
-arr RRT_SingleTree::getNewSample(const arr& target, double stepsize, double p_sideStep, bool& isSideStep, const uint recursionDepth){
+arr RRT_SingleTree::getNewSample(const arr& target, double stepsize, double p_sideStep, bool& isSideStep, const uint recursionDepth, rai::RndStream& r){
   //find NN
-  nearestID = ann.getNN(target);
+  nearestID = getNN(target);
   std::shared_ptr<QueryResult> qr = queries(nearestID);
 
   //compute default step
@@ -106,15 +87,15 @@ arr RRT_SingleTree::getNewSample(const arr& target, double stepsize, double p_si
     if(min(y)<0.) predictedCollision = true;
   }
 
-  if(predictedCollision && p_sideStep>0. && rnd.uni()<p_sideStep){
+  if(predictedCollision && p_sideStep>0. && r.uni()<p_sideStep){
     isSideStep=true;
 
     //compute new target
     arr d = qr->getSideStep();
-    d *= rnd.uni(stepsize,2.) / length(d);
+    d *= r.uni(stepsize,2.) / length(d);
     arr targ = getNode(nearestID) + d;
     bool tmp;
-    return getNewSample(targ, stepsize, p_sideStep, tmp, recursionDepth + 1);
+    return getNewSample(targ, stepsize, p_sideStep, tmp, recursionDepth + 1, r);
   }else{
     return getNode(nearestID) + delta;
   }
@@ -154,14 +135,14 @@ void RRT_SingleTree::glDraw(OpenGL& gl){
 bool RRT_PathFinder::growTreeTowardsRandom(RRT_SingleTree& rrt){
   const arr start = rrt.ann.X[0];
   arr t(rrt.getNode(0).N);
-  rndUniform(t,-RAI_2PI,RAI_2PI,false);
+  rndUniform(t, rndStream, -RAI_2PI, RAI_2PI, false);
   HALT("DON'T USE 2PI")
 
   arr q = rrt.getProposalTowards(t, stepsize);
 
   auto qr = P.query(q);
   if(qr->isFeasible){
-    if (intermediateCheck && !checkConnection(P, start, q, 20, true)){
+    if (intermediateCheck && !P.checkConnection(start, q, 20, true)){
       return false;
     }
 
@@ -175,8 +156,8 @@ bool RRT_PathFinder::growTreeToTree(RRT_SingleTree& rrt_A, RRT_SingleTree& rrt_B
   bool isSideStep, isForwardStep;
   //decide on a target: forward or random
   arr t;
-  if(rnd.uni()<p_forwardStep){
-    t = rrt_B.getRandomNode();
+  if(rndStream.uni()<p_forwardStep){
+    t = rrt_B.getRandomNode(rndStream);
     isForwardStep = true;
   }else{
 #if 1
@@ -184,17 +165,17 @@ bool RRT_PathFinder::growTreeToTree(RRT_SingleTree& rrt_A, RRT_SingleTree& rrt_B
     for(uint i=0;i<t.N;i++){
       double lo=P.limits(i,0), up=P.limits(i,1);
       CHECK_GE(up-lo, 1e-3,"limits are null interval: " <<i <<' ' <<P.C.getJointNames());
-      t.elem(i) = lo + rnd.uni()*(up-lo);
+      t.elem(i) = lo + rndStream.uni()*(up-lo);
     }
 #else
     t.resize(rrt_A.getNode(0).N);
-    rndUniform(t,-RAI_2PI,RAI_2PI,false);
+    rndUniform(t, rndStream, -RAI_2PI, RAI_2PI, false);
 #endif
     isForwardStep = false;
   }
 
   //sample configuration towards target, possibly sideStepping
-  arr q = rrt_A.getNewSample(t, stepsize, p_sideStep, isSideStep, 0);
+  arr q = rrt_A.getNewSample(t, stepsize, p_sideStep, isSideStep, 0, rndStream);
 
   //evaluate the sample
   auto qr = P.query(q);
@@ -203,9 +184,9 @@ bool RRT_PathFinder::growTreeToTree(RRT_SingleTree& rrt_A, RRT_SingleTree& rrt_B
   if(isSideStep){  n_sideStep++; if(qr->isFeasible) n_sideStepGood++; }
 
   //if infeasible, make a backward step from the sample configuration
-  if(!qr->isFeasible && p_backwardStep>0. && rnd.uni()<p_backwardStep){
+  if(!qr->isFeasible && p_backwardStep>0. && rndStream.uni()<p_backwardStep){
     t = q + qr->getBackwardStep();
-    q = rrt_A.getNewSample(t, stepsize, p_sideStep, isSideStep, 0);
+    q = rrt_A.getNewSample(t, stepsize, p_sideStep, isSideStep, 0, rndStream);
     qr = P.query(q);
     n_backStep++; if(qr->isFeasible) n_backStepGood++;
     if(isSideStep){  n_sideStep++; if(qr->isFeasible) n_sideStepGood++; }
@@ -214,11 +195,12 @@ bool RRT_PathFinder::growTreeToTree(RRT_SingleTree& rrt_A, RRT_SingleTree& rrt_B
   // TODO: add checking motion
   if(qr->isFeasible){
     const arr start = rrt_A.ann.X[rrt_A.nearestID];
-    if (intermediateCheck && !checkConnection(P, start, q, 20, true)){
+    bool lazy = intermediateCheck && lazyEdgeCheck;
+    if (intermediateCheck && !lazy && !P.checkConnection(start, q, 20, true)){
       return false;
     }
 
-    rrt_A.add(q, rrt_A.nearestID, qr);
+    rrt_A.add(q, rrt_A.nearestID, qr, !lazy);
     double dist = rrt_B.getNearest(q);
     if(dist<stepsize) return true;
   }
@@ -231,7 +213,8 @@ RRT_PathFinder::RRT_PathFinder(ConfigurationProblem& _P, const arr& _starts, con
   : P(_P),
     stepsize(_stepsize),
     verbose(_verbose),
-    intermediateCheck(_intermediateCheck) {
+    intermediateCheck(_intermediateCheck),
+    rndStream(rnd.num()) {
   arr q0 = _starts;
   arr qT = _goals;
   auto q0ret = P.query(q0);
@@ -305,6 +288,7 @@ int RRT_PathFinder::stepConnect(){
 
   bool success = growTreeToTree(*rrt0, *rrtT);
   if(!success) success = growTreeToTree(*rrtT, *rrt0);
+  if(success && intermediateCheck && lazyEdgeCheck) success = checkCandidatePath(P, rrt0->nearestID, rrtT->nearestID);
 
   //animation display
   if(verbose>2){
@@ -356,12 +340,115 @@ int RRT_PathFinder::stepConnect(){
 }
 
 arr RRT_PathFinder::planConnect(){
+  if(threads>1) return planConnectParallel();
   int r=0;
   while(!r){ r = stepConnect(); }
   if(r==-1) return NoArr;
   return path;
 }
 
+/** RRT-Connect with several workers: each alternates between extending rrt0 and rrtT (towards a random node of the other
+ *  tree or a random configuration), and queries the new configuration on its own copy of P. Only the nearest neighbor
+ *  lookups and insertions lock the trees; the queries (FK and collisions, which dominate) run concurrently. Side and
+ *  backward steps are not done. maxIters counts pairs of extensions, as in stepConnect. The result is not deterministic,
+ *  as the trees depend on the order in which workers finish their queries. */
+arr RRT_PathFinder::planConnectParallel(){
+  rai::Array<shared_ptr<ConfigurationProblem>> problems(threads);
+  for(shared_ptr<ConfigurationProblem>& p:problems) p = P.clone();
+  uint64_t seed = rndStream.next();
+  uint dim = rrt0->getDim();
+
+  Mutex treeMutex;
+  std::atomic<uint> extensions(2*iters);
+  std::atomic<bool> success(false);
+  WorkerPool pool(threads);
+  pool.run(threads, [&](uint w, uint){
+    ConfigurationProblem& Pw = *problems(w);
+    rai::RndStream r(seed, w);
+    uint nForward=0, nForwardGood=0, nRnd=0, nRndGood=0;
+    arr t(dim), q, start;
+    for(uint k=w; !success && extensions++<2*maxIters; k++){
+      RRT_SingleTree& A = (k%2 ? *rrtT : *rrt0);
+      RRT_SingleTree& B = (k%2 ? *rrt0 : *rrtT);
+      bool isForwardStep = r.uni()<p_forwardStep;
+      if(!isForwardStep) for(uint i=0;i<dim;i++) t.elem(i) = r.uni(P.limits(i,0), P.limits(i,1));
+
+      uint nearest;
+      {
+        auto lock = treeMutex(RAI_HERE);
+        if(isForwardStep) t = B.getNode(r.num(B.getNumberNodes()));
+        nearest = A.getNN(t);
+        start = A.getNode(nearest);
+      }
+
+      arr delta = t - start;
+      double dist = length(delta);
+      if(dist>stepsize) delta *= stepsize/dist;
+      q = start + delta;
+
+      auto qr = Pw.query(q);
+      if(isForwardStep){ nForward++; if(qr->isFeasible) nForwardGood++; }
+      else{ nRnd++; if(qr->isFeasible) nRndGood++; }
+      if(!qr->isFeasible) continue;
+      bool lazy = intermediateCheck && lazyEdgeCheck;
+      if(intermediateCheck && !lazy && !Pw.checkConnection(start, q, 20, true)) continue;
+
+      auto lock = treeMutex(RAI_HERE);
+      if(success) break;
+      if(A.dead(nearest)) continue; //cut meanwhile
+      uint id = A.add(q, nearest, qr, !lazy);
+      uint idB = B.getNN(q);
+      if(length(q - B.ann.X[idB])<stepsize){
+        //the lazy check of the candidate runs under the lock: other workers must not extend the nodes it may cut
+        if(lazy && !checkCandidatePath(Pw, (k%2 ? idB : id), (k%2 ? id : idB))) continue;
+        A.nearestID = id;
+        B.nearestID = idB;
+        success = true;
+      }
+    }
+
+    auto lock = treeMutex(RAI_HERE);
+    n_forwardStep += nForward;  n_forwardStepGood += nForwardGood;
+    n_rndStep += nRnd;  n_rndStepGood += nRndGood;
+  });
+
+  iters = rai::MIN(extensions, 2*maxIters)/2;
+  for(shared_ptr<ConfigurationProblem>& p:problems){
+    P.evals += p->evals;
+    P.cacheHits += p->cacheHits;
+    P.queryCache.insert(p->queryCache.begin(), p->queryCache.end());
+    P.edgeCache.insert(p->edgeCache.begin(), p->edgeCache.end());
+  }
+
+  if(verbose>0){
+    std::cout <<(success ? "\nSUCCESS!" : "\nFAILED") <<" (" <<threads <<" threads)" <<std::endl;
+    std::cout <<"  RRT queries=" <<P.evals <<" tree sizes = " <<rrt0->getNumberNodes()  <<' ' <<rrtT->getNumberNodes() <<std::endl;
+  }
+  if(!success) return NoArr;
+
+  path = rrt0->getPathFromNode(rrt0->nearestID);
+  arr pathT = rrtT->getPathFromNode(rrtT->nearestID);
+  revertPath(path);
+  path.append(pathT);
+  return path;
+}
+
+/** Checks the unchecked edges on the path from the root of rrt0 via node id0, node idT of rrtT, to the root of rrtT
+ *  (the connecting edge is not checked, as in the non-lazy case). An infeasible edge cuts the subtree below it. */
+bool RRT_PathFinder::checkCandidatePath(ConfigurationProblem& P, uint id0, uint idT){
+  for(RRT_SingleTree* rrt:{rrt0.get(), rrtT.get()}){
+    for(uint i=(rrt==rrt0.get() ? id0 : idT); i; i=rrt->parent(i)){
+      if(rrt->edgeChecked(i)) continue;
+      if(!P.checkConnection(rrt->ann.X[rrt->parent(i)], rrt->ann.X[i], 20, true)){
+        rrt->kill(i);
+        return false;
+      }
+      rrt->edgeChecked(i) = true;
+    }
+  }
+  return true;
+}
+
 void revertPath(arr& path){
   uint N = path.d0;
   arr x;
@@ -10,6 +10,9 @@ struct RRT_SingleTree : GLDrawer {
   ANN ann;         //ann stores all points added to the tree in ann.X
   uintA parent;    //for each point we also store the index of the parent node
   rai::Array<shared_ptr<QueryResult>> queries;
+  boolA edgeChecked; //for each point: is the edge from its parent checked (for lazy edge checking)?
+  boolA dead;        //for each point: is an edge on its way to the root infeasible? (dead nodes are never nearest)
+  uint nDead=0;
 
   //fields for display (GLDrawer..)
   arr disp3d;
@@ -20,13 +23,15 @@ struct RRT_SingleTree : GLDrawer {
   RRT_SingleTree(const arr& q0, const shared_ptr<QueryResult>& q0_qr);
 
   //core method
+  uint getNN(const arr& target); //nearest node that is not dead
   double getNearest(const arr& target);
   arr getProposalTowards(const arr& target, double stepsize);
 
-  arr getNewSample(const arr& target, double stepsize, double p_sideStep, bool& isSideStep, const uint recursionDepth);
+  arr getNewSample(const arr& target, double stepsize, double p_sideStep, bool& isSideStep, const uint recursionDepth, rai::RndStream& r);
 
   //trivial
-  uint add(const arr& q, uint parentID, const shared_ptr<QueryResult>& _qr);
+  uint add(const arr& q, uint parentID, const shared_ptr<QueryResult>& _qr, bool _edgeChecked=true);
+  void kill(uint i); //mark node i and its subtree dead
 
   //trivial access routines
   uint getParent(uint i){ return parent(i); }
@@ -34,7 +39,7 @@ struct RRT_SingleTree : GLDrawer {
   uint getDim(){ return ann.X.d1; }
   arr getNode(uint i){ return ann.X[i].copy(); }
   arr getLast(){ return ann.X[ann.X.d0-1].copy(); }
-  arr getRandomNode(){ return ann.X[rnd(ann.X.d0)].copy(); }
+  arr getRandomNode(rai::RndStream& r){ return ann.X[r.num(ann.X.d0)].copy(); }
   arr getPathFromNode(uint fromID);
 
   void glDraw(OpenGL &gl);
@@ -55,9 +60,12 @@ struct RRT_PathFinder {
   uint maxIters=5000;
   uint verbose;
   bool intermediateCheck;
+  bool lazyEdgeCheck=false; ///< with intermediateCheck: check edges only once they are on a candidate path (and cut infeasible ones)
   double p_forwardStep=.5;
   double p_sideStep=.0;
   double p_backwardStep=.0;
+  uint threads=0; ///< number of workers extending both trees concurrently in planConnect (<=1: serial stepConnect)
+  rai::RndStream rndStream; ///< the planner's samples (seeded from the global rnd on construction); parallel workers use streams of a seed drawn from it
 
   //counters
   uint iters=0;
@@ -72,9 +80,11 @@ struct RRT_PathFinder {
   int stepConnect();
   void planForward(const arr& q0, const arr& qT);
   arr planConnect(); //default numbers: equivalent to standard bidirect
+  arr planConnectParallel(); //called by planConnect if threads>1
 
   bool growTreeTowardsRandom(RRT_SingleTree& rrt);
   bool growTreeToTree(RRT_SingleTree& rrt_A, RRT_SingleTree& rrt_B);
+  bool checkCandidatePath(ConfigurationProblem& P, uint id0, uint idT); //lazy edge checking of the path via nodes id0 and idT
 
   virtual shared_ptr<PathResult> run(double timeBudget=1.); //obsolete
 
@@ -25,21 +25,74 @@ void TEST(ANN) {
   rai::wait();
 }
 
+/// brute force: indices of all rows of X, nearest to q first, and their squared (weighted) distances
+uintA bruteForce(arr& D, const arr& X, const arr& q, const arr& w=NoArr){
+  arr d = X - repmat(~q, X.d0, 1);
+  if(!!w && w.N) d = d % repmat(~sqrt(w), X.d0, 1);
+  arr Dall = sum(sqr(d), 1);
+  uintA idx(X.d0);
+  for(uint i=0;i<idx.N;i++) idx(i)=i;
+  std::sort(idx.p, idx.p+idx.N, [&Dall](uint a, uint b){ return Dall(a)<Dall(b); });
+  D.resize(idx.N);
+  for(uint i=0;i<idx.N;i++) D(i) = Dall(idx(i));
+  return idx;
+}
+
 void TEST(ANNIncremental) {
   uint N=1000,dim=2;
 
   ANN ann;
-  ann.bufferSize=20;
-  arr x(dim),q(dim),Q;
-  intA idx;
-  
+  arr x(dim),q(dim),dists,D;
+  uintA idx;
+
   rndUniform(q,0.,1.,false); //constant query point
   for(uint i=0;i<N;i++){
     rndUniform(x,0.,1.,false);
     ann.append(x);
     if(i>10){
-      ann.getkNN(Q,q,10,.0, true);
-      //rai::wait();
+      ann.getkNN(dists,idx,q,10);
+      uintA bf = bruteForce(D, ann.X, q);
+      for(uint k=0;k<10;k++){
+        CHECK_EQ(idx(k), bf(k), "wrong neighbor");
+        CHECK_ZERO(dists(k)-D(k), 1e-10, "wrong distance");
+      }
+    }
+  }
+
+  //radius query: the same points as brute force, nearest first
+  ann.getRadiusNN(dists,idx,q,.1);
+  uintA bf = bruteForce(D, ann.X, q);
+  uint n=0;
+  while(n<D.N && D(n)<=.01) n++;
+  std::cout <<"#points within .1: " <<idx.N <<std::endl;
+  CHECK(n>0, "the test needs points within the radius");
+  CHECK_EQ(idx.N, n, "wrong number of points within the radius");
+  for(uint k=0;k<n;k++){
+    CHECK_EQ(idx(k), bf(k), "wrong point within the radius");
+    CHECK_ZERO(dists(k)-D(k), 1e-10, "");
+  }
+
+  //weighted metric
+  ann.weights = {4., .25};
+  ann.getkNN(dists,idx,q,10);
+  bf = bruteForce(D, ann.X, q, ann.weights);
+  for(uint k=0;k<10;k++){
+    CHECK_EQ(idx(k), bf(k), "wrong weighted neighbor");
+    CHECK_ZERO(dists(k)-D(k), 1e-10, "");
+  }
+  ann.weights.clear();
+
+  //batch queries agree with brute force row by row
+  arr Q(20,dim);
+  rndUniform(Q,0.,1.,false);
+  ann.getkNN_batch(dists,idx,Q,5);
+  CHECK_EQ(idx.d0, Q.d0, "");
+  CHECK_EQ(idx.d1, 5, "");
+  for(uint i=0;i<Q.d0;i++){
+    bf = bruteForce(D, ann.X, Q[i]);
+    for(uint k=0;k<5;k++){
+      CHECK_EQ(idx(i,k), bf(k), "wrong batch neighbor");
+      CHECK_ZERO(dists(i,k)-D(k), 1e-10, "");
     }
   }
 }
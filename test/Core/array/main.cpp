@@ -845,6 +845,44 @@ void TEST(SparseMatrix){
 
 //===========================================================================
 
+void TEST(SparseAssembly){
+  cout <<"\n*** SparseAssembly\n";
+
+  rai::SparseAssembly assembly;
+  arr J;
+  for(uint k=0;k<10;k++){
+    //stack two sparse blocks and a dense one: values change each time, the pattern only at k=5
+    arr A(3,8), B(2,8), C=zeros(1,8);
+    rndInteger(A,1,3);
+    rndInteger(B,1,3);
+    A(0,4)=0.;
+    if(k>=5) B(1,2)=0.;
+    C(0,1)=1.+k;
+    arr D = A;
+    D.append(B);
+    D.append(C);
+    A.sparse();
+    B.sparse();
+
+    assembly.begin(J, 6, 8);
+    assembly.add(J, A, 0);
+    assembly.add(J, B, 3);
+    assembly.add(J, C, 5);
+    assembly.end(J);
+
+    CHECK_ZERO(maxDiff(J.sparse().unsparse(), D), 1e-10, "");
+    uint nonZeros=0;
+    for(double d:D) if(d) nonZeros++;
+    CHECK_EQ(J.N, nonZeros, "the zeros of the dense block must not be stored");
+    J.sparse().ensureRowsCols();
+    J.sparse().checkConsistency();
+  }
+  cout <<"reused pattern " <<assembly.reuseCount <<" times, rebuilt " <<assembly.rebuildCount <<" times" <<endl;
+  CHECK_EQ(assembly.rebuildCount, 2, "");
+}
+
+//===========================================================================
+
 void TEST(SparseVector){
   cout <<"\n*** SparseVector\n";
 
@@ -940,6 +978,7 @@ int MAIN(int argc, char **argv){
   testRowShifted();
   testSparseVector();
   testSparseMatrix();
+  testSparseAssembly();
   testInverse();
   testMM();
   testSVD();
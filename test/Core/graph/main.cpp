@@ -1,5 +1,7 @@
 #include <Core/graph.h>
 
+#include <thread>
+
 //const char *filename="/home/mtoussai/git/3rdHand/documents/USTT/14-meeting3TUD/box.g";
 const char *filename=nullptr;
 
@@ -132,6 +134,54 @@ void TEST(Random){
 
 //===========================================================================
 
+void TEST(KeyIndex){
+  rai::Graph G;
+  for(uint i=0;i<100;i++) G.newNode<double>(STRING('k' <<i%30), {}, double(i));
+  rai::Graph& S = G.newSubgraph("sub");
+  S.newNode<double>("inner", {}, -1.);
+
+  auto check = [&G](){
+    for(uint i=0;i<40;i++){
+      rai::String key = STRING('k' <<i);
+      rai::NodeL L;
+      for(rai::Node *n:G) if(n->key==key) L.append(n);
+      CHECK((G.findNodes(key)==L), "key index broken for '" <<key <<"'");
+      CHECK_EQ(G.findNode(key), (L.N?L(0):0), "");
+      CHECK_EQ(G.findNodeOfType(typeid(double), key), (L.N?L(0):0), "");
+    }
+  };
+  check();
+  CHECK_EQ(G.get<double>("k3"), 3., "");
+  CHECK_EQ(S.findNode("k3", true), G["k3"], "recurse up");
+  CHECK_EQ(G.findNode("inner", false, true), S["inner"], "recurse down");
+
+  G.newNode<double>("k31", {}, 31.);  check();
+  delete G["k2"];                     check();
+  G.delNode(G.last());                check();
+  G["k4"]->setKey("k35");             check(); //renamed onto a new key
+  G["k5"]->setKey("k6");              check(); //renamed onto an existing key
+  G.elem(1)->setKey("k8");            check(); //... before the indexed nodes of that key
+  G.newNode<double>("k9", {}, 9.);
+  delete G.elem(5);                   check();
+  G.last()->setKey("k1");             check(); //... after a deletion in the middle (stale node indices)
+  G.index();
+  rai::Graph H = G;
+  CHECK_EQ(H.findNodes("k7").N, G.findNodes("k7").N, "");
+  G.clear();
+  CHECK(!G.findNode("k7"), "");
+
+  //concurrent lookups extend the index of a shared graph
+  rai::Graph P;
+  for(uint i=0;i<200;i++) P.newNode<double>(STRING('p' <<i), {}, double(i));
+  std::vector<std::thread> threads;
+  for(uint t=0;t<4;t++) threads.emplace_back([&P](){
+    for(uint i=0;i<200;i++) CHECK_EQ(P.get<double>(STRING('p' <<i)), double(i), "");
+  });
+  for(std::thread& th:threads) th.join();
+}
+
+//===========================================================================
+
 void TEST(Dot){
   rai::Graph G;
   G <<FILE(filename?filename:"coffee_shop.fg");
@@ -169,6 +219,7 @@ int MAIN(int argc, char** argv){
   testRandom();
   testRead();
   testInit();
+  testKeyIndex();
   testDot();
 
   testManual();
@@ -203,6 +203,84 @@ void TEST(Logging){
 
 //===========================================================================
 
+void TEST(WorkerPool){
+  WorkerPool pool(4);
+  arr x(1000);
+  for(uint k=0; k<3; k++){ //reuse the same workers for multiple jobs
+    x.setZero();
+    pool.run(x.N, [&x, k](uint i, uint worker){ x(i) = i+k; });
+    for(uint i=0; i<x.N; i++) CHECK_EQ(x(i), i+k, "");
+  }
+
+  bool caught=false;
+  try{
+    pool.run(100, [](uint i, uint worker){ if(i==50) HALT("failing item"); });
+  }catch(...){ caught=true; }
+  CHECK(caught, "exception of an item was not rethrown");
+}
+
+//===========================================================================
+
+struct MyMsg{
+  double a, b, c;
+  uint i;
+};
+
+void TEST(SeqVar){
+  //one writer and several readers: readers never see a torn message and revisions only increase
+  SeqVar<MyMsg> x;
+  CHECK_EQ(x.getRevision(), 0, "");
+  std::atomic<uint> notified(0);
+  x.addCallback([&notified](Var_base* v){
+    CHECK(!v->rwlock.isLocked(), "callbacks must be called outside of the lock");
+    notified++;
+  });
+
+  uint N=100000;
+  std::thread writer([&x, N](){
+    for(uint k=1; k<=N; k++){
+      auto msg = x.set();
+      msg->a = msg->b = msg->c = k;
+      msg->i = k;
+    }
+  });
+
+  rai::Array<std::shared_ptr<std::thread>> readers(3);
+  std::atomic<uint> reads(0);
+  for(auto& r:readers) r = make_shared<std::thread>([&x, &reads, N](){
+    SeqVar<MyMsg> y(nullptr, x); //an access of the same variable
+    uint last=0;
+    while(last<N){
+      MyMsg m = y.get();
+      CHECK(m.a==m.i && m.b==m.i && m.c==m.i, "torn read");
+      CHECK_EQ((uint)y.last_read_revision, m.i, "revision does not match the data");
+      CHECK_GE(m.i, last, "revisions decreased");
+      last = m.i;
+      reads++;
+    }
+  });
+
+  //events start and stop listening while the writer notifies
+  rai::Array<std::shared_ptr<std::thread>> events(2);
+  for(auto& e:events) e = make_shared<std::thread>([&x](){
+    for(uint k=0; k<1000; k++){
+      Event ev;
+      ev.listenTo(*x.data);
+      ev.stopListenTo(*x.data);
+    }
+  });
+
+  writer.join();
+  for(auto& r:readers) r->join();
+  for(auto& e:events) e->join();
+  cout <<"reads: " <<reads <<" revision: " <<x.getRevision() <<endl;
+  CHECK_EQ((uint)x.getRevision(), N, "");
+  CHECK_EQ(notified, N, "");
+  CHECK_EQ(x.get()->i, N, "");
+}
+
+//===========================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc, argv);
 
@@ -213,6 +291,8 @@ int MAIN(int argc,char** argv){
   testWay0();
   testWay1();
   testLogging();
+  testWorkerPool();
+  testSeqVar();
 
   return 0;
 }
@@ -1,7 +1,10 @@
 #include <Core/util.h>
 #include <Core/graph.h>
+#include <Core/trace.h>
 #include <math.h>
 #include <iomanip>
+#include <thread>
+#include <atomic>
 
 void TEST(String){
   //-- basic IO
@@ -105,6 +108,88 @@ void TEST(Inotify){
   }
 }
 
+void TEST(Trace){
+  //scopes are recorded when closed, with their nesting depth (here directly, RAI_TRACE_SCOPE only compiles with -DRAI_TRACE)
+  rai::trace::clear();
+  {
+    rai::trace::Scope outer("outer");
+    for(uint i=0;i<3;i++){
+      rai::trace::Scope inner("inner");
+      rai::wait(.001);
+    }
+  }
+  uint t = rai::trace::getThreadCount()-1;
+  std::vector<rai::trace::Event> E = rai::trace::getEvents(t);
+  CHECK_EQ(E.size(), 4, "");
+  for(uint i=0;i<3;i++){
+    CHECK(!strcmp(E[i].name, "inner"), "");
+    CHECK_EQ(E[i].depth, 1, "");
+  }
+  CHECK(!strcmp(E[3].name, "outer"), "");
+  CHECK_EQ(E[3].depth, 0, "");
+  CHECK_GE(E[3].duration, E[0].duration+E[1].duration+E[2].duration, "");
+  CHECK_GE(E[0].start, E[3].start, "");
+
+  rai::trace::write("z.trace.json"); //load in chrome://tracing
+  std::ifstream fil("z.trace.json");
+  std::string json((std::istreambuf_iterator<char>(fil)), std::istreambuf_iterator<char>());
+  CHECK(json.find("{\"name\":\"outer\",\"ph\":\"X\"")!=std::string::npos, "");
+
+  //snapshots and clears while another thread records into a small ring buffer: events are never torn
+  uint32_t size=rai::trace::bufferSize;
+  rai::trace::bufferSize=63; //odd: an event is overwritten by one of the other parity
+  std::atomic<bool> stop(false);
+  std::thread recorder([&stop](){
+    static const char* names[2]={"even", "odd"};
+    for(uint32_t i=0; !stop; i++) rai::trace::record(names[i%2], i, i%2, i%2);
+  });
+  while(rai::trace::getThreadCount()<=t+1) std::this_thread::yield();
+  for(uint k=0;k<2000;k++){
+    for(const rai::trace::Event& e:rai::trace::getEvents(t+1)){
+      CHECK_LE(e.depth, 1, "");
+      CHECK(!strcmp(e.name, e.depth?"odd":"even"), "torn event");
+      CHECK_EQ(e.duration, e.start%2, "torn event");
+    }
+    if(k%100==0) rai::trace::clear();
+  }
+  stop=true;
+  recorder.join();
+  rai::trace::bufferSize=size;
+}
+
+void TEST(RndStream){
+  //streams are reproducible, and different streams differ
+  rai::RndStream a(7, 2), b(7, 2), c(7, 3);
+  for(uint i=0;i<100;i++){
+    uint64_t x=a.next();
+    CHECK_EQ(x, b.next(), "");
+    CHECK(x!=c.next(), "");
+  }
+  rnd.seed(3);
+  CHECK_EQ(rnd.stream(5).next(), rai::RndStream(3, 5).next(), "");
+
+  //threads filling with their own stream give the same as filling serially
+  const uint n=100000, T=4;
+  std::vector<double> serial(T*n), parallel(T*n);
+  for(uint t=0;t<T;t++) rai::RndStream(7, t).gauss(&serial[t*n], n);
+  std::vector<std::thread> threads;
+  for(uint t=0;t<T;t++) threads.emplace_back([&parallel, t, n](){ rai::RndStream(7, t).gauss(&parallel[t*n], n); });
+  for(std::thread& th:threads) th.join();
+  CHECK(serial==parallel, "");
+
+  //moments
+  double m=0., v=0., u=0.;
+  for(double x:serial){ m+=x; v+=x*x; }
+  m/=serial.size();  v=v/serial.size()-m*m;
+  rai::RndStream r(1);
+  for(uint i=0;i<n;i++) u += r.uni();
+  u/=n;
+  cout <<"gauss mean:" <<m <<" var:" <<v <<" uniform mean:" <<u <<endl;
+  CHECK_LE(std::abs(m), .01, "");
+  CHECK_LE(std::abs(v-1.), .01, "");
+  CHECK_LE(std::abs(u-.5), .01, "");
+}
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
@@ -120,6 +205,8 @@ int MAIN(int argc,char** argv){
   testLogging();
   testException();
   testInotify();
+  testTrace();
+  testRndStream();
 
   return 0;
 }
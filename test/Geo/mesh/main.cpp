@@ -5,6 +5,7 @@
 #include <Gui/opengl.h>
 #include <Geo/qhull.h>
 #include <Geo/signedDistanceFunctions.h>
+#include <Geo/meshBVH.h>
 
 #include <math.h>
 
@@ -234,6 +235,137 @@ void TEST(SimpleImplicitSurfaces) {
 
 //===========================================================================
 
+void TEST(BVH){
+  rai::Mesh m;
+  m.setSphere(3);
+  m.scale(.5, .3, .2);
+
+  //single triangles as brute force reference
+  rai::Array<rai::Mesh> tris(m.T.d0);
+  for(uint t=0;t<m.T.d0;t++){ tris(t).V = m.V.sub(m.T[t]);  tris(t).T = uintA{0,1,2}.reshape(1,3); }
+
+  arr p;
+  uint tri;
+  for(uint k=0;k<100;k++){
+    arr x = .3*randn(3);
+    double d = m.closestPoint(p, tri, x);
+    double dmin=1e10;
+    for(rai::Mesh& t:tris) dmin = rai::MIN(dmin, t.closestPoint(p, tri, x));
+    CHECK_ZERO((d-dmin), 1e-10, "wrong closest point");
+
+    double sd = m.signedDistance(x);
+    double e = rai::sqr(x(0)/.5)+rai::sqr(x(1)/.3)+rai::sqr(x(2)/.2);
+    if(fabs(sd)>1e-2) CHECK((sd<0.)==(e<1.), "wrong sign");
+
+    arr o = randn(3), dir = randn(3);
+    double tHit, tmin=1e10;
+    bool hit = m.rayCast(tHit, tri, o, dir);
+    for(rai::Mesh& t:tris) if(t.rayCast(d, tri, o, dir)) tmin = rai::MIN(tmin, d);
+    CHECK(hit==(tmin<1e10), "wrong ray hit");
+    if(hit) CHECK_ZERO((tHit-tmin), 1e-10, "wrong ray hit");
+  }
+
+  //axis-aligned rays (zero direction components), also with origins on the symmetry planes of the mesh (and its boxes)
+  for(uint k=0;k<30;k++){
+    uint i=k%3;
+    arr o = .3*randn(3), dir = zeros(3);
+    if(k%2) o((i+1)%3) = 0.;
+    o(i) = 1.;
+    dir(i) = -1.;
+    double tHit, d, tmin=1e10;
+    bool hit = m.rayCast(tHit, tri, o, dir);
+    for(rai::Mesh& t:tris) if(t.rayCast(d, tri, o, dir)) tmin = rai::MIN(tmin, d);
+    CHECK(hit==(tmin<1e10), "wrong axis-aligned ray hit");
+    if(hit) CHECK_ZERO((tHit-tmin), 1e-10, "wrong axis-aligned ray hit");
+  }
+  double tHit;
+  CHECK(m.rayCast(tHit, tri, {0., 0., 1.}, {0., 0., -1.}), "a ray through the center misses");
+  CHECK(tHit>.79 && tHit<=.8, "");
+
+  rai::Mesh m2;
+  m2.setSphere(2);
+  m2.scale(.2);
+  uint n=0;
+  for(uint k=0;k<100;k++){
+    rai::Transformation rel;
+    rel.setRandom();
+    rel.pos.set(rnd.uni(-.7,.7), rnd.uni(-.5,.5), rnd.uni(-.4,.4));
+    double d = m.signedDistance(rel.pos.getArr());
+    if(d>.21) CHECK(!m.overlaps(m2, rel), "");
+    if(d<.19 && d>-.01) { CHECK(m.overlaps(m2, rel), "");  n++; }
+  }
+  cout <<"BVH nodes: " <<m.bvh()->nodes.size() <<" checked overlaps: " <<n <<endl;
+}
+
+//===========================================================================
+
+void TEST(MeshVersion){
+  rai::Mesh m;
+  m.setSphere(3);
+  m.fuseNearVertices();
+  m.buildGraph();
+  m.convexVersion = m.version; //declare convex (as makeConvexHull does)
+
+  //hill-climbing support = brute force
+  m.scale(.5, .3, .2);
+  CHECK(m.isConvex(), "scaling keeps convexity");
+  for(uint k=0;k<100;k++){
+    arr dir = randn(3);
+    uint i = m.support(dir.p);
+    CHECK_ZERO(scalarProduct(m.V[i], dir) - max(m.V*dir), 1e-10, "wrong support");
+  }
+
+  //mutators that may break convexity reset it
+  rai::Mesh m2 = m;
+  m2.addMesh(m, rai::Transformation().setRandom());
+  CHECK(!m2.isConvex(), "addMesh keeps convexity");
+  m2 = m;
+  m2.subDivide();
+  CHECK(!m2.isConvex(), "subDivide keeps convexity");
+
+  //the BVH is rebuilt after in-place edits announced by changed()
+  arr p;
+  uint tri;
+  double d0 = m.closestPoint(p, tri, {0., 0., 1.});
+  m.V *= 2.;
+  m.changed();
+  double d1 = m.closestPoint(p, tri, {0., 0., 1.});
+  CHECK_ZERO(d1-(1.-.4), 1e-10, "");
+  CHECK_ZERO(d0-(1.-.2), 1e-10, "");
+}
+
+//===========================================================================
+
+void TEST(MeshSDF){
+  rai::Transformation pose;
+  pose.setRandom();
+  auto box = make_shared<rai::Mesh>();
+  box->setBox();
+  box->scale(.4, .6, .8);
+  SDF_Mesh f(pose, box);
+
+  //the signed distance of a box mesh is the analytic one, with the gradient outside
+  SDF_ssBox ref(pose, arr{.4, .6, .8});
+  for(uint k=0;k<100;k++){
+    arr x = pose.pos.getArr() + .5*randn(3);
+    double d = f.f(NoArr, NoArr, x);
+    CHECK_ZERO(d-ref.f(NoArr, NoArr, x), 1e-10, "wrong signed distance");
+    if(d>1e-3) CHECK(checkGradient(f, x, 1e-5), "wrong gradient");
+  }
+
+  //the SDF holds the tree; a held tree stays valid when a changed mesh replaces it
+  shared_ptr<rai::MeshBVH> B = box->bvh();
+  CHECK_EQ(B, f.bvh, "");
+  box->scale(2.);
+  CHECK(box->bvh()!=B, "the tree was not rebuilt");
+  CHECK_EQ(B->nT, box->T.d0, "");
+  SDF_ssBox ref2(pose, arr{.8, 1.2, 1.6});
+  arr x = pose.pos.getArr() + randn(3);
+  CHECK_ZERO(f.f(NoArr, NoArr, x)-ref2.f(NoArr, NoArr, x), 1e-10, "");
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
@@ -245,6 +377,9 @@ int MAIN(int argc, char** argv){
   testDistanceFunctions();
 //  testDistanceFunctions2();
   testSimpleImplicitSurfaces();
+  testBVH();
+  testMeshVersion();
+  testMeshSDF();
 
   return 0;
 }
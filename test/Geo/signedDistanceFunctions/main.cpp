@@ -107,6 +107,36 @@ void TEST(DistanceFunctions2) {
 
 }
 
+//===========================================================================
+
+void TEST(SparseGrid) {
+  SDF_Sphere S(0, .7);
+  arr lo={-1.,-1.,-1.}, up={1.,1.,1.};
+  SDF_GridData D(S, lo, up, {100,100,100});
+  SDF_SparseGrid G(S, lo, up, {100,100,100}, .1);
+  cout <<"dense: " <<D.gridData.N*sizeof(float) <<" bytes, sparse: " <<G.getMemory() <<" bytes (" <<G.bricks.d0 <<'/' <<G.brickIndex.N <<" bricks)" <<endl;
+
+  //-- within the band, both interpolate the same vertices; outside the sign is kept
+  for(uint i=0;i<1000;i++){
+    arr x = randn(3);
+    x *= (.7 + rnd.uni(-.1, .1))/length(x);
+    CHECK_ZERO((G.f(NoArr, NoArr, x) - D.f(NoArr, NoArr, x)), 1e-6, "");
+    x = rand(3)*2.-1.;
+    CHECK_GE(G.f(NoArr, NoArr, x)*S.f(NoArr, NoArr, x), 0., "");
+  }
+
+  //-- cubic interpolation has a smooth gradient and Hessian
+  G.cubic = true;
+  G.pose.setRandom();
+  for(uint i=0;i<10;i++){
+    arr x = randn(3);
+    x *= .72/length(x);
+    x += conv_vec2arr(G.pose.pos);
+    CHECK(checkGradient(G, x, 1e-4), "");
+    CHECK(checkHessian(G, x, 1e-4), "");
+  }
+}
+
 //===========================================================================
 //
 // implicit surfaces
@@ -207,6 +237,7 @@ int MAIN(int argc, char** argv){
 
   testDistanceFunctions();
   testDistanceFunctions2();
+  testSparseGrid();
   testSimpleImplicitSurfaces();
 
   projectToSurface();
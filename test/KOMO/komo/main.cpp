@@ -3,6 +3,8 @@
 #include <Kin/F_collisions.h>
 #include <Kin/viewer.h>
 #include <Kin/F_pose.h>
+#include <Kin/frame.h>
+#include <Kin/proxy.h>
 #include <Optim/NLP_Solver.h>
 
 #include <thread>
@@ -254,6 +256,157 @@ void TEST(Threading) {
 
 //===========================================================================
 
+void TEST(ParallelFeatures) {
+  rai::Configuration C("arm.g");
+
+  KOMO komo;
+  komo.setModel(C);
+  komo.setTiming(1., 40, 5., 2);
+  komo.add_qControlObjective({}, 2, 1.);
+  komo.addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e2});
+  komo.addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1e0});
+  komo.run_prepare(.1);
+
+  auto nlp = komo.nlp_SparseNonFactored();
+  arr phi0, J0, phi1, J1;
+  komo.opt.sparseUpdates = false; //evaluate all features both times
+  komo.opt.parallelFeatures = 0;
+  nlp->evaluate(phi0, J0, komo.x);
+  komo.opt.parallelFeatures = 4;
+  nlp->evaluate(phi1, J1, komo.x);
+
+  //the merge is deterministic: results need to be bit-identical
+  CHECK_EQ(phi0, phi1, "");
+  CHECK_EQ(J0.sparse().getTriplets(), J1.sparse().getTriplets(), "");
+}
+
+//===========================================================================
+
+void TEST(ParallelCollisions) {
+  rai::Configuration C("arm.g");
+
+  KOMO komo;
+  komo.setModel(C);
+  komo.setTiming(1., 40, 5., 2);
+  komo.add_qControlObjective({}, 2, 1.);
+  komo.addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1e0});
+  komo.run_prepare(.1);
+  rndGauss(komo.x, .5, true);
+
+  //the same proxies, in the same order, for serial and parallel narrowphase
+  komo.opt.sparseUpdates = false; //query all slices both times
+  intA pairs[2];
+  for(uint k=0;k<2;k++){
+    komo.opt.parallelCollisions = (k ? 4 : 0);
+    komo.set_x(komo.x);
+    for(const rai::Proxy& p:komo.pathConfig.proxies) pairs[k].append(intA{(int)p.a->ID, (int)p.b->ID});
+  }
+  cout <<"#proxies: " <<pairs[0].N/2 <<endl;
+  CHECK_EQ(pairs[0], pairs[1], "");
+}
+
+//===========================================================================
+
+void TEST(SparseUpdates) {
+  rai::Configuration C("arm.g");
+
+  KOMO komo;
+  komo.setModel(C);
+  komo.setTiming(1., 40, 5., 2);
+  komo.add_qControlObjective({}, 2, 1.);
+  komo.addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e2});
+  komo.addObjective({}, FS_accumulatedCollisions, {}, OT_eq, {1e0});
+  komo.run_prepare(.1);
+  rndGauss(komo.x, .5, true);
+
+  auto nlp = komo.nlp_SparseNonFactored();
+  arr phi0, J0, phi1, J1;
+  nlp->evaluate(phi0, J0, komo.x);
+
+  //-- change only time step t: only its slice is marked changed
+  uint t=20;
+  arr q = komo.getConfiguration_qAll(t);
+  rndGauss(q, .3, true);
+  komo.set_x(q, {t});
+  for(uint s=0; s<komo.timeSlices.d0; s++){
+    CHECK((komo.sliceRevision(s)==komo.stateRevision)==(s==t+komo.k_order), "slice " <<s);
+  }
+  arr x = komo.pathConfig.getJointState();
+
+  //-- features of the unchanged slices are reused; all values, Jacobians and proxies as for a full update
+  nlp->evaluate(phi0, J0, x);
+  intA pairs[2];
+  for(const rai::Proxy& p:komo.pathConfig.proxies) pairs[0].append(intA{(int)p.a->ID, (int)p.b->ID});
+  komo.opt.sparseUpdates = false;
+  auto nlp1 = komo.nlp_SparseNonFactored();
+  nlp1->evaluate(phi1, J1, x);
+  for(const rai::Proxy& p:komo.pathConfig.proxies) pairs[1].append(intA{(int)p.a->ID, (int)p.b->ID});
+  CHECK_EQ(phi0, phi1, "");
+  CHECK_EQ(J0.sparse().getTriplets(), J1.sparse().getTriplets(), "");
+  CHECK_EQ(pairs[0], pairs[1], "");
+}
+
+//===========================================================================
+
+void TEST(Restarts) {
+  rai::Configuration C("arm.g");
+
+  KOMO komo;
+  komo.setModel(C, false);
+  komo.setTiming(1., 20, 5., 2);
+  komo.add_qControlObjective({}, 2, 1.);
+  komo.addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e2});
+  komo.opt.verbose = 0;
+
+  //restart 0 starts at the same x as a plain optimize without noise
+  KOMO single;
+  single.clone(komo);
+  single.opt.verbose = 0;
+  single.optimize(0.);
+
+  rai::Array<KOMO_Restart> R = komo.optimizeRestarts(8, .3, 4, false);
+  for(KOMO_Restart& r:R) cout <<"restart " <<r.id <<" sos:" <<r.sos <<" eq:" <<r.eq <<" time:" <<r.time <<endl;
+
+  CHECK_EQ(R.N, 8, "");
+  for(uint i=1; i<R.N; i++) if(R(i).eq+R(i).ineq<1.) CHECK_LE(R(i-1).sos, R(i).sos, "not ranked");
+  CHECK_EQ(komo.x, R(0).x, "");
+  CHECK_LE(R(0).sos, single.sos+1e-6, "the best restart is worse than a single run");
+
+  //with pruneDominated (the default): the same initializations (same seed), on one thread so that restart 0 finishes
+  //first; with large noise and a stiff constraint, other restarts are clearly dominated and stop early -- the remaining
+  //ones give the same results and ranking as without pruning
+  auto restarts = [&C](bool pruneDominated) {
+    KOMO stiff;
+    stiff.setModel(C, false);
+    stiff.setTiming(1., 20, 5., 2);
+    stiff.add_qControlObjective({}, 2, 1.);
+    stiff.addObjective({.5, 1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e4});
+    stiff.opt.verbose = 0;
+    rnd.seed(1);
+    rai::Array<KOMO_Restart> R = stiff.optimizeRestarts(8, 3., 1, pruneDominated);
+    CHECK_EQ(stiff.x, R(0).x, "");
+    return R;
+  };
+  rai::Array<KOMO_Restart> A = restarts(false);
+  rai::Array<KOMO_Restart> B = restarts(true);
+  CHECK_EQ(B.N, 8, "");
+  uint pruned=0;
+  for(KOMO_Restart& r:B) if(r.pruned) pruned++;
+  cout <<"pruned " <<pruned <<" of " <<B.N <<endl;
+  CHECK_GE(pruned, 1, "no restart was pruned");
+  CHECK(!B(0).pruned, "");
+  CHECK_ZERO(maxDiff(B(0).x, A(0).x), 1e-10, "pruning changed the best restart");
+  uint a=0;
+  for(uint i=0; i<B.N; i++) {
+    if(B(i).pruned) { CHECK_GE(B(i).eq+B(i).ineq, 1., "a feasible restart was pruned"); continue; }
+    while(a<A.N && A(a).id!=B(i).id) a++; //the unpruned restarts keep their results and relative ranking
+    CHECK(a<A.N, "ranking of unpruned restarts changed");
+    CHECK_ZERO(B(i).sos-A(a).sos, 1e-10, "");
+  }
+}
+
+//===========================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
@@ -264,6 +417,10 @@ int main(int argc,char** argv){
   testThin();
   testPR2();
   testThreading();
+  testParallelFeatures();
+  testParallelCollisions();
+  testSparseUpdates();
+  testRestarts();
 
   return 0;
 }
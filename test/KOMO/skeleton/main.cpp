@@ -362,11 +362,28 @@ void testWalking(rai::ArgWord pathOrSeq){
 
 //===========================================================================
 
+void testSkeletonEquality(){
+  rai::Skeleton A = {
+    { 1., 1., rai::SY_topBoxGrasp, {"gripper", "box2"} },
+    { 1., 2., rai::SY_stable, {"gripper", "box2"} },
+  };
+  rai::Skeleton B = A;
+  CHECK((A.S==B.S) && A.getHash()==B.getHash(), "equal skeletons differ");
+  B.S(1).symbol = rai::SY_stableOn;
+  CHECK(!(A.S==B.S) && A.getHash()!=B.getHash(), "skeletons with different symbols are equal");
+  B = A;
+  B.S(1).frames(1) = "box1";
+  CHECK(!(A.S==B.S), "skeletons with different frames are equal");
+}
+
+//===========================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
 //  rnd.clockSeed();
 
+  testSkeletonEquality();
   testPickAndPlace(rai::_path);
 //  testPickAndPlace(rai::_sequence);
   testPickAndPush(rai::_path);
@@ -2,7 +2,10 @@
 #include <Kin/kin_swift.h>
 #include <Gui/opengl.h>
 #include <Kin/frame.h>
+#include <Kin/proxy.h>
 #include <Kin/viewer.h>
+#include <Geo/fclInterface.h>
+#include <Core/thread.h>
 
 void TEST(Swift) {
   rai::Configuration C("swift_test.g");
@@ -104,11 +107,67 @@ void TEST(CollisionTiming){
   cout <<" query time: " <<rai::timerRead(true) <<"sec" <<endl;
 }
 
+void TEST(ParallelFCL){
+  //the narrowphase on a worker pool returns the same collisions, in the same order, as the serial pass
+  rai::Configuration C;
+  for(uint i=0;i<200;i++){
+    rai::Frame *a = C.addFrame(STRING("obj_i"<<i));
+    a->setConvexMesh(.2*rai::Mesh().setRandom().V, {}, .02 + .1*rnd.uni());
+    a->setContact(1);
+  }
+
+  auto randomPoses = [&C](){
+    for(rai::Frame *a:C.frames){
+      a->setPose(rai::Transformation().setRandom());
+      a->set_X()->pos *= 2.;
+    }
+    return C.getFrameState();
+  };
+
+  std::shared_ptr<rai::FclInterface> fcl = C.fcl();
+  auto pool = make_shared<WorkerPool>(4);
+  for(double cutoff:{0., .1}){
+    fcl->cutoff = cutoff;
+    for(uint t=0;t<5;t++){
+      arr X = randomPoses();
+      fcl->pool.reset();
+      fcl->step(X);
+      uintA serial = fcl->collisions;
+      fcl->pool = pool;
+      fcl->step(X);
+      cout <<"cutoff: " <<cutoff <<" #collisions: " <<serial.d0 <<endl;
+      CHECK_EQ(serial, fcl->collisions, "parallel narrowphase differs");
+
+      //a batch of states: the same as their single steps
+      arrA Xs = { X, randomPoses(), randomPoses() };
+      uintAA batch;
+      fcl->step(batch, Xs);
+      fcl->pool.reset();
+      for(uint s=0;s<Xs.N;s++){
+        fcl->step(Xs(s));
+        CHECK_EQ(batch(s), fcl->collisions, "batched narrowphase differs for state " <<s);
+      }
+    }
+  }
+
+  //the same through stepFcl
+  randomPoses();
+  fcl->cutoff = 0.;
+  uintA pairs[2];
+  for(uint k=0;k<2;k++){
+    fcl->pool = (k ? pool : nullptr);
+    C.stepFcl();
+    for(const rai::Proxy& p:C.proxies) pairs[k].append(uintA{p.a->ID, p.b->ID});
+  }
+  CHECK_EQ(pairs[0], pairs[1], "");
+}
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
 //  testSwift();
 //  testFCL();
+  testParallelFCL();
   testCollisionTiming();
 
   return 0;
@@ -1,5 +1,6 @@
 #include <Kin/kin.h>
 #include <Kin/frame.h>
+#include <Kin/batchFK.h>
 #include <Kin/viewer.h>
 #include <Kin/kin_swift.h>
 #include <Kin/kin_ode.h>
@@ -11,6 +12,8 @@
 #include <Optim/optimization.h>
 #include <Kin/feature.h>
 
+#include <thread>
+
 //===========================================================================
 //
 // test load save
@@ -71,7 +74,7 @@ void TEST(ViewerUpdate){
 void TEST(Kinematics){
 
   struct MyFct : VectorFunction{
-    enum Mode {Pos, Vec, Quat} mode;
+    enum Mode {Pos, Vec, Quat, Mat} mode;
     rai::Configuration& C;
     rai::Frame *b;
     rai::Vector &vec;
@@ -84,6 +87,7 @@ void TEST(Kinematics){
           case Pos:    C.kinematicsPos(y,J,b,vec); break;
           case Vec:    C.kinematicsVec(y,J,b,vec); break;
           case Quat:   C.kinematicsQuat(y,J,b); break;
+          case Mat:    C.kinematicsMat(y,J,b); break;
         }
         y.J() = J;
         return y;
@@ -99,9 +103,8 @@ void TEST(Kinematics){
 //  rai::Configuration G("../../../projects/17-LGP-push/quatJacTest.g");
 //  G.watch(true);
 
-  C.jacMode = C.JM_sparse;
-
-  for(uint k=0;k<10;k++){
+  for(uint k=0;k<20;k++){
+    C.jacMode = (k%2 ? C.JM_dense : C.JM_sparse);
     rai::Frame *b = C.frames.rndElem();
     rai::Vector vec=0, vec2=0;
     vec.setRandom();
@@ -112,6 +115,7 @@ void TEST(Kinematics){
     cout <<"kinematicsPos:   "; checkJacobian(MyFct(MyFct::Pos  , C, b, vec)(), x, 1e-5);
     cout <<"kinematicsVec:   "; checkJacobian(MyFct(MyFct::Vec  , C, b, vec)(), x, 1e-5);
     cout <<"kinematicsQuat:  "; checkJacobian(MyFct(MyFct::Quat , C, b, vec)(), x, 1e-5);
+    cout <<"kinematicsMat:   "; checkJacobian(MyFct(MyFct::Mat  , C, b, vec)(), x, 1e-5);
 
     //checkJacobian(Convert(T1::f_hess, nullptr), x, 1e-5);
   }
@@ -199,6 +203,50 @@ void TEST(Copy){
   cout <<"** copy operator success" <<endl;
 }
 
+//===========================================================================
+//
+// frame name lookup (hash index) consistent under structural changes
+//
+
+void TEST(FrameNames){
+  rai::Configuration C("kinematicTests.g");
+  uint n=C.frames.N;
+  for(uint t=0;t<3;t++){ FrameL F = C.frames; F.resizeCopy(n); C.addCopies(F, {}); } //repeated names
+  C.addFrame("extra");
+  CHECK_GE(C.frames.N, 32, "too small to be indexed");
+
+  auto linear = [&C](const char* name, bool reverse){
+    rai::Frame *f=0;
+    for(rai::Frame *b:C.frames) if(b->name==name){ f=b; if(!reverse) break; }
+    return f;
+  };
+  auto check = [&C, &linear](){
+    for(rai::Frame *f:C.frames) for(bool reverse:{false, true}){
+      CHECK_EQ(C.getFrame(f->name, true, reverse), linear(f->name, reverse), "frame name index broken for '" <<f->name <<"'");
+    }
+    CHECK(!C.getFrame("doesNotExist", false), "");
+  };
+  check();
+
+  C.addFrame("extra2", "extra");      check();
+  delete C.frames(n+1);               check();
+  delete C.frames.last();             check();
+  C.frames(3)->setName("renamed");    check();
+  C.frames(5)->setName(C.frames(7)->name); check(); //renamed onto an indexed name
+  C.frames.last()->setName(C.frames(0)->name); check();
+  C.sortFrames();                     check();
+  C.prefixNames();                    check();
+
+  //concurrent lookups on a shared configuration
+  C.reset_frameNameIndex();
+  std::vector<std::thread> threads;
+  for(uint t=0;t<4;t++) threads.emplace_back([&C](){
+    for(rai::Frame *f:C.frames) CHECK_EQ(C.getFrame(f->name)->name, f->name, "");
+  });
+  for(std::thread& th:threads) th.join();
+  cout <<"** frame name lookup consistent" <<endl;
+}
+
 //===========================================================================
 //
 // Kinematic speed test
@@ -244,6 +292,54 @@ void TEST(KinematicSpeed){
 #endif
 }
 
+//===========================================================================
+//
+// batch forward kinematics (compare to setJointState, for a batch size that isn't a multiple of the SIMD width)
+//
+
+void TEST(BatchFK){
+  rai::Configuration C("kinematicTests.g");
+  uint n=C.getJointStateDimension(), N=37;
+  arr Q(N, n);
+  rndUniform(Q, -.5, .5, false);
+
+  rai::BatchFK fk(C);
+  arr X = fk.eval(Q);
+  CHECK_EQ(X.d0, N, "");
+  CHECK_EQ(X.d1, C.frames.N, "");
+
+  double err=0.;
+  for(uint i=0;i<N;i++){
+    C.setJointState(Q[i]);
+    arr Xi = C.getFrameState();
+    for(uint f=0;f<Xi.d0;f++){
+      arr x = X[i][f], y = Xi[f];
+      if(scalarProduct(x({3,6}), y({3,6}))<0.) y({3,6}) *= -1.; //quaternions are only defined up to sign
+      err = rai::MAX(err, maxDiff(x, y));
+    }
+  }
+  cout <<"batch FK (simd width " <<fk.simdWidth() <<") max error: " <<err <<endl;
+  CHECK_LE(err, 1e-10, "batch FK differs from setJointState");
+
+  //timing on a chain of 30 hinges
+  rai::Configuration K;
+  K.addFrame("link0");
+  for(uint i=1;i<=30;i++){
+    K.addFrame(STRING("joint" <<i), STRING("link" <<i-1)) -> setRelativePosition({0.,0.,.1}).setJoint(i%2 ? rai::JT_hingeX : rai::JT_hingeY);
+    K.addFrame(STRING("link" <<i), STRING("joint" <<i)) -> setRelativePosition({0.,0.,.1});
+  }
+  rai::BatchFK chain(K);
+  N=1000;
+  Q.resize(N, K.getJointStateDimension());
+  rndUniform(Q, -.5, .5, false);
+  rai::timerStart(true);
+  for(uint i=0;i<N;i++){ K.setJointState(Q[i]); K.getFrameState(); }
+  double t1=rai::timerRead(true);
+  chain.eval(X, Q);
+  double t2=rai::timerRead();
+  cout <<"FK timing for " <<N <<" samples of " <<K.frames.N <<" frames: sequential " <<t1 <<"sec, batch " <<t2 <<"sec" <<endl;
+}
+
 //===========================================================================
 //
 // SWIFT and contacts test
@@ -646,12 +742,14 @@ int MAIN(int argc,char **argv){
 
   testLoadSave();
   testCopy();
+  testFrameNames();
   testGraph();
   testPlayStateSequence();
   testViewerUpdate();
   testKinematics();
   testQuaternionKinematics();
   testKinematicSpeed();
+  testBatchFK();
   testFollowRedundantSequence();
   testInverseKinematics();
   //testDynamics();
@@ -373,6 +373,44 @@ void testSweepingSDFs(){
 
 //===========================================================================
 
+void TEST(CollisionCache) {
+  //a pair of random convex meshes in small relative motion: warm started GJK returns the same distances,
+  //and the cached lower bound is never above the true distance
+  rai::Mesh m1, m2;
+  m1.setRandom();  m2.setRandom();
+  rai::Transformation t1=0, t2=0;
+  t1.pos.set(-.8, 0., 0.);  t2.pos.set(.8, 0., 0.);
+
+  PairCollisionCache cache;
+  uint boundChecks=0;
+  for(uint k=0;k<1000;k++){
+    rai::Transformation t1_old=t1, t2_old=t2;
+    t1.addRelativeTranslation(.02*rnd.gauss(), .02*rnd.gauss(), .02*rnd.gauss());
+    t2.addRelativeRotationDeg(2.*rnd.gauss(), 0., 0., 1.);
+    t2.addRelativeTranslation(.02*rnd.gauss(), .02*rnd.gauss(), .02*rnd.gauss());
+    if(k%100==0){ t1.pos.set(-.8, 0., 0.); t2.pos.set(.8, 0., 0.); } //don't drift apart
+
+    double bound = cache.distanceLowerBound(m1, m2, t1, t2);
+    PairCollision coll(m1, m2, t1, t2, 0., 0., &cache);
+    PairCollision coll0(m1, m2, t1, t2);
+
+    //GJK terminates at squared distances below 1e-8, so near contact both may differ up to 1e-4
+    CHECK_ZERO(coll.distance-coll0.distance, 2e-4, "warm start changed the distance");
+    if(bound>-1e10){ CHECK_LE(bound, coll.distance+1e-10, "lower bound violated"); boundChecks++; }
+  }
+  cout <<"queries: " <<cache.queries <<" warm starts: " <<cache.warmStarts <<" bound checks: " <<boundChecks <<endl;
+  CHECK_EQ(cache.warmStarts, cache.queries-1, "");
+
+  //in-place edits of a mesh invalidate the cache, also if the vertex count stays the same
+  CHECK(cache.isValid(m1, m2), "");
+  m1.scale(1.1);
+  CHECK(!cache.isValid(m1, m2), "cache not invalidated by a mesh edit");
+  PairCollision coll(m1, m2, t1, t2, 0., 0., &cache);
+  CHECK_ZERO(coll.distance-PairCollision(m1, m2, t1, t2).distance, 1e-10, "stale warm start after a mesh edit");
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
@@ -381,6 +419,7 @@ int MAIN(int argc, char** argv){
   testGJK_Jacobians();
   testGJK_Jacobians2();
   testGJK_Jacobians3();
+  testCollisionCache();
 
   testFunctional();
   testSweepingSDFs();
@@ -0,0 +1,130 @@
+#include <LGP/LGP_tree.h>
+#include <KOMO/komo.h>
+
+//===========================================================================
+
+void TEST(BoundCache){
+  rai::Configuration C("model.g");
+  rai::LGP_Tree lgp(C, "../pickAndPlace/fol-pnp-switch.g");
+  CHECK(lgp.useBoundCache, "");
+
+  //-- a solved problem is cached...
+  rai::LGP_Node* a = lgp.walkToNode("(pick gripper obj0) (place gripper obj0 tray)");
+  a->optBound(rai::BD_seq);
+  CHECK(!a->fromCache(rai::BD_seq), "");
+  CHECK(a->feasible(rai::BD_seq), "");
+  arr x = a->problem(rai::BD_seq).komo->x;
+  CHECK(lgp.findBound(*a->skeleton, rai::BD_seq, false), "");
+  CHECK(!lgp.findBound(*a->skeleton, rai::BD_seq, true), "a problem without collisions answers one with collisions");
+  CHECK(!lgp.findBound(*a->skeleton, rai::BD_path, false), "");
+
+  //-- ...and an equal skeleton (rebuilt from scratch) is answered from the cache without solving
+  a->resetData();
+  uint opt = rai::COUNT_opt(rai::BD_seq), cached = rai::COUNT_cached(rai::BD_seq);
+  a->optBound(rai::BD_seq);
+  CHECK(a->fromCache(rai::BD_seq), "");
+  CHECK(a->feasible(rai::BD_seq), "");
+  CHECK_EQ(rai::COUNT_opt(rai::BD_seq), opt, "");
+  CHECK_EQ(rai::COUNT_cached(rai::BD_seq), cached+1, "");
+  CHECK_EQ(a->problem(rai::BD_seq).komo->x, x, "");
+
+  //-- a descendant's BD_seq is warm started from the ancestor's solution along the shared phases
+  rai::LGP_Node* c = lgp.walkToNode("(pick gripper obj0) (place gripper obj0 tray) (pick gripper obj1) (place gripper obj1 tray)");
+  c->optBound_prepare(rai::BD_seq);
+  KOMO& komo = *c->problem(rai::BD_seq).komo;
+  const arrA& path = lgp.findBound(*a->skeleton, rai::BD_seq)->path;
+  CHECK_LE(path.N, komo.T, "");
+  for(uint t=0; t<path.N; t++) CHECK_EQ(komo.getConfiguration_qAll(t), path(t), "slice " <<t <<" is not warm started");
+
+  //-- (which a cold start is not)
+  lgp.useBoundCache = false;
+  c->optBound_prepare(rai::BD_seq);
+  arr q = c->problem(rai::BD_seq).komo->getConfiguration_qAll(path.N-1);
+  CHECK(maxDiff(q, path.last())>1e-3, "");
+  lgp.useBoundCache = true;
+
+  c->optBound(rai::BD_seq);
+  CHECK(!c->fromCache(rai::BD_seq), "");
+  CHECK(c->feasible(rai::BD_seq), "");
+}
+
+//===========================================================================
+
+void TEST(ParallelBounds){
+  rai::Configuration C("model.g");
+
+  auto solve = [&C](uint parallelBounds) {
+    auto lgp = make_shared<rai::LGP_Tree>(C, "../pickAndPlace/fol-pnp-switch.g");
+    lgp->fol.addTerminalRule("(on tray obj0) (on tray obj1)");
+    lgp->parallelBounds = parallelBounds;
+    lgp->run(40);
+    return lgp;
+  };
+  shared_ptr<rai::LGP_Tree> serial = solve(0);
+  shared_ptr<rai::LGP_Tree> parallel = solve(4);
+
+  //the parallel run solves at least the serial solutions, with the same skeletons and bounds on all levels
+  CHECK_GE(serial->fringe_solved.N, 2, "");
+  for(rai::LGP_Node* s:serial->fringe_solved) {
+    rai::LGP_Node* p=0;
+    for(rai::LGP_Node* n:parallel->fringe_solved) if(n->getTreePathString()==s->getTreePathString()) p=n;
+    CHECK(p, "serial solution " <<s->getTreePathString() <<" not found in parallel");
+    CHECK(p->skeleton->S==s->skeleton->S, "");
+    for(rai::BoundType b:{rai::BD_pose, rai::BD_seq, rai::BD_seqPath}) {
+      CHECK_EQ(p->feasible(b), s->feasible(b), "");
+      CHECK_ZERO(p->cost(b)-s->cost(b), 1e-4, "bound " <<b <<" differs: " <<s->getTreePathString());
+    }
+  }
+}
+
+//===========================================================================
+
+void TEST(Transpositions){
+  rai::Configuration C("model.g");
+
+  rai::Array<shared_ptr<rai::LGP_Tree>> trees;
+  for(bool prune:{false, true}) {
+    auto lgp = make_shared<rai::LGP_Tree>(C, "../pickAndPlace/fol-pnp-switch.g");
+    lgp->fol.addTerminalRule("(on tray obj0) (on tray obj1)");
+    lgp->pruneTranspositions = prune;
+    lgp->buildTree(6);
+    trees.append(lgp);
+  }
+  rai::LGP_Tree &full=*trees(0), &pruned=*trees(1);
+  auto state = [&pruned](rai::LGP_Node* n) { return pruned.fol.encodeState(*n->folState); };
+
+  //pruned nodes are not expanded, and their state is known from a node of lower or equal symbolic cost
+  rai::LGP_NodeL nodes = pruned.root->getAll();
+  uint n=0;
+  for(rai::LGP_Node* a:nodes) if(a->note.contains("TRANSPOSITION")) {
+    n++;
+    CHECK(!a->isExpanded && !a->isTerminal, "");
+    bool known=false;
+    for(rai::LGP_Node* b:nodes) if(b!=a && !b->note.contains("TRANSPOSITION") && b->cost(rai::BD_symbolic)<=a->cost(rai::BD_symbolic) && state(b)==state(a)) known=true;
+    CHECK(known, "pruned " <<a->getTreePathString() <<" without a known equal state");
+  }
+  CHECK_GE(n, 1, "");
+  CHECK_LE(2*nodes.N, full.root->getAll().N, "");
+
+  //the same terminal states are reached, at no higher symbolic cost (compared as fact lists: encodings are specific to a tree's KB)
+  auto facts = [](rai::LGP_Node* n) { StringA F; for(rai::Node* f:*n->folState) { rai::String s; f->write(s); F.append(s); } F.sort(); return F; };
+  CHECK(full.terminals.N && pruned.terminals.N, "");
+  for(rai::LGP_Node* a:full.terminals) {
+    bool found=false;
+    for(rai::LGP_Node* b:pruned.terminals) if(b->cost(rai::BD_symbolic)<=a->cost(rai::BD_symbolic) && facts(b)==facts(a)) found=true;
+    CHECK(found, "terminal " <<a->getTreePathString() <<" is lost");
+  }
+  cout <<"LGP tree to depth 6: " <<full.root->getAll().N <<" nodes, with pruned transpositions: " <<nodes.N <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc,char **argv){
+  rai::initCmdLine(argc, argv);
+
+  testBoundCache();
+  testParallelBounds();
+  testTranspositions();
+
+  return 0;
+}
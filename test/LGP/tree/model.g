@@ -0,0 +1,28 @@
+world {}
+
+table (world){
+    Q:<t(0 0 .6)>
+    shape:ssBox, size:[2. 2. .1 .02], color:[.3 .3 .3],
+    logical:{ table } }
+
+base (world){ Q:<t(0 0 1.)> }
+
+gripper (base){
+    joint:trans3,
+    shape:ssBox, size:[.06 .06 .06 .02], color:[.9 .9 .5],
+    logical:{ gripper } }
+
+obj0 (table){
+    joint:rigid, Q:<t(.3 .2 .1)>
+    shape:ssBox, size:[.1 .1 .1 .02], color:[.8 .2 .2],
+    logical:{ object } }
+
+obj1 (table){
+    joint:rigid, Q:<t(.3 -.2 .1)>
+    shape:ssBox, size:[.1 .1 .1 .02], color:[.8 .2 .2],
+    logical:{ object } }
+
+tray (table){
+    Q:<t(-.4 0 .07)>
+    shape:ssBox, size:[.3 .3 .04 .02], color:[.2 .8 .2],
+    logical:{ table } }
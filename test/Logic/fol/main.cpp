@@ -1,4 +1,5 @@
 #include <Logic/fol.h>
+#include <Logic/folWorld.h>
 //#include <Gui/graphview.h>
 
 //===========================================================================
@@ -102,6 +103,103 @@ void testFolSubstitution(){
 
 //===========================================================================
 
+void testFactIndex(){
+  rai::Graph KB;
+  FILE("fol.g") >>KB;
+  rai::Graph& state = KB.get<rai::Graph>("STATE");
+  rai::FactIndex& index = rai::getFactIndex(state);
+
+  //every fact is a candidate for itself, and all facts of a predicate are found
+  auto check = [&](){
+    for(rai::Node *fact:state) if(fact->parents.N){
+      CHECK(index.candidates(fact).contains(fact), "fact index lost " <<*fact);
+      rai::NodeL same;
+      for(rai::Node *f:state) if(f->parents.N && f->parents(0)==fact->parents(0)) same.append(f);
+      CHECK((index.args[fact->parents(0)](0)==same), "fact index out of order for " <<*fact->parents(0));
+    }
+  };
+  check();
+  rai::forwardChaining_FOL(KB, state, nullptr); //adds facts
+  check();
+  for(uint i=state.N;i--;) if(i%3==0) delete state(i);
+  check();
+  delete rai::createNewFact(state, {KB["Missile"], KB["M1"]}); //deleted while still pending
+  check();
+  state.clear();
+  CHECK(!index.args.size() && !index.pending.N, "");
+  rai::createNewFact(state, {KB["Missile"], KB["M2"]});
+  rai::createNewFact(state, {KB["Owns"], KB["Nono"], KB["M2"]});
+  check();
+  CHECK_EQ(rai::getRuleSubstitutions2(state, KB.getNodes("Rule")(1)->graph()).N, 1, ""); //(Missile x) (Owns Nono x)
+}
+
+//===========================================================================
+
+void testCompactState(){
+  rai::FOL_World W(rai::raiPath("bin/src_lgpPlayer/pnp.g"));
+  W.compactStates=true;
+  W.reset_state();
+  auto start = W.get_stateCopy();
+
+  //sorted fact tuples of the current state, as a reference
+  auto facts = [&W](){
+    std::vector<std::string> S;
+    for(rai::Node *f:*W.state){ rai::String s; s <<*f; S.push_back(s.p); }
+    std::sort(S.begin(), S.end());
+    return S;
+  };
+
+  rnd.seed(0);
+  for(uint t=0;t<10;t++){
+    auto actions = W.get_actions();
+    if(!actions.N || W.is_terminal_state()) break;
+    W.transition(actions.rndElem());
+
+    auto c = W.get_stateCopy();
+    std::vector<std::string> S = facts();
+    rai::FOL_World::CompactState re = W.encodeState(*W.state);
+    CHECK(*c==re && c->get_hash()==re.get_hash(), "encoding is not canonical");
+
+    W.set_state(start);
+    CHECK(*W.get_stateCopy()==*start, "");
+    CHECK_EQ(W.R_total, 0., "");
+    W.set_state(c);
+    CHECK(*W.get_stateCopy()==*c, "decode/encode changed the state");
+    CHECK_EQ(W.R_total, std::dynamic_pointer_cast<const rai::FOL_World::CompactState>(c)->R_total, "");
+    CHECK(S==facts(), "decoded state differs");
+  }
+
+  W.reset_state();
+  CHECK(*W.get_stateCopy()==*start, "");
+}
+
+//===========================================================================
+
+void testTranspositionTable(){
+  rai::FOL_World W(rai::raiPath("bin/src_lgpPlayer/pnp.g"));
+  W.compactStates=true;
+  CHECK(W.get_info(W.hasHashableStates), "");
+  W.reset_state();
+
+  rai::TranspositionTable<uint> table(3);
+  rai::Array<rai::TreeSearchDomain::Handle> states;
+  rnd.seed(0);
+  for(uint t=0;t<6;t++){
+    states.append(W.get_stateCopy());
+    table.set(states.last(), t);
+    CHECK_EQ(*table.find(W.get_stateCopy()), t, "a copy of the same state is not found");
+    auto actions = W.get_actions();
+    if(!actions.N || W.is_terminal_state()) break;
+    W.transition(actions.rndElem());
+  }
+  CHECK_EQ(table.size(), 3, "");
+  CHECK_EQ(table.evicted, states.N-3, "");
+  CHECK(!table.find(states(0)), "the least recently used state was not evicted");
+  CHECK(table.find(states.last()), "");
+}
+
+//===========================================================================
+
 void testFolFunction(){
   rai::Graph KB(FILE("functionTest.g"));
 
@@ -236,6 +334,9 @@ int main(int argc, char** argv){
   testFolFwdChaining();
   testFolDisplay();
   testFolSubstitution();
+  testFactIndex();
+  testCompactState();
+  testTranspositionTable();
   testFolFunction();
 //  testMonteCarlo();
 
@@ -0,0 +1,217 @@
+#include <MCTS/solver_AStar.h>
+#include <MCTS/solver_marc.h>
+#include <MCTS/problem_BlindBranch.h>
+#include <Logic/folWorld.h>
+
+#include <functional>
+#include <map>
+
+//===========================================================================
+
+/// 0 -> 2 (reward -10), 0 -> 1 (-1), 1 -> 2 (r12), 2 -> 3 (0); 3 is terminal -- state 2 is reached along two paths
+struct Shortcut : rai::TreeSearchDomain {
+  struct State : SAO {
+    int s;
+    State(int s):s(s) {}
+    bool operator==(const SAO& other) const { return s==dynamic_cast<const State&>(other).s; }
+    size_t get_hash() const { return std::hash<int>()(s); }
+    void write(std::ostream& os) const { os <<s; }
+  };
+  struct Action : SAO {
+    int to;
+    double r;
+    Action(int to, double r):to(to), r(r) {}
+    void write(std::ostream& os) const { os <<"->" <<to; }
+  };
+
+  int s=0;
+  double r12;
+
+  Shortcut(double r12):r12(r12) {}
+  TransitionReturn transition(const Handle& action) {
+    auto a = std::dynamic_pointer_cast<const Action>(action);
+    s = a->to;
+    return {Handle(nullptr), a->r, 1.};
+  }
+  const rai::Array<Handle> get_actions() {
+    if(s==0) return {Handle(new Action(2, -10.)), Handle(new Action(1, -1.))};
+    if(s==1) return {Handle(new Action(2, r12))};
+    if(s==2) return {Handle(new Action(3, 0.))};
+    return {};
+  }
+  const Handle get_stateCopy() { return Handle(new State(s)); }
+  void set_state(const Handle& state) { s = std::dynamic_pointer_cast<const State>(state)->s; }
+  bool is_terminal_state() const { return s==3; }
+  void make_current_state_new_start() { NIY; }
+  void reset_state() { s=0; }
+  bool get_info(InfoTag tag) const { return tag==isMarkov || tag==hasHashableStates || tag==isDeterministic || tag==hasTerminal; }
+  double get_info_value(InfoTag tag) const { NIY; return 0.; }
+};
+
+/// the same world, but the solvers may not hash its states
+struct BlindBranchNoHash : BlindBranch {
+  BlindBranchNoHash(uint H) : BlindBranch(H) {}
+  bool get_info(InfoTag tag) const { return tag!=hasHashableStates && BlindBranch::get_info(tag); }
+};
+
+AStar_Node* solve(AStar& A) {
+  for(uint k=0; k<1000000 && !A.step();) k++;
+  CHECK(A.solutions.N, "no solution");
+  return A.solutions.last();
+}
+
+//===========================================================================
+
+void TEST(AStarDuplicates){
+  //a worse path to a known state is a duplicate and not queued
+  {
+    Shortcut W(-20.);
+    AStar A(W);
+    CHECK(A.useTranspositions, "");
+    AStar_Node* s = solve(A);
+    CHECK_EQ(s->g, -10., "");
+    CHECK_EQ(s->d, 2, "");
+    AStar_Node* viaA = A.root->children(1)->children(0);
+    CHECK(viaA->isDuplicate, "");
+    CHECK(!viaA->isExpanded, "");
+  }
+
+  //a better path re-opens it: the superseded node is skipped when popped (and never expanded)
+  {
+    Shortcut W(-1.);
+    AStar A(W);
+    AStar_Node* s = solve(A);
+    CHECK_EQ(s->g, -2., "");
+    CHECK_EQ(s->d, 3, "");
+    AStar_Node* direct = A.root->children(0);
+    CHECK(direct->isDuplicate, "");
+    CHECK(!direct->isExpanded, "");
+    CHECK(!A.root->children(1)->children(0)->isDuplicate, "");
+  }
+
+  //without transpositions: the same solutions, more nodes
+  for(double r12:{-20., -1.}) {
+    Shortcut W(r12);
+    AStar A(W), B(W);
+    B.useTranspositions=false;
+    B.transpositions.clear();
+    AStar_Node *a = solve(A), *b = solve(B);
+    CHECK_EQ(a->g, b->g, "");
+    CHECK_EQ(a->d, b->d, "");
+    CHECK_LE(A.size, B.size, "");
+  }
+}
+
+//===========================================================================
+
+void TEST(AStarPnp){
+  //same solution, fewer nodes with hashable (compact) states
+  uint size[2];
+  double g[2];
+  uint d[2];
+  for(uint hashable=0; hashable<2; hashable++) {
+    rai::FOL_World W(rai::raiPath("bin/src_lgpPlayer/pnp.g"));
+    W.worldRules.removeValue(W.KB["termination"]); //a deeper goal: the two grippers reach states along different paths
+    W.addTerminalRule("(on tray obj0) (on tray obj1)");
+    W.compactStates = hashable;
+    W.verbose = 0;
+    AStar A(W);
+    CHECK_EQ(A.useTranspositions, (bool)hashable, "");
+    AStar_Node* s = solve(A);
+    size[hashable] = A.size;
+    g[hashable] = s->g;
+    d[hashable] = s->d;
+    cout <<"AStar on pnp.g, hashable states: " <<hashable <<" nodes: " <<A.size <<" solution depth: " <<s->d <<" g: " <<s->g <<endl;
+  }
+  CHECK_EQ(g[0], g[1], "");
+  CHECK_EQ(d[0], d[1], "");
+  CHECK(size[1]<size[0], "duplicates were not pruned");
+}
+
+//===========================================================================
+
+/// the state of a BlindBranch node (sum of decisions along its parents)
+int sumOf(MCTS_Node* n) {
+  int s=0;
+  for(; n->parent; n=n->parent) s += std::dynamic_pointer_cast<const BlindBranch::Action>(n->decision)->d;
+  return s;
+}
+
+/// visits a merged node received through its transpositions
+void collectAliasVisits(std::map<MCTS_Node*, uint>& aliasVisits, MCTS_Node* n) {
+  if(n->transposition) aliasVisits[n->transposition] += n->N;
+  for(MCTS_Node* ch:n->children) collectAliasVisits(aliasVisits, ch);
+}
+
+/// visit counts and returns are consistent over the DAG: every node that continued the search handed each visit but its
+/// first to a child (merged nodes also count the visits that reached them through their transpositions), and terminals
+/// hold their reward
+void checkStatistics(std::map<MCTS_Node*, uint>& aliasVisits, MCTS_Node* n, uint H) {
+  if(n->transposition) {
+    CHECK(!n->children.N, "a transposition has own children");
+    CHECK_EQ(n->transposition->t, n->t, "");
+    CHECK_EQ(sumOf(n->transposition), sumOf(n), "merged different states");
+    CHECK_LE(n->N, n->transposition->N, "");
+    return;
+  }
+  if(n->t==H) {
+    CHECK_ZERO(n->Q - n->N*double(sumOf(n))/H, 1e-10, "");
+    return;
+  }
+  if(n->children.N) {
+    uint N=0;
+    for(MCTS_Node* ch:n->children) N += ch->N - aliasVisits[ch];
+    CHECK_EQ(N, n->N-1, "visits are not backed up through the DAG");
+  }
+  for(MCTS_Node* ch:n->children) checkStatistics(aliasVisits, ch, H);
+}
+
+/// checks the statistics of the whole search graph
+void checkStatistics(MCTS& M, uint H) {
+  std::map<MCTS_Node*, uint> aliasVisits;
+  collectAliasVisits(aliasVisits, &M.root);
+  checkStatistics(aliasVisits, &M.root, H);
+}
+
+void TEST(MCTSTranspositions){
+  uint H=8, rollouts=500;
+
+  rnd.seed(0);
+  BlindBranch W(H);
+  MCTS M(W);
+  M.verbose=0;
+  CHECK(M.useTranspositions, "");
+  for(uint k=0; k<rollouts; k++) M.addRollout(2*H);
+  CHECK_EQ(M.root.N, rollouts, "");
+  checkStatistics(M, H);
+  uint merged=0, states=0;
+  std::function<void(MCTS_Node*)> count = [&](MCTS_Node* n) { if(n->transposition) merged++; else states++; for(MCTS_Node* ch:n->children) count(ch); };
+  count(&M.root);
+  CHECK_GE(merged, 1, "");
+  CHECK_LE(states, (H+1)*(H+2)/2, "a state has more than one expanded node");
+
+  //non-hashable states: a plain tree with the same statistics, and more nodes
+  rnd.seed(0);
+  BlindBranchNoHash V(H);
+  MCTS T(V);
+  T.verbose=0;
+  CHECK(!T.useTranspositions, "");
+  for(uint k=0; k<rollouts; k++) T.addRollout(2*H);
+  CHECK_EQ(T.root.N, rollouts, "");
+  checkStatistics(T, H);
+  CHECK(!T.transpositions.size(), "");
+  CHECK_GE(T.Nnodes(), M.Nnodes(), "");
+  cout <<"MCTS on BlindBranch(" <<H <<"): nodes with transpositions: " <<M.Nnodes() <<" (" <<merged <<" merged) without: " <<T.Nnodes() <<endl;
+}
+
+//===========================================================================
+
+int MAIN(int argc,char **argv){
+  rai::initCmdLine(argc, argv);
+
+  testAStarDuplicates();
+  testAStarPnp();
+  testMCTSTranspositions();
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+#include <Optim/sparseLDL.h>
+#include <Core/util.h>
+
+//===========================================================================
+
+arr randomSparseSymPosDef(uint n, uint band, uint couplings){
+  arr J(n+couplings, n);
+  J.setZero();
+  for(uint i=0;i<n;i++) for(uint j=i;j<n && j<=i+band;j++) J(i,j) = rnd.uni(-1.,1.);
+  for(uint k=0;k<couplings;k++){ J(n+k, rnd(n)) = 1.; J(n+k, rnd(n)) = -1.; }
+  arr A = ~J*J;
+  for(uint i=0;i<n;i++) A(i,i) += 1e-3;
+  return A;
+}
+
+void TEST(SparseLDL){
+  cout <<"\n*** SparseLDL\n";
+
+  SparseLDL ldl;
+  for(uint k=0;k<20;k++){
+    uint n = 10+rnd(50);
+    arr A = randomSparseSymPosDef(n, 3, 5);
+    arr b = randn(n);
+    arr x_dense = lapack_Ainv_b_sym(A, b);
+
+    arr As = A;
+    As.sparse();
+    CHECK(ldl.factorize(As.sparse()), "");
+    arr x = ldl.solve(b);
+    CHECK_ZERO(maxDiff(x, x_dense), 1e-6, "");
+    CHECK_ZERO(maxDiff(x, lapack_Ainv_b_sym(As, b)), 1e-6, ""); //the previous sparse path: eigen_Ainv_b (SimplicialLDLT)
+
+    //same pattern, different values and damping: the symbolic analysis is reused
+    uint analyzed = ldl.analyzeCount;
+    As *= 2.;
+    CHECK(ldl.factorize(As.sparse(), 1.), "");
+    x = ldl.solve(b);
+    for(uint i=0;i<n;i++) A(i,i) += .5;
+    CHECK_ZERO(maxDiff(2.*x, lapack_Ainv_b_sym(A, b)), 1e-6, "");
+    CHECK_EQ(ldl.analyzeCount, analyzed, "");
+
+    //indefinite
+    As.sparse().Z *= -1.;
+    CHECK(!ldl.factorize(As.sparse()), "");
+    CHECK_GE(ldl.failedPivot, 0, "");
+  }
+  cout <<"nnz(A)=" <<ldl.Cp.last() <<" nnz(L)=" <<ldl.nnzL() <<" analyzed " <<ldl.analyzeCount <<" factorized " <<ldl.factorizeCount <<endl;
+}
+
+//===========================================================================
+
+/// Jacobian of a k-order Markov chain over T slices of d variables, as a RowShifted matrix
+arr randomMarkovJacobian(uint T, uint d, uint k){
+  uint n=T*d;
+  arr J;
+  rai::RowShifted& Jr = J.rowShifted();
+  Jr.resize(n+T, n, (k+1)*d);
+  for(uint t=0;t<T;t++) for(uint i=0;i<d+1;i++){
+    uint r = t*(d+1)+i;
+    uint lo = (t<k ? 0 : t-k)*d;
+    Jr.rowShift(r) = lo;
+    Jr.rowLen(r) = (t+1)*d-lo;
+    for(uint j=0;j<Jr.rowLen(r);j++) Jr.entry(r,j) = rnd.uni(-1.,1.);
+  }
+  return J;
+}
+
+arr rowShifted2sparse(const arr& A){
+  const rai::RowShifted& Ar = A.rowShifted();
+  arr S;
+  rai::SparseMatrix& Ss = S.sparse();
+  Ss.resize(A.d0, A.d1, 0);
+  for(uint i=0;i<A.d0;i++) for(uint j=0;j<Ar.rowLen(i) && i+j<A.d1;j++){
+    Ss.addEntry(i+j, i) = Ar.entry(i,j); //lower triangle suffices for LDL^T
+  }
+  return S;
+}
+
+void TEST(BandedCholesky){
+  cout <<"\n*** BandedCholesky\n";
+
+  for(uint k=0;k<10;k++){
+    arr J = randomMarkovJacobian(3+rnd(10), 1+rnd(4), 1+rnd(3));
+    arr A = comp_At_A(J);
+    arr b = randn(A.d0);
+    arr A_dense = A.rowShifted().unpack();
+    for(uint i=0;i<A.d0;i++) A_dense(i,i) += .1;
+
+    arr U;
+    CHECK(banded_choleskySymPosDef(U, A, .1), "");
+    arr x = banded_Ainv_b_givenCholesky(U, b);
+    CHECK_ZERO(maxDiff(A_dense*x, b), 1e-6, "");
+
+    A.rowShifted().entry(A.d0/2, 0) = -1.;
+    CHECK(!banded_choleskySymPosDef(U, A), "");
+  }
+}
+
+//===========================================================================
+
+void TEST(Benchmark){
+  cout <<"\n*** Benchmark banded vs dpbsv vs sparse vs eigen vs dense (d=7, k=2)\n";
+
+  uint d=7, k=2;
+  for(uint T:{20, 100, 500, 2000}){
+    arr J = randomMarkovJacobian(T, d, k);
+    arr A = comp_At_A(J);
+    arr b = randn(A.d0);
+    double beta=1e-2;
+
+    double time = -rai::cpuTime();
+    arr U;
+    banded_choleskySymPosDef(U, A, beta);
+    arr x_banded = banded_Ainv_b_givenCholesky(U, b);
+    time += rai::cpuTime();
+    cout <<"T=" <<T <<" n=" <<A.d0 <<"\t banded: " <<time;
+
+    //LAPACK's banded Cholesky (dpbsv), as lapack_Ainv_b_sym does for RowShifted matrices
+    arr Ab = A;
+    for(uint i=0;i<A.d0;i++) Ab.rowShifted().entry(i, 0) += beta;
+    time = -rai::cpuTime();
+    arr x_dpbsv = lapack_Ainv_b_sym(Ab, b);
+    time += rai::cpuTime();
+    cout <<"\t dpbsv: " <<time;
+    CHECK_ZERO(maxDiff(x_dpbsv, x_banded), 1e-6, "");
+
+    arr As = rowShifted2sparse(A);
+    SparseLDL ldl;
+    ldl.analyze(As.sparse());
+    time = -rai::cpuTime();
+    ldl.factorize(As.sparse(), beta);
+    arr x_sparse = ldl.solve(b);
+    time += rai::cpuTime();
+    cout <<"\t sparse: " <<time;
+    CHECK_ZERO(maxDiff(x_sparse, x_banded), 1e-6, "");
+
+    //the previous sparse path of OptNewton: Eigen's SimplicialLDLT, including its symbolic analysis, every step
+    arr Ae = As;
+    for(uint i=0;i<A.d0;i++) Ae.sparse().addEntry(i, i) = beta;
+    time = -rai::cpuTime();
+    arr x_eigen = eigen_Ainv_b(Ae, b);
+    time += rai::cpuTime();
+    cout <<"\t eigen: " <<time;
+    CHECK_ZERO(maxDiff(x_eigen, x_banded), 1e-6, "");
+
+    if(A.d0<=4000){ //dense is O(n^3)
+      arr A_dense = A.rowShifted().unpack();
+      for(uint i=0;i<A.d0;i++) A_dense(i,i) += beta;
+      time = -rai::cpuTime();
+      arr x_dense = lapack_Ainv_b_sym(A_dense, b);
+      time += rai::cpuTime();
+      cout <<"\t dense: " <<time;
+      CHECK_ZERO(maxDiff(x_dense, x_banded), 1e-6, "");
+    }else{
+      cout <<"\t dense: (skipped)";
+    }
+    cout <<" sec" <<endl;
+  }
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc,argv);
+
+  testSparseLDL();
+  testBandedCholesky();
+  testBenchmark();
+
+  return 0;
+}
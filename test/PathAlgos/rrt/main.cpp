@@ -0,0 +1,162 @@
+#include <PathAlgos/RRT_PathFinder.h>
+#include <Kin/frame.h>
+
+//===========================================================================
+
+shared_ptr<ConfigurationProblem> newProblem(const rai::Configuration& C){
+  auto P = make_shared<ConfigurationProblem>(C, false, .01);
+  P->setExplicitCollisionPairs({"ego", "wall"});
+  return P;
+}
+
+/// the path connects start and goal, and all its configurations and edges (except for the unchecked one connecting
+/// the two trees at index n0) are feasible on a problem without cache
+void checkPath(const rai::Configuration& C, const arr& path, const arr& start, const arr& goal, uint n0){
+  CHECK(path.N, "no path found");
+  CHECK_ZERO(maxDiff(path[0], start), 1e-10, "path doesn't start at start");
+  CHECK_ZERO(maxDiff(path[path.d0-1], goal), 1e-10, "path doesn't end at goal");
+  auto P = newProblem(C);
+  for(uint t=0;t<path.d0;t++){
+    CHECK(P->query(path[t])->isFeasible, "infeasible configuration " <<t);
+    if(t && t!=n0) CHECK(P->checkConnection(path[t-1], path[t], 20, true), "infeasible edge " <<t);
+  }
+}
+
+//===========================================================================
+
+void TEST(CheckConnectionCache){
+  rai::Configuration C("scene.g");
+  auto P = newProblem(C);
+  auto Pc = newProblem(C);
+  Pc->cacheResolution = 1e-6;
+
+  arr Q(100, 2);
+  rndUniform(Q, -1., 1.);
+
+  //checks of the cached problem agree with the uncached ones, also when they are repeated (and answered by the cache)
+  auto compare = [&](){
+    for(uint i=1;i<Q.d0;i++){
+      CHECK_EQ(P->query(Q[i])->isFeasible, Pc->query(Q[i])->isFeasible, "cached query differs");
+      CHECK_EQ(P->checkConnection(Q[i-1], Q[i], 20, true), Pc->checkConnection(Q[i-1], Q[i], 20, true), "cached edge check differs");
+    }
+  };
+  compare();
+  uint evals = Pc->evals;
+  compare();
+  cout <<"evals uncached: " <<P->evals <<" cached: " <<Pc->evals <<" cache hits: " <<Pc->cacheHits <<endl;
+  CHECK_EQ(Pc->evals, evals, "repeated checks should all be cache hits");
+
+  //moving an obstacle invalidates the cache
+  P->C["wall"]->setPosition({.5, 0., 0.});
+  Pc->C["wall"]->setPosition({.5, 0., 0.});
+  compare();
+  CHECK_GE(Pc->evals, evals+Q.d0-1, "the moved obstacle should have cleared the cache");
+
+  //... and so does changing the feasibility criteria
+  for(auto& p:{P, Pc}) p->collisionTolerance = .05;
+  compare();
+  for(auto& p:{P, Pc}) p->limits = arr({2, 2}, {-.5, .5, -.5, .5});
+  compare();
+  for(auto& p:{P, Pc}) p->addObjective(FS_position, {"ego"}, OT_ineq, arr({1, 3}, {1., 0., 0.}));
+  compare();
+}
+
+//===========================================================================
+
+void TEST(LazyEdgeCheck){
+  rai::Configuration C("scene.g");
+  arr start={-.5, 0.}, goal={.5, 0.};
+
+  //with and without lazy edge checking, the path is feasible
+  for(bool lazy:{false, true}){
+    rnd.seed(0);
+    auto P = newProblem(C);
+    RRT_PathFinder rrt(*P, start, goal, .05, 0, true);
+    rrt.lazyEdgeCheck = lazy;
+    arr path = rrt.planConnect();
+    cout <<"lazy: " <<lazy <<" path length: " <<path.d0 <<" evals: " <<P->evals <<endl;
+    checkPath(C, path, start, goal, rrt.rrt0->getPathFromNode(rrt.rrt0->nearestID).d0);
+  }
+}
+
+//===========================================================================
+
+void TEST(ContinuousCheck){
+  rai::Configuration C("scene.g");
+  auto P = newProblem(C);
+  auto Pc = P->clone();
+  Pc->continuousCheck = true;
+
+  //the continuous check is conservative: it only accepts edges that pass a fine sampling check
+  arr Q(100, 2);
+  rndUniform(Q, -1., 1.);
+  uint accepted=0;
+  for(uint i=1;i<Q.d0;i++){
+    if(!Pc->checkConnection(Q[i-1], Q[i], 20, true)) continue;
+    accepted++;
+    CHECK(P->checkConnection(Q[i-1], Q[i], 200, true), "continuous check accepted an infeasible edge " <<i);
+  }
+  cout <<"continuous check accepted " <<accepted <<" of " <<Q.d0-1 <<" edges" <<endl;
+  CHECK(accepted, "");
+
+  //same criteria as the sampling check: collisionTolerance and limits
+  auto agree = [&](const arr& a, const arr& b, bool feasible){
+    CHECK_EQ(P->checkConnection(a, b, 20, true), feasible, "sampling check of " <<a <<" -> " <<b);
+    CHECK_EQ(Pc->checkConnectionContinuous(a, b), (int)feasible, "continuous check of " <<a <<" -> " <<b);
+  };
+  agree({-.5, 0.}, {.5, 0.}, false);     //crossing the wall
+  agree({-.145, -.2}, {-.145, .2}, true); //sliding along the wall, penetrating less than collisionTolerance
+  agree({-.13, -.2}, {-.13, .2}, false);  //penetrating more
+  agree({.5, .8}, {1.5, .8}, false);      //leaving the limits
+
+  //inequality objectives are left to the sampling check
+  P->addObjective(FS_position, {"ego"}, OT_ineq, arr({1, 3}, {1., 0., 0.}));
+  Pc->addObjective(FS_position, {"ego"}, OT_ineq, arr({1, 3}, {1., 0., 0.}));
+  CHECK_EQ(Pc->checkConnectionContinuous({-.5, .8}, {.5, .8}), -1, "");
+  CHECK(!P->checkConnection({-.5, .8}, {.5, .8}, 20, true), "");
+  CHECK(!Pc->checkConnection({-.5, .8}, {.5, .8}, 20, true), "");
+  CHECK(Pc->checkConnection({-.5, .8}, {-.1, .8}, 20, true), "");
+}
+
+//===========================================================================
+
+void TEST(ParallelRRT){
+  rai::Configuration C("scene.g");
+  arr start={-.5, 0.}, goal={.5, 0.};
+
+  //the serial planner is deterministic given the seed
+  arr paths[2];
+  for(arr& path:paths){
+    rnd.seed(0);
+    auto P = newProblem(C);
+    RRT_PathFinder rrt(*P, start, goal, .05, 0, true);
+    path = rrt.planConnect();
+  }
+  CHECK_EQ(paths[0].d0, paths[1].d0, "serial RRT is not deterministic");
+  CHECK_ZERO(maxDiff(paths[0], paths[1]), 0., "serial RRT is not deterministic");
+
+  //the parallel one depends on the workers' timing: its paths are only checked to be feasible
+  for(bool lazy:{false, true}) for(uint k=0;k<5;k++){
+    rnd.seed(k);
+    auto P = newProblem(C);
+    RRT_PathFinder rrt(*P, start, goal, .05, 0, true);
+    rrt.threads = 4;
+    rrt.lazyEdgeCheck = lazy;
+    arr path = rrt.planConnect();
+    cout <<"parallel, lazy: " <<lazy <<" seed: " <<k <<" path length: " <<path.d0 <<" evals: " <<P->evals <<endl;
+    checkPath(C, path, start, goal, rrt.rrt0->getPathFromNode(rrt.rrt0->nearestID).d0);
+  }
+}
+
+//===========================================================================
+
+int MAIN(int argc,char** argv){
+  rai::initCmdLine(argc,argv);
+
+  testCheckConnectionCache();
+  testLazyEdgeCheck();
+  testContinuousCheck();
+  testParallelRRT();
+
+  return 0;
+}
@@ -0,0 +1,10 @@
+world {}
+
+wall (world){
+  shape:ssBox, size:[.2 1.2 .2 .02], color:[.8 .3 .3], contact:1
+}
+
+ego (world){
+  joint:transXY, limits:[-1 1 -1 1],
+  shape:ssBox, size:[.1 .1 .2 .02], color:[.3 .3 .8], contact:1
+}